@@ -35,7 +35,8 @@ app.use(cors({
   methods: ['GET', 'POST', 'PUT', 'DELETE'],
   credentials: true,
 }));
-app.use(express.json());
+// Sample lists from the VST plugin can run to thousands of entries
+app.use(express.json({ limit: '5mb' }));
 app.use(express.urlencoded({ extended: true }));
 
 // Routes - MUST be before the catch-all route
@@ -158,6 +159,15 @@ app.use((err: any, req: express.Request, res: express.Response, next: express.Ne
   });
 });
 
+// Uploads that carry a base-version precondition decide for themselves whether
+// the client may send its body (see requireFreshBase in routes/project.ts)
+httpServer.on('checkContinue', (req, res) => {
+  if (!req.headers['x-coldaw-base-version']) {
+    res.writeContinue();
+  }
+  app(req, res);
+});
+
 httpServer.listen(PORT, () => {
   const deployTime = new Date().toISOString();
   console.log(`🚀 ColDaw server running on port ${PORT}`);
@@ -1,11 +1,20 @@
-import { Router } from 'express';
+import express, { Router } from 'express';
 import multer from 'multer';
 import path from 'path';
 import fs from 'fs';
+import { pipeline } from 'stream/promises';
 import { v4 as uuidv4 } from 'uuid';
 import { ALSParser } from '../utils/alsParser';
 import { db } from '../database/init';
+import { Project } from '../database/repository';
 import { requireAuth } from './auth';
+import { chooseBlockSize, computeSignature } from '../utils/delta';
+import { rebuildUpload, UploadFormat } from '../utils/uploadRebuilder';
+import { publishNotification, waitForNotification } from '../utils/vstNotifications';
+import { decodeUpload, UnsupportedEncodingError } from '../utils/transportEncoding';
+import { BlobMismatchError, BlobStore, isBlobHash, readSampleManifest, SampleEntry, updateSampleManifest } from '../utils/blobStore';
+import { chunkCount, MAX_CHUNK_SIZE, MIN_CHUNK_SIZE, UploadSession, UploadSessionStore } from '../utils/uploadSessions';
+import { adoptPreviews, previewPath } from '../utils/previews';
 
 const router = Router();
 
@@ -34,6 +43,30 @@ const upload = multer({
   },
 });
 
+// Delta uploads are not .als files themselves, so they skip the extension check
+const deltaUpload = multer({ storage });
+
+// Chunked uploads are assembled here until the plugin completes them
+const uploadSessions = new UploadSessionStore(path.join(DATA_DIR, 'uploads', 'sessions'));
+
+// Samples referenced by projects, stored once per content hash
+const blobs = new BlobStore(path.join(DATA_DIR, 'blobs'));
+
+/**
+ * Path of the .als stored for a version, or null if it doesn't belong to the
+ * project or its file is missing
+ */
+async function getVersionAlsPath(projectId: string, versionId: string): Promise<string | null> {
+  const version = await db.getVersion(versionId);
+  if (!version || version.project_id !== projectId) {
+    return null;
+  }
+
+  // The ALS file is stored alongside the version's JSON
+  const alsPath = version.files.replace('.json', '.als');
+  return fs.existsSync(alsPath) ? alsPath : null;
+}
+
 /**
  * POST /api/projects/parse-als
  * Parse ALS file without creating a version (for preview)
@@ -60,123 +93,669 @@ router.post('/parse-als', upload.single('alsFile'), async (req: any, res: any) =
   }
 });
 
+/**
+ * Base-version precondition for VST uploads.
+ * The plugin sends the project it is updating and the server version its file
+ * was based on. If someone else has committed to main since that version, the
+ * upload is rejected with 409 before the body is read: the client sends
+ * `Expect: 100-continue`, and the 100 response is only written once the
+ * precondition has passed (see the checkContinue handler in index.ts).
+ */
+async function requireFreshBase(req: any, res: any, next: any) {
+  const projectId = req.headers['x-coldaw-project-id'];
+  const baseVersionId = req.headers['x-coldaw-base-version'];
+
+  try {
+    if (projectId && baseVersionId) {
+      // Newest first; versions the uploader committed themselves don't count
+      const versions = await db.getVersionsByProject(projectId, 'main');
+      const baseIndex = versions.findIndex(v => v.id === baseVersionId);
+      const newerFromOthers = baseIndex > 0 &&
+        versions.slice(0, baseIndex).some(v => v.user_id !== req.user_id);
+
+      if (newerFromOthers) {
+        res.setHeader('Connection', 'close');
+        return res.status(409).json({
+          error: 'Project has newer versions on the server',
+          latestVersionId: versions[0].id,
+        });
+      }
+    }
+  } catch (error: any) {
+    console.error('Error checking base version:', error);
+  }
+
+  if (req.headers.expect === '100-continue') {
+    res.writeContinue();
+  }
+  next();
+}
+
+/**
+ * Shared tail of smart-import and the delta imports: the uploaded .als at
+ * uploadedPath becomes a pending import for an existing project, or the
+ * first version of a new one. Projects are matched by name unless the
+ * caller already knows which project the upload belongs to.
+ */
+async function importUploadedAls(req: any, res: any, uploadedPath: string, knownProject?: Project) {
+  const { projectName, author, message } = req.body;
+  const userId = req.user_id;
+  const now = Date.now();
+
+  // Full uploads may arrive zstd-compressed (see utils/transportEncoding.ts)
+  try {
+    await decodeUpload(req.headers['x-coldaw-encoding'], uploadedPath);
+  } catch (error: any) {
+    fs.unlinkSync(uploadedPath);
+    return res.status(error instanceof UnsupportedEncodingError ? 415 : 422).json({ error: error.message });
+  }
+
+  // Parse the ALS file
+  const alsData = await ALSParser.parseFile(uploadedPath);
+  const finalProjectName = projectName || alsData.name;
+
+  // Check if project with this name already exists for this user
+  const existingProject = knownProject ||
+    (await db.getProjectsByUser(userId)).find(p => p.name === finalProjectName);
+
+  if (existingProject) {
+    // Project exists - save file temporarily and return data for frontend
+    console.log(`Project "${finalProjectName}" exists, saving file temporarily...`);
+    
+    const projectId = existingProject.id;
+    const dataDir = path.join(DATA_DIR, 'projects', projectId);
+    
+    // Save to temp location with user-specific name
+    const tempFileName = `vst_import_${userId}_${Date.now()}.als`;
+    const tempFilePath = path.join(dataDir, tempFileName);
+    
+    if (!fs.existsSync(dataDir)) {
+      fs.mkdirSync(dataDir, { recursive: true });
+    }
+    
+    fs.copyFileSync(uploadedPath, tempFilePath);
+    
+    // Clean up uploaded file
+    fs.unlinkSync(uploadedPath);
+
+    // Latest version on main, so the plugin can send it as its base next time
+    const versions = await db.getVersionsByProject(projectId, 'main');
+
+    res.json({
+      projectId,
+      isNewProject: false,
+      hasPendingChanges: true,
+      baseVersionId: versions[0]?.id,
+      tempFileName,
+      message: 'Project exists. File saved temporarily for import.',
+      data: alsData,
+    });
+  } else {
+    // Project doesn't exist - initialize new project
+    console.log(`Creating new project "${finalProjectName}"...`);
+    
+    const projectId = uuidv4();
+    const dataDir = path.join(DATA_DIR, 'projects', projectId);
+    if (!fs.existsSync(dataDir)) {
+      fs.mkdirSync(dataDir, { recursive: true });
+    }
+
+    const versionId = uuidv4();
+    const dataPath = path.join(dataDir, `${versionId}.json`);
+    const alsPath = path.join(dataDir, `${versionId}.als`);
+    
+    fs.writeFileSync(dataPath, ALSParser.toJSON(alsData));
+    fs.copyFileSync(uploadedPath, alsPath);
+
+    // Create project
+    await db.insertProject({
+      id: projectId,
+      name: finalProjectName,
+      user_id: userId,
+      created_at: now,
+      updated_at: now,
+      current_branch: 'main',
+    });
+
+    // Create main branch
+    const branchId = uuidv4();
+    await db.insertBranch({
+      id: branchId,
+      project_id: projectId,
+      name: 'main',
+      created_at: now,
+      created_by: userId, // Must be a valid user ID
+    });
+
+    // Create initial version
+    await db.insertVersion({
+      id: versionId,
+      project_id: projectId,
+      branch: 'main',
+      parent_id: undefined,
+      message: message || 'Initial commit from VST plugin',
+      user_id: userId, // Use authenticated user ID
+      timestamp: now,
+      files: dataPath,
+    });
+
+    // Update branch head
+
+    // Clean up uploaded file
+    fs.unlinkSync(uploadedPath);
+
+    res.json({
+      projectId,
+      versionId,
+      isNewProject: true,
+      message: 'Project initialized successfully',
+      data: alsData,
+    });
+  }
+}
+
+/**
+ * Shared body of delta-import and semantic-import: rebuilds the .als from
+ * the base version named in X-ColDaw-Base-Version and the uploaded change,
+ * then imports it like smart-import would. The rebuild runs on a worker
+ * thread (see utils/uploadRebuilder.ts).
+ */
+async function importRebuiltAls(req: any, res: any, format: UploadFormat) {
+  if (!req.file) {
+    return res.status(400).json({ error: 'No delta uploaded' });
+  }
+
+  const { projectId } = req.params;
+  const baseVersionId = req.headers['x-coldaw-base-version'];
+  const uploadPath = req.file.path;
+
+  const project = await db.getProject(projectId);
+  if (!project || project.user_id !== req.user_id) {
+    fs.unlinkSync(uploadPath);
+    return res.status(project ? 403 : 404).json({ error: project ? 'Unauthorized' : 'Project not found' });
+  }
+
+  const basePath = baseVersionId ? await getVersionAlsPath(projectId, baseVersionId) : null;
+  if (!basePath) {
+    fs.unlinkSync(uploadPath);
+    return res.status(404).json({ error: 'Base version not found' });
+  }
+
+  const rebuiltPath = path.join(DATA_DIR, 'uploads', `${uuidv4()}-delta.als`);
+  try {
+    await rebuildUpload(format, basePath, uploadPath, rebuiltPath);
+  } catch (error: any) {
+    fs.rmSync(rebuiltPath, { force: true });
+    return res.status(422).json({ error: error.message });
+  } finally {
+    fs.unlinkSync(uploadPath);
+  }
+
+  await importUploadedAls(req, res, rebuiltPath, project);
+}
+
 /**
  * POST /api/projects/smart-import
  * Smart import: Check if project exists by name for this user
  * - If exists: Create new version (commit)
  * - If not: Initialize new project
+ * - The file may be zstd-encoded (X-ColDaw-Encoding); 415 if we can't decode it
  * Requires authentication
  */
-router.post('/smart-import', requireAuth, upload.single('alsFile'), async (req: any, res: any) => {
+router.post('/smart-import', requireAuth, requireFreshBase, upload.single('alsFile'), async (req: any, res: any) => {
   try {
     if (!req.file) {
       return res.status(400).json({ error: 'No file uploaded' });
     }
 
-    const { projectName, author, message } = req.body;
-    const userId = req.user_id;
+    await importUploadedAls(req, res, req.file.path);
+  } catch (error: any) {
+    console.error('Error in smart import:', error);
+    res.status(500).json({ error: error.message });
+  }
+});
+
+/**
+ * What the plugin needs to know to (re)start sending a session's chunks
+ */
+function describeSession(session: UploadSession) {
+  return {
+    sessionId: session.id,
+    chunkSize: session.chunkSize,
+    chunkCount: chunkCount(session),
+    received: session.received,
+  };
+}
+
+/**
+ * Session for the URL's :sessionId if it belongs to the caller; otherwise
+ * sends the 404 and returns null
+ */
+function getOwnSession(req: any, res: any): UploadSession | null {
+  const session = uploadSessions.get(req.params.sessionId);
+  if (!session || session.userId !== req.user_id) {
+    res.status(404).json({ error: 'Upload session not found' });
+    return null;
+  }
+  return session;
+}
+
+/**
+ * POST /api/projects/upload-sessions
+ * Start (or resume) a chunked upload of an .als
+ * Body: { fileName, size, sha256, chunkSize }; asking again for the same
+ * file returns the existing session and the chunks it already has
+ * Requires authentication
+ */
+router.post('/upload-sessions', requireAuth, async (req: any, res: any) => {
+  try {
+    const { fileName, size, sha256, chunkSize } = req.body;
+
+    if (typeof fileName !== 'string' || path.extname(fileName).toLowerCase() !== '.als') {
+      return res.status(400).json({ error: 'Only .als files are allowed' });
+    }
+
+    if (!Number.isInteger(size) || size <= 0 || typeof sha256 !== 'string' || !/^[0-9a-fA-F]{64}$/.test(sha256)) {
+      return res.status(400).json({ error: 'size and sha256 are required' });
+    }
+
+    if (!Number.isInteger(chunkSize) || chunkSize < MIN_CHUNK_SIZE || chunkSize > MAX_CHUNK_SIZE) {
+      return res.status(400).json({ error: `chunkSize must be between ${MIN_CHUNK_SIZE} and ${MAX_CHUNK_SIZE}` });
+    }
+
+    const session = uploadSessions.create(req.user_id, fileName, size, sha256, chunkSize);
+    res.json(describeSession(session));
+  } catch (error: any) {
+    console.error('Error creating upload session:', error);
+    res.status(500).json({ error: error.message });
+  }
+});
+
+/**
+ * GET /api/projects/upload-sessions/:sessionId
+ * Chunks received so far
+ * Requires authentication
+ */
+router.get('/upload-sessions/:sessionId', requireAuth, async (req: any, res: any) => {
+  try {
+    const session = getOwnSession(req, res);
+    if (session) {
+      res.json(describeSession(session));
+    }
+  } catch (error: any) {
+    console.error('Error reading upload session:', error);
+    res.status(500).json({ error: error.message });
+  }
+});
+
+/**
+ * PUT /api/projects/upload-sessions/:sessionId/chunks/:index
+ * One chunk as the raw request body, with its SHA-256 (hex) in
+ * X-ColDaw-Chunk-SHA256
+ * - 422 if the length or checksum is wrong; the plugin sends it again
+ * Requires authentication
+ */
+router.put('/upload-sessions/:sessionId/chunks/:index', requireAuth,
+  express.raw({ type: () => true, limit: MAX_CHUNK_SIZE }), async (req: any, res: any) => {
+  try {
+    const session = getOwnSession(req, res);
+    if (!session) {
+      return;
+    }
+
+    const data = Buffer.isBuffer(req.body) ? req.body : Buffer.alloc(0);
+
+    try {
+      uploadSessions.writeChunk(session, Number(req.params.index), data, String(req.headers['x-coldaw-chunk-sha256'] || ''));
+    } catch (error: any) {
+      return res.status(422).json({ error: error.message });
+    }
+
+    res.json({ received: session.received.length, chunkCount: chunkCount(session) });
+  } catch (error: any) {
+    console.error('Error storing upload chunk:', error);
+    res.status(500).json({ error: error.message });
+  }
+});
+
+/**
+ * POST /api/projects/upload-sessions/:sessionId/complete
+ * Same as smart-import once every chunk is in; takes the same form fields
+ * as a JSON body and the same base-version precondition headers
+ * - 422 (with the chunks received) if chunks are missing or the file's
+ *   SHA-256 doesn't match
+ * Requires authentication
+ */
+router.post('/upload-sessions/:sessionId/complete', requireAuth, requireFreshBase, async (req: any, res: any) => {
+  try {
+    const session = getOwnSession(req, res);
+    if (!session) {
+      return;
+    }
+
+    const uploadedPath = path.join(DATA_DIR, 'uploads', `${uuidv4()}-${session.fileName}`);
+
+    try {
+      await uploadSessions.complete(session, uploadedPath);
+    } catch (error: any) {
+      return res.status(422).json({ error: error.message, ...describeSession(session) });
+    }
+
+    await importUploadedAls(req, res, uploadedPath);
+  } catch (error: any) {
+    console.error('Error completing upload session:', error);
+    res.status(500).json({ error: error.message });
+  }
+});
+
+/**
+ * POST /api/projects/:projectId/samples
+ * Record the samples the project refers to and say which ones to upload
+ * Body: { samples: [{ path, relativePath, sha256, size }] }
+ * Returns { missing: [sha256] } - the hashes we have no blob for yet
+ * Requires authentication
+ */
+router.post('/:projectId/samples', requireAuth, async (req: any, res: any) => {
+  try {
+    const { projectId } = req.params;
+    const { samples } = req.body;
+
+    const project = await db.getProject(projectId);
+    if (!project || project.user_id !== req.user_id) {
+      return res.status(project ? 403 : 404).json({ error: project ? 'Unauthorized' : 'Project not found' });
+    }
+
+    if (!Array.isArray(samples) || samples.some((s: any) => !isBlobHash(s?.sha256) || !Number.isInteger(s?.size))) {
+      return res.status(400).json({ error: 'samples must list a sha256 and size for each file' });
+    }
+
     const now = Date.now();
+    const entries: SampleEntry[] = samples.map((s: any) => ({
+      path: String(s.path || ''),
+      relativePath: String(s.relativePath || ''),
+      sha256: s.sha256,
+      size: s.size,
+      updatedAt: now,
+    }));
 
-    // Parse the ALS file
-    const alsData = await ALSParser.parseFile(req.file.path);
-    const finalProjectName = projectName || alsData.name;
+    updateSampleManifest(path.join(DATA_DIR, 'projects', projectId), entries);
+    res.json({ missing: blobs.missing(entries.map(e => e.sha256)) });
+  } catch (error: any) {
+    console.error('Error recording samples:', error);
+    res.status(500).json({ error: error.message });
+  }
+});
 
-    // Check if project with this name already exists for this user
-    const allUserProjects = await db.getProjectsByUser(userId);
-    const existingProject = allUserProjects.find(p => p.name === finalProjectName);
+/**
+ * The project's owner, or a collaborator it has been shared with
+ */
+async function canAccessProject(project: { id: string; user_id: string }, userId: string): Promise<boolean> {
+  if (project.user_id === userId) {
+    return true;
+  }
 
-    if (existingProject) {
-      // Project exists - save file temporarily and return data for frontend
-      console.log(`Project "${finalProjectName}" exists, saving file temporarily...`);
-      
-      const projectId = existingProject.id;
-      const dataDir = path.join(DATA_DIR, 'projects', projectId);
-      
-      // Save to temp location with user-specific name
-      const tempFileName = `vst_import_${userId}_${Date.now()}.als`;
-      const tempFilePath = path.join(dataDir, tempFileName);
-      
-      if (!fs.existsSync(dataDir)) {
-        fs.mkdirSync(dataDir, { recursive: true });
-      }
-      
-      fs.copyFileSync(req.file.path, tempFilePath);
-      
-      // Clean up uploaded file
-      fs.unlinkSync(req.file.path);
+  const collaborations = await db.getProjectCollaboratorsByUser(userId);
+  return collaborations.some(c => c.project_id === project.id);
+}
 
-      res.json({
-        projectId,
-        isNewProject: false,
-        hasPendingChanges: true,
-        tempFileName,
-        message: 'Project exists. File saved temporarily for import.',
-        data: alsData,
-      });
-    } else {
-      // Project doesn't exist - initialize new project
-      console.log(`Creating new project "${finalProjectName}"...`);
-      
-      const projectId = uuidv4();
-      const dataDir = path.join(DATA_DIR, 'projects', projectId);
-      if (!fs.existsSync(dataDir)) {
-        fs.mkdirSync(dataDir, { recursive: true });
+/**
+ * GET /api/projects/:projectId/samples
+ * The samples the project refers to, and whether each one has been uploaded.
+ * Absolute paths on the uploader's machine are left out.
+ * Requires authentication, as the owner or a collaborator
+ */
+router.get('/:projectId/samples', requireAuth, async (req: any, res: any) => {
+  try {
+    const { projectId } = req.params;
+
+    const project = await db.getProject(projectId);
+    if (!project) {
+      return res.status(404).json({ error: 'Project not found' });
+    }
+
+    if (!await canAccessProject(project, req.user_id)) {
+      return res.status(403).json({ error: 'Unauthorized' });
+    }
+
+    const manifest = readSampleManifest(path.join(DATA_DIR, 'projects', projectId));
+    const samples = Object.values(manifest).map(({ path: _path, ...sample }) => ({ ...sample, available: blobs.has(sample.sha256) }));
+
+    res.json({ samples });
+  } catch (error: any) {
+    console.error('Error listing samples:', error);
+    res.status(500).json({ error: error.message });
+  }
+});
+
+/**
+ * PUT /api/projects/blobs/:hash
+ * One sample as the raw request body, stored under its SHA-256
+ * - 422 if the body doesn't hash to :hash
+ * Requires authentication
+ */
+router.put('/blobs/:hash', requireAuth, async (req: any, res: any) => {
+  try {
+    const { hash } = req.params;
+
+    if (!isBlobHash(hash)) {
+      return res.status(400).json({ error: 'Invalid hash' });
+    }
+
+    if (blobs.has(hash)) {
+      return res.json({ sha256: hash, stored: false });
+    }
+
+    try {
+      const size = await blobs.write(hash, req);
+      res.status(201).json({ sha256: hash, size, stored: true });
+    } catch (error: any) {
+      if (error instanceof BlobMismatchError) {
+        return res.status(422).json({ error: error.message });
       }
+      throw error;
+    }
+  } catch (error: any) {
+    console.error('Error storing blob:', error);
+    res.status(500).json({ error: error.message });
+  }
+});
 
-      const versionId = uuidv4();
-      const dataPath = path.join(dataDir, `${versionId}.json`);
-      const alsPath = path.join(dataDir, `${versionId}.als`);
-      
-      fs.writeFileSync(dataPath, ALSParser.toJSON(alsData));
-      fs.copyFileSync(req.file.path, alsPath);
-
-      // Create project
-      await db.insertProject({
-        id: projectId,
-        name: finalProjectName,
-        user_id: userId,
-        created_at: now,
-        updated_at: now,
-        current_branch: 'main',
-      });
+/**
+ * GET /api/projects/blobs/:hash
+ * Download one sample by its SHA-256
+ * Requires authentication
+ */
+router.get('/blobs/:hash', requireAuth, async (req: any, res: any) => {
+  try {
+    const { hash } = req.params;
 
-      // Create main branch
-      const branchId = uuidv4();
-      await db.insertBranch({
-        id: branchId,
-        project_id: projectId,
-        name: 'main',
-        created_at: now,
-        created_by: userId, // Must be a valid user ID
-      });
+    if (!isBlobHash(hash) || !blobs.has(hash)) {
+      return res.status(404).json({ error: 'Blob not found' });
+    }
 
-      // Create initial version
-      await db.insertVersion({
-        id: versionId,
-        project_id: projectId,
-        branch: 'main',
-        parent_id: undefined,
-        message: message || 'Initial commit from VST plugin',
-        user_id: userId, // Use authenticated user ID
-        timestamp: now,
-        files: dataPath,
-      });
+    // Blobs never change, so anything holding one may keep it
+    res.setHeader('Cache-Control', 'private, max-age=31536000, immutable');
+    res.sendFile(blobs.pathFor(hash));
+  } catch (error: any) {
+    console.error('Error downloading blob:', error);
+    res.status(500).json({ error: error.message });
+  }
+});
 
-      // Update branch head
+async function storePreviewFile(req: any, res: any, extension: string) {
+  const { projectId, key } = req.params;
 
-      // Clean up uploaded file
-      fs.unlinkSync(req.file.path);
+  const project = await db.getProject(projectId);
+  if (!project || project.user_id !== req.user_id) {
+    return res.status(project ? 403 : 404).json({ error: project ? 'Unauthorized' : 'Project not found' });
+  }
 
-      res.json({
-        projectId,
-        versionId,
-        isNewProject: true,
-        message: 'Project initialized successfully',
-        data: alsData,
-      });
+  const projectDir = path.join(DATA_DIR, 'projects', projectId);
+  const initialTarget = previewPath(projectDir, key, extension);
+  if (!initialTarget) {
+    return res.status(400).json({ error: 'Invalid preview name' });
+  }
+
+  // Written next to its final name and moved into place once complete
+  const tempPath = `${initialTarget}.${uuidv4()}.tmp`;
+  fs.mkdirSync(path.dirname(initialTarget), { recursive: true });
+
+  let target = initialTarget;
+  try {
+    await pipeline(req, fs.createWriteStream(tempPath));
+
+    // Looked up again: the pending import may have been committed meanwhile
+    target = previewPath(projectDir, key, extension) || initialTarget;
+    fs.renameSync(tempPath, target);
+  } finally {
+    fs.rmSync(tempPath, { force: true });
+  }
+
+  res.status(201).json({ size: fs.statSync(target).size });
+}
+
+async function sendPreviewFile(req: any, res: any, extension: string, contentType: string) {
+  const { projectId, key } = req.params;
+
+  const project = await db.getProject(projectId);
+  if (!project) {
+    return res.status(404).json({ error: 'Project not found' });
+  }
+
+  const file = previewPath(path.join(DATA_DIR, 'projects', projectId), key, extension);
+  if (!file || !fs.existsSync(file)) {
+    return res.status(404).json({ error: 'Preview not found' });
+  }
+
+  res.type(contentType);
+  res.sendFile(file);
+}
+
+/**
+ * PUT /api/projects/:projectId/previews/:key
+ * A FLAC recording of the project as the raw request body, kept as the
+ * audio preview of the export named by :key
+ * Requires authentication
+ */
+router.put('/:projectId/previews/:key', requireAuth, async (req: any, res: any) => {
+  try {
+    await storePreviewFile(req, res, '.flac');
+  } catch (error: any) {
+    console.error('Error storing audio preview:', error);
+    res.status(500).json({ error: error.message });
+  }
+});
+
+/**
+ * PUT /api/projects/:projectId/previews/:key/peaks
+ * Waveform peaks of the preview (min, max and RMS at several zoom levels)
+ * as the raw request body; the format is described in the plugin's
+ * PeakPyramid.h
+ * Requires authentication
+ */
+router.put('/:projectId/previews/:key/peaks', requireAuth, async (req: any, res: any) => {
+  try {
+    await storePreviewFile(req, res, '.peaks');
+  } catch (error: any) {
+    console.error('Error storing preview peaks:', error);
+    res.status(500).json({ error: error.message });
+  }
+});
+
+/**
+ * GET /api/projects/:projectId/previews/:key
+ * The audio preview of an export, as FLAC
+ */
+router.get('/:projectId/previews/:key', async (req: any, res: any) => {
+  try {
+    await sendPreviewFile(req, res, '.flac', 'audio/flac');
+  } catch (error: any) {
+    console.error('Error downloading audio preview:', error);
+    res.status(500).json({ error: error.message });
+  }
+});
+
+/**
+ * GET /api/projects/:projectId/previews/:key/peaks
+ * Waveform peaks of an export's audio preview, so it can be drawn without
+ * decoding the FLAC
+ */
+router.get('/:projectId/previews/:key/peaks', async (req: any, res: any) => {
+  try {
+    await sendPreviewFile(req, res, '.peaks', 'application/octet-stream');
+  } catch (error: any) {
+    console.error('Error downloading preview peaks:', error);
+    res.status(500).json({ error: error.message });
+  }
+});
+
+/**
+ * GET /api/projects/:projectId/signature/:versionId
+ * Block signature of a version's .als for rsync-style delta uploads
+ * Versions never change, so the signature is cached next to the file
+ * Requires authentication
+ */
+router.get('/:projectId/signature/:versionId', requireAuth, async (req: any, res: any) => {
+  try {
+    const { projectId, versionId } = req.params;
+
+    const project = await db.getProject(projectId);
+    if (!project) {
+      return res.status(404).json({ error: 'Project not found' });
+    }
+
+    if (project.user_id !== req.user_id) {
+      return res.status(403).json({ error: 'Unauthorized' });
+    }
+
+    const alsPath = await getVersionAlsPath(projectId, versionId);
+    if (!alsPath) {
+      return res.status(404).json({ error: 'Version file not found' });
     }
+
+    const signaturePath = `${alsPath}.sig`;
+    if (!fs.existsSync(signaturePath)) {
+      const data = fs.readFileSync(alsPath);
+      fs.writeFileSync(signaturePath, computeSignature(data, chooseBlockSize(data.length)));
+    }
+
+    res.setHeader('Content-Type', 'application/octet-stream');
+    res.sendFile(path.resolve(signaturePath));
   } catch (error: any) {
-    console.error('Error in smart import:', error);
+    console.error('Error computing signature:', error);
+    res.status(500).json({ error: error.message });
+  }
+});
+
+/**
+ * POST /api/projects/:projectId/delta-import
+ * Same as smart-import, but the file arrives as a delta against the version
+ * named in X-ColDaw-Base-Version (see utils/delta.ts)
+ * - 404 if the base version is unknown, 422 if the delta doesn't apply;
+ *   the plugin falls back to a full smart-import in both cases
+ * Requires authentication
+ */
+router.post('/:projectId/delta-import', requireAuth, requireFreshBase, deltaUpload.single('alsDelta'), async (req: any, res: any) => {
+  try {
+    await importRebuiltAls(req, res, 'delta');
+  } catch (error: any) {
+    console.error('Error in delta import:', error);
+    res.status(500).json({ error: error.message });
+  }
+});
+
+/**
+ * POST /api/projects/:projectId/semantic-import
+ * Same as delta-import, but the upload is a gzipped XML edit script against
+ * the base version's document (see utils/alsXml.ts)
+ * - 404 if the base version is unknown, 422 if the script doesn't apply
+ * Requires authentication
+ */
+router.post('/:projectId/semantic-import', requireAuth, requireFreshBase, deltaUpload.single('alsEdit'), async (req: any, res: any) => {
+  try {
+    await importRebuiltAls(req, res, 'semantic');
+  } catch (error: any) {
+    console.error('Error in semantic import:', error);
     res.status(500).json({ error: error.message });
   }
 });
@@ -278,7 +857,7 @@ router.get('/:projectId/pending-changes', requireAuth, async (req: any, res: any
 /**
  * POST /api/projects/:projectId/notify-vst
  * Notify VST plugin about new version (VST Bridge)
- * This creates a notification file that the VST plugin will poll for
+ * This creates a notification file and wakes any plugin waiting for it
  * Requires authentication
  */
 router.post('/:projectId/notify-vst', requireAuth, async (req: any, res: any) => {
@@ -315,6 +894,7 @@ router.post('/:projectId/notify-vst', requireAuth, async (req: any, res: any) =>
     };
     
     fs.writeFileSync(notificationFile, JSON.stringify(notification, null, 2));
+    publishNotification(projectId, userId, notification);
     
     res.json({ 
       success: true, 
@@ -383,6 +963,11 @@ router.post('/:projectId/push-pending/:pendingId', requireAuth, async (req: any,
     // Update branch head and project
     await db.updateProject(projectId, { updated_at: Date.now() });
     
+    // A pending change made from a plugin import keeps its audio preview
+    if (typeof pendingData?.tempFileName === 'string') {
+      adoptPreviews(path.join(DATA_DIR, 'projects', projectId), pendingData.tempFileName, versionId);
+    }
+    
     // Delete pending change
     await db.deletePendingChange(pendingId);
     
@@ -400,7 +985,7 @@ router.post('/:projectId/push-pending/:pendingId', requireAuth, async (req: any,
 /**
  * GET /api/projects/:projectId/check-vst-notification/:userId
  * Check if there's a pending VST notification for this user
- * Used by VST plugin to poll for updates
+ * One-off check; the VST plugin long-polls vst-notifications/:userId/wait instead
  */
 router.get('/:projectId/check-vst-notification/:userId', async (req: any, res: any) => {
   try {
@@ -426,10 +1011,50 @@ router.get('/:projectId/check-vst-notification/:userId', async (req: any, res: a
   }
 });
 
+/**
+ * GET /api/projects/:projectId/vst-notifications/:userId/wait?since=&timeout=
+ * Long-poll for a VST notification
+ * Answers at once if there is a notification for a version other than `since`
+ * (the last one the plugin saw), otherwise holds the request until notify-vst
+ * publishes one or `timeout` seconds (default 25, at most 55) pass
+ */
+router.get('/:projectId/vst-notifications/:userId/wait', async (req: any, res: any) => {
+  try {
+    const { projectId, userId } = req.params;
+    const since = typeof req.query.since === 'string' ? req.query.since : '';
+    const timeoutSeconds = Math.min(Math.max(parseInt(req.query.timeout, 10) || 25, 1), 55);
+    
+    const notificationFile = path.join(DATA_DIR, 'projects', projectId, `vst_notification_${userId}.json`);
+    
+    if (fs.existsSync(notificationFile)) {
+      const notification = JSON.parse(fs.readFileSync(notificationFile, 'utf8'));
+      
+      if (notification.versionId !== since) {
+        return res.json({ hasUpdate: true, notification });
+      }
+    }
+    
+    const cancel = waitForNotification(projectId, userId, timeoutSeconds * 1000, (notification) => {
+      if (res.headersSent) {
+        return;
+      }
+      
+      res.json(notification ? { hasUpdate: true, notification } : { hasUpdate: false });
+    });
+    
+    req.on('close', cancel);
+  } catch (error: any) {
+    console.error('Error waiting for VST notification:', error);
+    res.status(500).json({ error: error.message });
+  }
+});
+
 /**
  * POST /api/projects/:projectId/confirm-vst-update/:userId
  * Confirm VST update and download the new version
  * Clears the notification and returns the .als file
+ * - ?download=false only clears it, for a plugin that fetched the version
+ *   through the resumable download route
  */
 router.post('/:projectId/confirm-vst-update/:userId', async (req: any, res: any) => {
   try {
@@ -456,6 +1081,10 @@ router.post('/:projectId/confirm-vst-update/:userId', async (req: any, res: any)
     // Delete notification file
     fs.unlinkSync(notificationFile);
     
+    if (req.query.download === 'false') {
+      return res.json({ success: true, versionId });
+    }
+    
     // Send the file
     res.download(versionFilePath, `${projectId}_${versionId}.als`, (err: any) => {
       if (err) {
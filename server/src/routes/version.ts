@@ -6,6 +6,9 @@ import { v4 as uuidv4 } from 'uuid';
 import { ALSParser } from '../utils/alsParser';
 import { db } from '../database/init';
 import { requireAuth } from './auth';
+import { getImmutableFileSha256, getImmutableXmlSha256 } from '../utils/fileDigest';
+import { buildPatchFile } from '../utils/patchBuilder';
+import { adoptPreviews } from '../utils/previews';
 
 const router = Router();
 
@@ -79,8 +82,9 @@ router.post('/:projectId/commit', upload.single('alsFile'), async (req: any, res
 
       await db.updateProject(projectId, { updated_at: now });
       
-      // Clean up temp file
+      // Clean up temp file; its audio preview, if the plugin sent one, now belongs to the version
       fs.unlinkSync(tempFilePath);
+      adoptPreviews(dataDir, tempFileName, versionId);
 
       return res.json({ versionId, message: 'Version committed successfully from VST', data: alsData });
     }
@@ -251,7 +255,8 @@ router.get('/:projectId/branches', async (req: any, res: any) => {
   }
 });
 
-// Download version as ALS file
+// Download version as ALS file. Range/If-Range requests are honoured so an
+// interrupted download can continue; X-ColDaw-SHA256 is the whole file's hash.
 router.get('/:projectId/download/:versionId', async (req: any, res: any) => {
   try {
     const { projectId, versionId } = req.params;
@@ -275,16 +280,63 @@ router.get('/:projectId/download/:versionId', async (req: any, res: any) => {
     
     res.setHeader('Content-Type', 'application/octet-stream');
     res.setHeader('Content-Disposition', `attachment; filename="${filename}"`);
+    res.setHeader('X-ColDaw-SHA256', await getImmutableFileSha256(alsPath));
     
-    // Stream the ALS file
-    const fileStream = fs.createReadStream(alsPath);
-    fileStream.pipe(res);
+    // sendFile answers Range requests (206) and checks If-Range against its ETag
+    res.sendFile(path.resolve(alsPath), (err: any) => {
+      if (err && !res.headersSent) {
+        res.status(500).json({ error: 'Failed to send file' });
+      }
+    });
   } catch (error: any) {
     console.error('Error downloading version:', error);
     res.status(500).json({ error: error.message });
   }
 });
 
+// Patch from a version the VST plugin already has to this one, so pulling a
+// small change doesn't mean downloading the whole set. The delta is taken
+// between the inflated XML of both versions (any edit reshuffles the gzip
+// stream after it) and served gzipped; see utils/delta.ts. The plugin sends
+// its base version and the SHA-256 of its copy's XML; 409 if that isn't what
+// we have, in which case it downloads the full file instead.
+router.get('/:projectId/patch/:versionId', async (req: any, res: any) => {
+  try {
+    const { projectId, versionId } = req.params;
+    const { base, baseSha256 } = req.query;
+
+    const version = await db.getVersion(versionId);
+    const baseVersion = base ? await db.getVersion(String(base)) : null;
+    if (!version || version.project_id !== projectId || !baseVersion || baseVersion.project_id !== projectId) {
+      return res.status(404).json({ error: 'Version not found' });
+    }
+
+    const alsPath = version.files.replace('.json', '.als');
+    const baseAlsPath = baseVersion.files.replace('.json', '.als');
+    if (!fs.existsSync(alsPath) || !fs.existsSync(baseAlsPath)) {
+      return res.status(404).json({ error: 'ALS file not found for this version' });
+    }
+
+    if (await getImmutableXmlSha256(baseAlsPath) !== String(baseSha256 || '').toLowerCase()) {
+      return res.status(409).json({ error: 'Base version does not match' });
+    }
+
+    const patchPath = `${alsPath}.from-${baseVersion.id}.patch`;
+    await buildPatchFile(baseAlsPath, alsPath, patchPath);
+
+    res.setHeader('Content-Type', 'application/octet-stream');
+    res.setHeader('X-ColDaw-SHA256', await getImmutableFileSha256(alsPath));
+    res.sendFile(path.resolve(patchPath), (err: any) => {
+      if (err && !res.headersSent) {
+        res.status(500).json({ error: 'Failed to send patch' });
+      }
+    });
+  } catch (error: any) {
+    console.error('Error creating version patch:', error);
+    res.status(500).json({ error: error.message });
+  }
+});
+
 // Revert to a specific version (creates a new commit with the old version's data)
 router.post('/:projectId/revert/:versionId', requireAuth, async (req: any, res: any) => {
   try {
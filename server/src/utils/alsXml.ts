@@ -0,0 +1,283 @@
+import crypto from 'crypto';
+import * as pako from 'pako';
+
+/**
+ * Order-preserving XML tree for .als documents, and the semantic edit scripts
+ * the VST plugin uploads against a base version.
+ * Canonical form and script format mirror vst-plugin/Source/SemanticDelta.h:
+ *
+ *   canonical: attributes sorted by name, Value of volatile elements omitted,
+ *              whitespace-only text dropped
+ *   script:    { format, baseHash, targetHash, root }, root = { a?, c? }
+ *   children:  [start, count] | { i, a?, c? } | { x: '<Element/>' } | { t: 'text' }
+ */
+
+export interface XmlElementNode {
+  name: string;
+  attributes: [string, string][];
+  children: XmlNode[];
+}
+
+export type XmlNode = XmlElementNode | string;
+
+const FORMAT_VERSION = 1;
+
+// Elements whose Value Live rewrites on every save without any real change
+const VOLATILE_ELEMENTS = new Set(['LomId', 'LomIdView', 'OverwriteProtectionNumber']);
+
+const NAMED_ENTITIES: { [name: string]: string } = {
+  amp: '&',
+  lt: '<',
+  gt: '>',
+  quot: '"',
+  apos: "'",
+};
+
+function decodeEntities(text: string): string {
+  return text.replace(/&(#x[0-9a-fA-F]+|#[0-9]+|[a-zA-Z]+);/g, (match, entity: string) => {
+    if (entity[0] === '#') {
+      const code = entity[1] === 'x' ? parseInt(entity.substring(2), 16) : parseInt(entity.substring(1), 10);
+      return String.fromCodePoint(code);
+    }
+    return NAMED_ENTITIES[entity] ?? match;
+  });
+}
+
+/**
+ * Parse an XML document (or a single element) into an order-preserving tree.
+ * Comments, processing instructions and DOCTYPEs are skipped.
+ */
+export function parseXml(text: string): XmlElementNode {
+  const root: XmlElementNode = { name: '', attributes: [], children: [] };
+  const stack: XmlElementNode[] = [root];
+  let pos = 0;
+
+  const addText = (value: string) => {
+    if (value.trim().length > 0) {
+      stack[stack.length - 1].children.push(value);
+    }
+  };
+
+  while (pos < text.length) {
+    const tagStart = text.indexOf('<', pos);
+    if (tagStart < 0) {
+      addText(decodeEntities(text.substring(pos)));
+      break;
+    }
+
+    if (tagStart > pos) {
+      addText(decodeEntities(text.substring(pos, tagStart)));
+    }
+
+    if (text.startsWith('<!--', tagStart)) {
+      pos = text.indexOf('-->', tagStart) + 3;
+    } else if (text.startsWith('<![CDATA[', tagStart)) {
+      const end = text.indexOf(']]>', tagStart);
+      addText(text.substring(tagStart + 9, end));
+      pos = end + 3;
+    } else if (text[tagStart + 1] === '?' || text[tagStart + 1] === '!') {
+      pos = text.indexOf('>', tagStart) + 1;
+    } else if (text[tagStart + 1] === '/') {
+      const end = text.indexOf('>', tagStart);
+      const name = text.substring(tagStart + 2, end).trim();
+      const element = stack.pop();
+      if (!element || element.name !== name || stack.length === 0) {
+        throw new Error(`Unexpected closing tag </${name}>`);
+      }
+      pos = end + 1;
+    } else {
+      const tagPattern = /\s*([^\s=/>]+)\s*=\s*("([^"]*)"|'([^']*)')|\s*(\/?)>/y;
+      const nameMatch = /[^\s/>]+/y;
+      nameMatch.lastIndex = tagStart + 1;
+      const name = nameMatch.exec(text)?.[0];
+      if (!name) {
+        throw new Error(`Malformed tag at offset ${tagStart}`);
+      }
+
+      const element: XmlElementNode = { name, attributes: [], children: [] };
+      tagPattern.lastIndex = nameMatch.lastIndex;
+
+      for (;;) {
+        const match = tagPattern.exec(text);
+        if (!match) {
+          throw new Error(`Malformed tag <${name}> at offset ${tagStart}`);
+        }
+
+        if (match[1] !== undefined) {
+          element.attributes.push([match[1], decodeEntities(match[3] ?? match[4])]);
+          continue;
+        }
+
+        stack[stack.length - 1].children.push(element);
+        if (match[5] !== '/') {
+          stack.push(element);
+        }
+        pos = tagPattern.lastIndex;
+        break;
+      }
+    }
+
+    if (pos <= tagStart) {
+      throw new Error(`Unterminated markup at offset ${tagStart}`);
+    }
+  }
+
+  const documentElement = root.children.find((child): child is XmlElementNode => typeof child !== 'string');
+  if (stack.length !== 1 || !documentElement) {
+    throw new Error('Incomplete XML document');
+  }
+
+  return documentElement;
+}
+
+function escape(value: string): string {
+  return value
+    .replace(/&/g, '&amp;')
+    .replace(/</g, '&lt;')
+    .replace(/>/g, '&gt;')
+    .replace(/"/g, '&quot;')
+    .replace(/\t/g, '&#9;')
+    .replace(/\n/g, '&#10;')
+    .replace(/\r/g, '&#13;');
+}
+
+/**
+ * Serialize a tree back to an XML document, tab-indented like Live writes it
+ */
+export function serializeXml(root: XmlElementNode): string {
+  const parts: string[] = ['<?xml version="1.0" encoding="UTF-8"?>\n'];
+
+  // Indentation would change text content, so elements holding text are written inline
+  const write = (node: XmlNode, indent: string | null) => {
+    if (typeof node === 'string') {
+      parts.push(escape(node));
+      return;
+    }
+
+    parts.push(indent ?? '', '<', node.name);
+    for (const [name, value] of node.attributes) {
+      parts.push(' ', name, '="', escape(value), '"');
+    }
+
+    if (node.children.length === 0) {
+      parts.push(indent === null ? ' />' : ' />\n');
+      return;
+    }
+
+    const inline = indent === null || node.children.some(child => typeof child === 'string');
+    parts.push(inline ? '>' : '>\n');
+    for (const child of node.children) {
+      write(child, inline ? null : `${indent}\t`);
+    }
+    parts.push(inline ? '' : indent ?? '', '</', node.name, indent === null ? '>' : '>\n');
+  };
+
+  write(root, '');
+  return parts.join('');
+}
+
+/**
+ * Hex SHA-256 of the document's canonical form
+ */
+export function canonicalHash(root: XmlElementNode): string {
+  const hash = crypto.createHash('sha256');
+
+  const write = (node: XmlNode) => {
+    if (typeof node === 'string') {
+      hash.update(escape(node), 'utf8');
+      return;
+    }
+
+    const attributes = node.attributes
+      .filter(([name]) => !(name === 'Value' && VOLATILE_ELEMENTS.has(node.name)))
+      .sort(([a], [b]) => (a < b ? -1 : a > b ? 1 : 0));
+
+    hash.update(`<${node.name}`, 'utf8');
+    for (const [name, value] of attributes) {
+      hash.update(` ${name}="${escape(value)}"`, 'utf8');
+    }
+    hash.update('>', 'utf8');
+
+    node.children.forEach(write);
+    hash.update(`</${node.name}>`, 'utf8');
+  };
+
+  write(root);
+  return hash.digest('hex');
+}
+
+export function readAlsDocument(data: Buffer): XmlElementNode {
+  return parseXml(pako.ungzip(data, { to: 'string' }));
+}
+
+export function writeAlsDocument(root: XmlElementNode): Buffer {
+  return Buffer.from(pako.gzip(serializeXml(root)));
+}
+
+export function readEditScript(data: Buffer): any {
+  return JSON.parse(pako.ungzip(data, { to: 'string' }));
+}
+
+function applyElementEdit(base: XmlElementNode, edit: any): XmlElementNode {
+  const attributes: [string, string][] = edit.a
+    ? edit.a.map((pair: any) => [String(pair[0]), String(pair[1])])
+    : base.attributes;
+
+  if (!edit.c) {
+    return { name: base.name, attributes, children: base.children };
+  }
+
+  if (!Array.isArray(edit.c)) {
+    throw new Error('Malformed child list');
+  }
+
+  const children: XmlNode[] = [];
+
+  for (const entry of edit.c) {
+    if (Array.isArray(entry)) {
+      const [start, count] = entry;
+      if (!Number.isInteger(start) || !Number.isInteger(count) || start < 0 || count < 0 ||
+          start + count > base.children.length) {
+        throw new Error('Edit script references children outside the base version');
+      }
+      children.push(...base.children.slice(start, start + count));
+    } else if (entry && typeof entry.x === 'string') {
+      children.push(parseXml(entry.x));
+    } else if (entry && typeof entry.t === 'string') {
+      children.push(entry.t);
+    } else if (entry && Number.isInteger(entry.i)) {
+      const original = base.children[entry.i];
+      if (!original || typeof original === 'string') {
+        throw new Error('Edit script edits a child that is not an element');
+      }
+      children.push(applyElementEdit(original, entry));
+    } else {
+      throw new Error('Malformed edit script entry');
+    }
+  }
+
+  return { name: base.name, attributes, children };
+}
+
+/**
+ * Apply an edit script to the base version's document.
+ * Throws if the script was made against a different base or the result
+ * doesn't match its canonical hash. Unchanged subtrees are shared with base.
+ */
+export function applyEditScript(base: XmlElementNode, script: any): XmlElementNode {
+  if (!script || script.format !== FORMAT_VERSION || !script.root) {
+    throw new Error('Unsupported edit script');
+  }
+
+  if (canonicalHash(base) !== script.baseHash) {
+    throw new Error('Edit script was made against a different base version');
+  }
+
+  const result = applyElementEdit(base, script.root);
+
+  if (canonicalHash(result) !== script.targetHash) {
+    throw new Error('Edited document does not match its hash');
+  }
+
+  return result;
+}
@@ -0,0 +1,108 @@
+import crypto from 'crypto';
+import fs from 'fs';
+import path from 'path';
+import { Readable } from 'stream';
+import { pipeline } from 'stream/promises';
+import { v4 as uuidv4 } from 'uuid';
+
+/**
+ * Content-addressed storage for the samples projects refer to.
+ *
+ * Each file is stored once under its SHA-256 (<dir>/<first two hex
+ * digits>/<hash>), whichever project or user sent it first. Uploads are
+ * streamed to a temporary file and only moved into place once their hash
+ * matches the one they were sent under, so a blob that exists is complete.
+ *
+ * Which samples a project uses is kept in its samples.json, keyed by the
+ * sample's path inside the project folder (or its absolute path when it
+ * lives elsewhere).
+ */
+
+export interface SampleEntry {
+  path: string;
+  relativePath: string;
+  sha256: string;
+  size: number;
+  updatedAt: number;
+}
+
+export class BlobMismatchError extends Error {}
+
+export function isBlobHash(hash: unknown): hash is string {
+  return typeof hash === 'string' && /^[0-9a-f]{64}$/.test(hash);
+}
+
+export class BlobStore {
+  constructor(private readonly dir: string) {}
+
+  pathFor(hash: string): string {
+    return path.join(this.dir, hash.slice(0, 2), hash);
+  }
+
+  has(hash: string): boolean {
+    return fs.existsSync(this.pathFor(hash));
+  }
+
+  /**
+   * The hashes we don't have, each once
+   */
+  missing(hashes: string[]): string[] {
+    return [...new Set(hashes)].filter(hash => !this.has(hash));
+  }
+
+  /**
+   * Store the stream's bytes as the blob for hash; throws BlobMismatchError
+   * if they hash to something else. Returns the number of bytes stored.
+   */
+  async write(hash: string, input: Readable): Promise<number> {
+    const target = this.pathFor(hash);
+    const tempPath = path.join(this.dir, 'tmp', uuidv4());
+    fs.mkdirSync(path.dirname(tempPath), { recursive: true });
+
+    const digest = crypto.createHash('sha256');
+    let size = 0;
+
+    try {
+      await pipeline(input, async function* (source: AsyncIterable<Buffer>) {
+        for await (const chunk of source) {
+          digest.update(chunk);
+          size += chunk.length;
+          yield chunk;
+        }
+      }, fs.createWriteStream(tempPath));
+
+      if (digest.digest('hex') !== hash) {
+        throw new BlobMismatchError('Blob checksum mismatch');
+      }
+
+      fs.mkdirSync(path.dirname(target), { recursive: true });
+      fs.renameSync(tempPath, target);
+      return size;
+    } finally {
+      fs.rmSync(tempPath, { force: true });
+    }
+  }
+}
+
+function manifestPath(projectDir: string): string {
+  return path.join(projectDir, 'samples.json');
+}
+
+export function readSampleManifest(projectDir: string): Record<string, SampleEntry> {
+  const file = manifestPath(projectDir);
+  return fs.existsSync(file) ? JSON.parse(fs.readFileSync(file, 'utf8')).samples : {};
+}
+
+/**
+ * Record (or update) the samples a project refers to
+ */
+export function updateSampleManifest(projectDir: string, samples: SampleEntry[]): void {
+  const manifest = readSampleManifest(projectDir);
+
+  for (const sample of samples) {
+    manifest[sample.relativePath || sample.path] = sample;
+  }
+
+  fs.mkdirSync(projectDir, { recursive: true });
+  fs.writeFileSync(manifestPath(projectDir), JSON.stringify({ samples: manifest }));
+}
@@ -0,0 +1,256 @@
+import crypto from 'crypto';
+
+/**
+ * rsync-style block signatures and delta application for VST uploads, and
+ * delta encoding for patched VST downloads.
+ * Formats mirror vst-plugin/Source/DeltaEncoder.h (all integers little-endian):
+ *
+ *   Signature: "CDSG" u32 version, u32 blockSize, u64 fileSize, u32 numBlocks,
+ *              then numBlocks x (u32 weak checksum, 16-byte MD5)
+ *   Delta:     "CDDL" u32 version, u32 blockSize, u64 targetSize, 32-byte SHA-256,
+ *              then ops: 1 = copy (u32 first block, u32 count),
+ *                        2 = literal (u32 length, bytes), 0 = end
+ *
+ * Only full blocks are signed; a trailing partial block is always sent literally.
+ * Download patches use the same delta format, applied by the plugin.
+ */
+
+const FORMAT_VERSION = 1;
+
+/**
+ * Block size close to sqrt(file size), as a power of two between 1 KB and 64 KB
+ */
+export function chooseBlockSize(fileSize: number): number {
+  const target = Math.sqrt(Math.max(fileSize, 1));
+  const power = Math.round(Math.log2(target));
+  return Math.min(65536, Math.max(1024, 2 ** power));
+}
+
+/**
+ * rsync weak checksum: a + (b << 16), both mod 2^16
+ */
+function weakChecksum(block: Buffer): number {
+  let a = 0;
+  let b = 0;
+  const length = block.length;
+
+  for (let i = 0; i < length; i++) {
+    a = (a + block[i]) & 0xffff;
+    b = (b + (length - i) * block[i]) & 0xffff;
+  }
+
+  return (a | (b << 16)) >>> 0;
+}
+
+export function computeSignature(data: Buffer, blockSize: number): Buffer {
+  const numBlocks = Math.floor(data.length / blockSize);
+  const signature = Buffer.alloc(24 + numBlocks * 20);
+
+  signature.write('CDSG', 0, 'ascii');
+  signature.writeUInt32LE(FORMAT_VERSION, 4);
+  signature.writeUInt32LE(blockSize, 8);
+  signature.writeBigUInt64LE(BigInt(data.length), 12);
+  signature.writeUInt32LE(numBlocks, 20);
+
+  for (let i = 0; i < numBlocks; i++) {
+    const block = data.subarray(i * blockSize, (i + 1) * blockSize);
+    const offset = 24 + i * 20;
+    signature.writeUInt32LE(weakChecksum(block), offset);
+    crypto.createHash('md5').update(block).digest().copy(signature, offset + 4);
+  }
+
+  return signature;
+}
+
+/**
+ * Rebuild the uploaded file from a base version and a delta.
+ * Throws if the delta is malformed or the result doesn't match its SHA-256.
+ */
+export function applyDelta(base: Buffer, delta: Buffer): Buffer {
+  if (delta.length < 53 || delta.toString('ascii', 0, 4) !== 'CDDL') {
+    throw new Error('Invalid delta header');
+  }
+
+  if (delta.readUInt32LE(4) !== FORMAT_VERSION) {
+    throw new Error('Unsupported delta version');
+  }
+
+  const blockSize = delta.readUInt32LE(8);
+  const targetSize = Number(delta.readBigUInt64LE(12));
+  const targetHash = delta.subarray(20, 52);
+  const numBaseBlocks = Math.floor(base.length / blockSize);
+
+  const parts: Buffer[] = [];
+  let offset = 52;
+
+  for (;;) {
+    if (offset >= delta.length) {
+      throw new Error('Delta is truncated');
+    }
+
+    const op = delta[offset++];
+
+    if (op === 0) {
+      break;
+    } else if (op === 1) {
+      const first = delta.readUInt32LE(offset);
+      const count = delta.readUInt32LE(offset + 4);
+      offset += 8;
+
+      if (first + count > numBaseBlocks) {
+        throw new Error('Delta references blocks outside the base version');
+      }
+
+      parts.push(base.subarray(first * blockSize, (first + count) * blockSize));
+    } else if (op === 2) {
+      const length = delta.readUInt32LE(offset);
+      offset += 4;
+
+      if (offset + length > delta.length) {
+        throw new Error('Delta literal is truncated');
+      }
+
+      parts.push(delta.subarray(offset, offset + length));
+      offset += length;
+    } else {
+      throw new Error(`Unknown delta op ${op}`);
+    }
+  }
+
+  const result = Buffer.concat(parts);
+
+  if (result.length !== targetSize) {
+    throw new Error('Rebuilt file has the wrong size');
+  }
+
+  if (!crypto.createHash('sha256').update(result).digest().equals(targetHash)) {
+    throw new Error('Rebuilt file does not match its hash');
+  }
+
+  return result;
+}
+
+/**
+ * Delta that turns base into target. The server has both files, so windows
+ * of the target are checked against the base blocks directly rather than
+ * through MD5s as the plugin's encoder has to.
+ */
+export function computeDelta(base: Buffer, target: Buffer, blockSize = chooseBlockSize(base.length)): Buffer {
+  const numBaseBlocks = Math.floor(base.length / blockSize);
+  const blocksByWeak = new Map<number, number[]>();
+
+  for (let i = 0; i < numBaseBlocks; i++) {
+    const weak = weakChecksum(base.subarray(i * blockSize, (i + 1) * blockSize));
+    const blocks = blocksByWeak.get(weak);
+
+    if (blocks) {
+      blocks.push(i);
+    } else {
+      blocksByWeak.set(weak, [i]);
+    }
+  }
+
+  const header = Buffer.alloc(52);
+  header.write('CDDL', 0, 'ascii');
+  header.writeUInt32LE(FORMAT_VERSION, 4);
+  header.writeUInt32LE(blockSize, 8);
+  header.writeBigUInt64LE(BigInt(target.length), 12);
+  crypto.createHash('sha256').update(target).digest().copy(header, 20);
+
+  const parts: Buffer[] = [header];
+  let pendingFirst = -1;
+  let pendingCount = 0;
+
+  const flushCopy = () => {
+    if (pendingCount > 0) {
+      const op = Buffer.alloc(9);
+      op[0] = 1;
+      op.writeUInt32LE(pendingFirst, 1);
+      op.writeUInt32LE(pendingCount, 5);
+      parts.push(op);
+    }
+
+    pendingCount = 0;
+  };
+
+  const writeLiteral = (start: number, end: number) => {
+    if (end <= start) {
+      return;
+    }
+
+    flushCopy();
+    const op = Buffer.alloc(5);
+    op[0] = 2;
+    op.writeUInt32LE(end - start, 1);
+    parts.push(op, target.subarray(start, end));
+  };
+
+  const findBlock = (pos: number, weak: number): number => {
+    for (const block of blocksByWeak.get(weak) || []) {
+      if (base.compare(target, pos, pos + blockSize, block * blockSize, (block + 1) * blockSize) === 0) {
+        return block;
+      }
+    }
+
+    return -1;
+  };
+
+  // Rolling weak checksum of the window at pos, as in weakChecksum()
+  let pos = 0;
+  let literalStart = 0;
+  let a = 0;
+  let b = 0;
+
+  const startWindow = () => {
+    a = 0;
+    b = 0;
+
+    for (let i = 0; i < blockSize; i++) {
+      a = (a + target[pos + i]) & 0xffff;
+      b = (b + (blockSize - i) * target[pos + i]) & 0xffff;
+    }
+  };
+
+  if (blocksByWeak.size > 0 && target.length >= blockSize) {
+    startWindow();
+
+    while (pos + blockSize <= target.length) {
+      const block = findBlock(pos, (a | (b << 16)) >>> 0);
+
+      if (block >= 0) {
+        writeLiteral(literalStart, pos);
+
+        if (pendingCount > 0 && block === pendingFirst + pendingCount) {
+          pendingCount++;
+        } else {
+          flushCopy();
+          pendingFirst = block;
+          pendingCount = 1;
+        }
+
+        pos += blockSize;
+        literalStart = pos;
+
+        if (pos + blockSize <= target.length) {
+          startWindow();
+        }
+      } else {
+        // Roll the window one byte forward
+        if (pos + blockSize < target.length) {
+          const outgoing = target[pos];
+          const incoming = target[pos + blockSize];
+          a = (a - outgoing + incoming) & 0xffff;
+          b = (b - blockSize * outgoing + a) & 0xffff;
+        }
+
+        pos++;
+      }
+    }
+  }
+
+  writeLiteral(literalStart, target.length);
+  flushCopy();
+  parts.push(Buffer.from([0]));
+
+  return Buffer.concat(parts);
+}
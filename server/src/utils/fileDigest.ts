@@ -0,0 +1,39 @@
+import crypto from 'crypto';
+import fs from 'fs';
+import { pipeline } from 'stream/promises';
+import zlib from 'zlib';
+
+/**
+ * SHA-256 (hex) of a file that never changes once written, such as a
+ * version's .als. Computed once and cached next to the file as <file>.sha256.
+ */
+export async function getImmutableFileSha256(filePath: string): Promise<string> {
+  return cachedDigest(filePath, `${filePath}.sha256`, false);
+}
+
+/**
+ * SHA-256 (hex) of an immutable gzipped .als after inflating it, i.e. of its
+ * XML. Two copies of a version agree on this even when they were compressed
+ * differently. Cached next to the file as <file>.xml.sha256.
+ */
+export async function getImmutableXmlSha256(filePath: string): Promise<string> {
+  return cachedDigest(filePath, `${filePath}.xml.sha256`, true);
+}
+
+async function cachedDigest(filePath: string, cachePath: string, inflate: boolean): Promise<string> {
+  if (fs.existsSync(cachePath)) {
+    return fs.readFileSync(cachePath, 'utf8').trim();
+  }
+
+  const digest = crypto.createHash('sha256');
+
+  if (inflate) {
+    await pipeline(fs.createReadStream(filePath), zlib.createGunzip(), digest);
+  } else {
+    await pipeline(fs.createReadStream(filePath), digest);
+  }
+
+  const sha256 = digest.digest('hex');
+  fs.writeFileSync(cachePath, sha256);
+  return sha256;
+}
@@ -0,0 +1,49 @@
+import fs from 'fs';
+import zlib from 'zlib';
+import { Worker, isMainThread, workerData } from 'worker_threads';
+import { v4 as uuidv4 } from 'uuid';
+import { computeDelta } from './delta';
+
+/**
+ * Builds download patches (see the patch route in routes/version.ts) on a
+ * worker thread running this same file, so inflating and diffing two sets
+ * never blocks the event loop. Both versions are immutable, so a patch is
+ * built once and kept at patchPath; requests that arrive while it is being
+ * built wait for the same worker.
+ */
+const building = new Map<string, Promise<void>>();
+
+export function buildPatchFile(basePath: string, targetPath: string, patchPath: string): Promise<void> {
+  if (fs.existsSync(patchPath)) {
+    return Promise.resolve();
+  }
+
+  let pending = building.get(patchPath);
+
+  if (!pending) {
+    pending = new Promise<void>((resolve, reject) => {
+      const worker = new Worker(__filename, { workerData: { basePath, targetPath, patchPath } });
+      worker.once('error', reject);
+      worker.once('exit', (code) => {
+        if (code === 0) {
+          resolve();
+        } else {
+          reject(new Error(`Patch worker exited with code ${code}`));
+        }
+      });
+    }).finally(() => building.delete(patchPath));
+
+    building.set(patchPath, pending);
+  }
+
+  return pending;
+}
+
+if (!isMainThread && workerData?.patchPath) {
+  const { basePath, targetPath, patchPath } = workerData as { basePath: string; targetPath: string; patchPath: string };
+
+  const patch = computeDelta(zlib.gunzipSync(fs.readFileSync(basePath)), zlib.gunzipSync(fs.readFileSync(targetPath)));
+  const tempPath = `${patchPath}.${uuidv4()}.tmp`;
+  fs.writeFileSync(tempPath, zlib.gzipSync(patch));
+  fs.renameSync(tempPath, patchPath);
+}
@@ -0,0 +1,62 @@
+import fs from 'fs';
+import path from 'path';
+
+/**
+ * Audio previews recorded by the plugin, kept in a project's previews/
+ * folder: a FLAC recording and a waveform peak file per export.
+ *
+ * A preview is named after the export it belongs to: its version ID or,
+ * for an import that is still pending, the temporary file name the import
+ * was saved under. When the import is committed, adoptPreviews() renames
+ * its files to the new version ID and leaves a <name>.version link behind,
+ * so a preview that is still uploading at that moment ends up with the
+ * version as well.
+ */
+
+const PREVIEW_EXTENSIONS = ['.flac', '.peaks'];
+
+function previewName(key: string): string | null {
+  if (!/^[\w.-]+$/.test(key) || key.startsWith('.')) {
+    return null;
+  }
+  return path.basename(key, '.als');
+}
+
+/**
+ * Where the preview file for key lives, following the link left when a
+ * pending import became a version; null if key isn't a valid name
+ */
+export function previewPath(projectDir: string, key: string, extension: string): string | null {
+  const name = previewName(key);
+  if (!name) {
+    return null;
+  }
+
+  const dir = path.join(projectDir, 'previews');
+  const link = path.join(dir, `${name}.version`);
+  const versionId = fs.existsSync(link) ? fs.readFileSync(link, 'utf8').trim() : '';
+
+  return path.join(dir, `${previewName(versionId) || name}${extension}`);
+}
+
+/**
+ * Move the preview of a committed import (key is its temporary file name)
+ * to the version it became
+ */
+export function adoptPreviews(projectDir: string, key: string, versionId: string): void {
+  const name = previewName(key);
+  if (!name || !previewName(versionId)) {
+    return;
+  }
+
+  const dir = path.join(projectDir, 'previews');
+  fs.mkdirSync(dir, { recursive: true });
+  fs.writeFileSync(path.join(dir, `${name}.version`), versionId);
+
+  for (const extension of PREVIEW_EXTENSIONS) {
+    const from = path.join(dir, `${name}${extension}`);
+    if (fs.existsSync(from)) {
+      fs.renameSync(from, path.join(dir, `${versionId}${extension}`));
+    }
+  }
+}
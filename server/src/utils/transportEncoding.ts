@@ -0,0 +1,85 @@
+import fs from 'fs';
+import path from 'path';
+import zlib from 'zlib';
+import { Worker, isMainThread, workerData } from 'worker_threads';
+import { Decompressor } from 'zstd-napi';
+
+/**
+ * Transport encodings for VST uploads.
+ *
+ * The plugin can send a full upload zstd-compressed with a dictionary trained
+ * on Ableton XML instead of as the gzipped .als, naming the encoding in
+ * X-ColDaw-Encoding ("zstd; dict=<id>"). The dictionary is shipped with the
+ * plugin and in src/assets (see vst-plugin/train-dictionary.sh); uploads are
+ * turned back into a gzipped .als before anything else looks at them.
+ */
+
+const ASSETS_DIR = path.join(__dirname, '..', 'assets');
+
+export class UnsupportedEncodingError extends Error {}
+
+/**
+ * zstd dictionaries in assets, by the ID in their header
+ */
+const dictionaries = (() => {
+  const byId = new Map<number, Buffer>();
+
+  if (!fs.existsSync(ASSETS_DIR)) {
+    return byId;
+  }
+
+  for (const name of fs.readdirSync(ASSETS_DIR)) {
+    if (path.extname(name) !== '.zdict') {
+      continue;
+    }
+
+    const dictionary = fs.readFileSync(path.join(ASSETS_DIR, name));
+    if (dictionary.length >= 8 && dictionary.readUInt32LE(0) === 0xec30a437) {
+      byId.set(dictionary.readUInt32LE(4), dictionary);
+    }
+  }
+
+  return byId;
+})();
+
+/**
+ * Rewrite an upload sent with this encoding as a gzipped .als, in place.
+ * Does nothing without an encoding; rejects with UnsupportedEncodingError if
+ * we can't decode it, and with whatever zstd throws if the data is damaged.
+ * Decoding runs on a worker thread running this same file (as patch building
+ * does, see patchBuilder.ts), so a large set never blocks the event loop.
+ */
+export async function decodeUpload(encoding: string | undefined, uploadedPath: string): Promise<void> {
+  if (!encoding) {
+    return;
+  }
+
+  const match = /^zstd;\s*dict=(\d+)$/.exec(encoding.trim());
+  const dictionaryId = match ? Number(match[1]) : undefined;
+
+  if (dictionaryId === undefined || !dictionaries.has(dictionaryId)) {
+    throw new UnsupportedEncodingError(`Unsupported upload encoding: ${encoding}`);
+  }
+
+  await new Promise<void>((resolve, reject) => {
+    const worker = new Worker(__filename, { workerData: { dictionaryId, uploadedPath } });
+    worker.once('error', reject);
+    worker.once('exit', (code) => {
+      if (code === 0) {
+        resolve();
+      } else {
+        reject(new Error(`Decode worker exited with code ${code}`));
+      }
+    });
+  });
+}
+
+if (!isMainThread && workerData?.uploadedPath) {
+  const { dictionaryId, uploadedPath } = workerData as { dictionaryId: number; uploadedPath: string };
+
+  const decompressor = new Decompressor();
+  decompressor.loadDictionary(dictionaries.get(dictionaryId)!);
+
+  const xml = decompressor.decompress(fs.readFileSync(uploadedPath));
+  fs.writeFileSync(uploadedPath, zlib.gzipSync(xml, { level: 6 }));
+}
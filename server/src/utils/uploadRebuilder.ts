@@ -0,0 +1,45 @@
+import fs from 'fs';
+import { Worker, isMainThread, workerData } from 'worker_threads';
+import { applyDelta } from './delta';
+import { applyEditScript, readAlsDocument, readEditScript, writeAlsDocument } from './alsXml';
+
+/**
+ * Rebuilds an uploaded set from its base version and the change the plugin
+ * sent (see delta-import and semantic-import in routes/project.ts) on a
+ * worker thread running this same file, as patchBuilder.ts does for
+ * downloads, so applying a change to a large set never blocks the event loop.
+ */
+export type UploadFormat = 'delta' | 'semantic';
+
+/**
+ * Writes the rebuilt .als to rebuiltPath. Rejects with whatever applying
+ * the change throws if it doesn't apply to the base.
+ */
+export function rebuildUpload(format: UploadFormat, basePath: string, uploadPath: string, rebuiltPath: string): Promise<void> {
+  return new Promise<void>((resolve, reject) => {
+    const worker = new Worker(__filename, { workerData: { format, basePath, uploadPath, rebuiltPath } });
+    worker.once('error', reject);
+    worker.once('exit', (code) => {
+      if (code === 0) {
+        resolve();
+      } else {
+        reject(new Error(`Rebuild worker exited with code ${code}`));
+      }
+    });
+  });
+}
+
+function rebuild(format: UploadFormat, base: Buffer, upload: Buffer): Buffer {
+  if (format === 'delta') {
+    return applyDelta(base, upload);
+  }
+
+  return writeAlsDocument(applyEditScript(readAlsDocument(base), readEditScript(upload)));
+}
+
+if (!isMainThread && workerData?.rebuiltPath) {
+  const { format, basePath, uploadPath, rebuiltPath } =
+    workerData as { format: UploadFormat; basePath: string; uploadPath: string; rebuiltPath: string };
+
+  fs.writeFileSync(rebuiltPath, rebuild(format, fs.readFileSync(basePath), fs.readFileSync(uploadPath)));
+}
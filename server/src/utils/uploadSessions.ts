@@ -0,0 +1,179 @@
+import crypto from 'crypto';
+import fs from 'fs';
+import path from 'path';
+import { pipeline } from 'stream/promises';
+import { v4 as uuidv4 } from 'uuid';
+
+/**
+ * Resumable chunked uploads for the VST plugin.
+ *
+ * A session describes one file by size and SHA-256 and receives it in
+ * fixed-size chunks, each checked against its own SHA-256 and written at its
+ * offset, in any order. Sessions live on disk under <dir>/<sessionId>/
+ * (meta.json plus the partial file), so they survive server restarts. A
+ * plugin that asks again for the same user, size and hash gets the existing
+ * session back, with the list of chunks it no longer needs to send.
+ */
+
+export interface UploadSession {
+  id: string;
+  userId: string;
+  fileName: string;
+  size: number;
+  sha256: string;
+  chunkSize: number;
+  received: number[];
+  createdAt: number;
+  updatedAt: number;
+}
+
+export const MIN_CHUNK_SIZE = 256 * 1024;
+export const MAX_CHUNK_SIZE = 16 * 1024 * 1024;
+
+// Sessions nobody has touched for this long are deleted
+const SESSION_LIFETIME_MS = 24 * 60 * 60 * 1000;
+
+export function chunkCount(session: UploadSession): number {
+  return Math.max(1, Math.ceil(session.size / session.chunkSize));
+}
+
+export class UploadSessionStore {
+  constructor(private readonly dir: string) {}
+
+  private sessionDir(id: string): string {
+    return path.join(this.dir, id);
+  }
+
+  private dataPath(id: string): string {
+    return path.join(this.sessionDir(id), 'data');
+  }
+
+  private save(session: UploadSession): void {
+    session.updatedAt = Date.now();
+    fs.writeFileSync(path.join(this.sessionDir(session.id), 'meta.json'), JSON.stringify(session));
+  }
+
+  get(id: string): UploadSession | null {
+    // Session IDs come from the URL, so only accept what create() hands out
+    if (!/^[0-9a-f-]{36}$/.test(id)) {
+      return null;
+    }
+
+    const metaPath = path.join(this.sessionDir(id), 'meta.json');
+    return fs.existsSync(metaPath) ? JSON.parse(fs.readFileSync(metaPath, 'utf8')) : null;
+  }
+
+  /**
+   * Existing session for the same user and file, or a new one
+   */
+  create(userId: string, fileName: string, size: number, sha256: string, chunkSize: number): UploadSession {
+    this.removeExpired();
+
+    if (fs.existsSync(this.dir)) {
+      for (const id of fs.readdirSync(this.dir)) {
+        const existing = this.get(id);
+        if (existing && existing.userId === userId && existing.size === size &&
+            existing.sha256 === sha256 && existing.chunkSize === chunkSize) {
+          return existing;
+        }
+      }
+    }
+
+    const now = Date.now();
+    const session: UploadSession = {
+      id: uuidv4(),
+      userId,
+      fileName: path.basename(fileName),
+      size,
+      sha256: sha256.toLowerCase(),
+      chunkSize,
+      received: [],
+      createdAt: now,
+      updatedAt: now,
+    };
+
+    fs.mkdirSync(this.sessionDir(session.id), { recursive: true });
+    fs.closeSync(fs.openSync(this.dataPath(session.id), 'w'));
+    fs.truncateSync(this.dataPath(session.id), size);
+    this.save(session);
+    return session;
+  }
+
+  /**
+   * Write one chunk after checking its length and SHA-256; throws on a bad chunk
+   */
+  writeChunk(session: UploadSession, index: number, data: Buffer, sha256: string): void {
+    if (!Number.isInteger(index) || index < 0 || index >= chunkCount(session)) {
+      throw new Error('Chunk index out of range');
+    }
+
+    const offset = index * session.chunkSize;
+    const expectedLength = Math.min(session.chunkSize, session.size - offset);
+    if (data.length !== expectedLength) {
+      throw new Error(`Chunk ${index} should be ${expectedLength} bytes, got ${data.length}`);
+    }
+
+    const actual = crypto.createHash('sha256').update(data).digest('hex');
+    if (actual !== sha256.toLowerCase()) {
+      throw new Error(`Chunk ${index} checksum mismatch`);
+    }
+
+    const fd = fs.openSync(this.dataPath(session.id), 'r+');
+    try {
+      fs.writeSync(fd, data, 0, data.length, offset);
+    } finally {
+      fs.closeSync(fd);
+    }
+
+    if (!session.received.includes(index)) {
+      session.received.push(index);
+      session.received.sort((a, b) => a - b);
+    }
+    this.save(session);
+  }
+
+  /**
+   * Move the finished file to targetPath and drop the session. Rejects if
+   * chunks are missing or the whole-file hash doesn't match.
+   */
+  async complete(session: UploadSession, targetPath: string): Promise<void> {
+    const missing = chunkCount(session) - session.received.length;
+    if (missing > 0) {
+      throw new Error(`${missing} chunks missing`);
+    }
+
+    // Streamed, so a large set is never held in memory whole
+    const dataPath = this.dataPath(session.id);
+    const digest = crypto.createHash('sha256');
+    await pipeline(fs.createReadStream(dataPath), digest);
+    const actual = digest.digest('hex');
+
+    if (actual !== session.sha256) {
+      // Some chunk must have been written from a stale copy; start again
+      session.received = [];
+      this.save(session);
+      throw new Error('File checksum mismatch');
+    }
+
+    fs.renameSync(dataPath, targetPath);
+    this.remove(session.id);
+  }
+
+  remove(id: string): void {
+    fs.rmSync(this.sessionDir(id), { recursive: true, force: true });
+  }
+
+  private removeExpired(): void {
+    if (!fs.existsSync(this.dir)) {
+      return;
+    }
+
+    const cutoff = Date.now() - SESSION_LIFETIME_MS;
+    for (const id of fs.readdirSync(this.dir)) {
+      const session = this.get(id);
+      if (!session || session.updatedAt < cutoff) {
+        this.remove(id);
+      }
+    }
+  }
+}
@@ -0,0 +1,66 @@
+/**
+ * Long-poll registry for VST bridge notifications.
+ *
+ * A plugin waiting on /vst-notifications/:userId/wait is parked here until
+ * notify-vst publishes for the same project and user, or its timeout runs out.
+ * Waiters live in this process only, so notify-vst and the waiting request
+ * must reach the same server instance; a waiter that misses a publish still
+ * sees the notification file on its next request.
+ */
+
+type Waiter = (notification: any | null) => void;
+
+const waiters = new Map<string, Set<Waiter>>();
+
+function waiterKey(projectId: string, userId: string): string {
+  return `${projectId}:${userId}`;
+}
+
+/**
+ * Park a waiter until a notification is published or timeoutMs passes
+ * (it then receives null). Returns a function that cancels the wait.
+ */
+export function waitForNotification(projectId: string, userId: string, timeoutMs: number, waiter: Waiter): () => void {
+  const key = waiterKey(projectId, userId);
+  let pending = waiters.get(key);
+
+  if (!pending) {
+    pending = new Set();
+    waiters.set(key, pending);
+  }
+
+  const remove = () => {
+    clearTimeout(timer);
+    const current = waiters.get(key);
+    if (current) {
+      current.delete(entry);
+      if (current.size === 0) {
+        waiters.delete(key);
+      }
+    }
+  };
+
+  const entry: Waiter = (notification) => {
+    remove();
+    waiter(notification);
+  };
+
+  const timer = setTimeout(() => entry(null), timeoutMs);
+  pending.add(entry);
+
+  return remove;
+}
+
+/**
+ * Wake every waiter for this project and user with the notification
+ */
+export function publishNotification(projectId: string, userId: string, notification: any): number {
+  const pending = waiters.get(waiterKey(projectId, userId));
+  if (!pending) {
+    return 0;
+  }
+
+  const woken = Array.from(pending);
+  woken.forEach((waiter) => waiter(notification));
+  return woken.length;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+//==============================================================================
+/**
+ * Counts the bytes a benchmark has allocated, by replacing the global
+ * operator new and delete. Include it in exactly one file of a benchmark.
+ * Each block carries its size in front of it so that delete can subtract it.
+ */
+namespace AllocationCounter
+{
+    inline std::atomic<size_t> current { 0 }, peak { 0 };
+
+    /** Starts a new peak from what is allocated now; returns that baseline. */
+    inline size_t resetPeak() noexcept
+    {
+        const auto now = current.load();
+        peak = now;
+        return now;
+    }
+
+    inline void* allocate (size_t size)
+    {
+        constexpr size_t header = alignof (std::max_align_t);
+        auto* block = static_cast<char*> (std::malloc (size + header));
+
+        if (block == nullptr)
+            throw std::bad_alloc();
+
+        *reinterpret_cast<size_t*> (block) = size;
+
+        const auto now = current += size;
+        auto previous = peak.load();
+
+        while (now > previous && ! peak.compare_exchange_weak (previous, now)) {}
+
+        return block + header;
+    }
+
+    inline void release (void* ptr) noexcept
+    {
+        if (ptr == nullptr)
+            return;
+
+        auto* block = static_cast<char*> (ptr) - alignof (std::max_align_t);
+        current -= *reinterpret_cast<size_t*> (block);
+        std::free (block);
+    }
+}
+
+void* operator new (size_t size)                    { return AllocationCounter::allocate (size); }
+void* operator new[] (size_t size)                  { return AllocationCounter::allocate (size); }
+void operator delete (void* ptr) noexcept           { AllocationCounter::release (ptr); }
+void operator delete[] (void* ptr) noexcept         { AllocationCounter::release (ptr); }
+void operator delete (void* ptr, size_t) noexcept   { AllocationCounter::release (ptr); }
+void operator delete[] (void* ptr, size_t) noexcept { AllocationCounter::release (ptr); }
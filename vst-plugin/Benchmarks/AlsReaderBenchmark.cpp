@@ -0,0 +1,124 @@
+#include <juce_core/juce_core.h>
+#include <iostream>
+#include "AllocationCounter.h"
+#include "../Source/AlsReader.h"
+
+namespace
+{
+    struct ElementCounter : public ColDawAlsReader::Handler
+    {
+        void startElement (ColDawAlsReader::Tag, std::string_view, const ColDawAlsReader::Attributes&) override  { ++numElements; }
+        void endElement (ColDawAlsReader::Tag, std::string_view) override {}
+
+        int numElements = 0;
+    };
+
+    int countElements (const juce::XmlElement& element)
+    {
+        int count = 1;
+
+        for (auto* child : element.getChildIterator())
+            count += countElements (*child);
+
+        return count;
+    }
+
+    struct Result
+    {
+        int numElements = 0;
+        double seconds = 0.0;
+        size_t peakBytes = 0;
+    };
+
+    template <typename ReadFunction>
+    Result measure (int iterations, ReadFunction&& read)
+    {
+        Result result;
+
+        for (int i = 0; i < iterations; ++i)
+        {
+            const auto baseline = AllocationCounter::resetPeak();
+            const auto start = juce::Time::getMillisecondCounterHiRes();
+
+            result.numElements = read();
+
+            const auto seconds = (juce::Time::getMillisecondCounterHiRes() - start) / 1000.0;
+            result.seconds = i == 0 ? seconds : juce::jmin (result.seconds, seconds);
+            result.peakBytes = AllocationCounter::peak - baseline;
+        }
+
+        return result;
+    }
+}
+
+//==============================================================================
+/**
+ * Reads a set with ColDawAlsReader and with juce::XmlDocument, and prints
+ * each one's throughput (in inflated XML per second, best of the runs) and
+ * the most memory it had allocated at once.
+ *
+ * Usage: ColDawAlsReaderBenchmark <set.als> [iterations]
+ */
+int main (int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: ColDawAlsReaderBenchmark <set.als> [iterations]" << std::endl;
+        return 1;
+    }
+
+    const juce::File file (juce::File::getCurrentWorkingDirectory().getChildFile (argv[1]));
+    const auto iterations = argc > 2 ? juce::jmax (1, juce::String (argv[2]).getIntValue()) : 3;
+
+    juce::MemoryBlock gzipped;
+    if (! file.loadFileAsData (gzipped))
+    {
+        std::cerr << "Can't read " << file.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    juce::int64 inflatedSize = 0;
+    {
+        juce::MemoryInputStream source (gzipped, false);
+        juce::GZIPDecompressorInputStream inflated (&source, false, juce::GZIPDecompressorInputStream::gzipFormat);
+        char buffer[65536];
+
+        for (int numRead; (numRead = inflated.read (buffer, (int) sizeof (buffer))) > 0;)
+            inflatedSize += numRead;
+    }
+
+    // Both start from the gzipped bytes in memory, so inflating is part of each
+    const auto streamed = measure (iterations, [&]
+    {
+        juce::MemoryInputStream source (gzipped, false);
+        ElementCounter counter;
+        return ColDawAlsReader::read (source, counter) ? counter.numElements : -1;
+    });
+
+    const auto document = measure (iterations, [&]
+    {
+        juce::MemoryInputStream source (gzipped, false);
+        juce::GZIPDecompressorInputStream inflated (&source, false, juce::GZIPDecompressorInputStream::gzipFormat);
+        const auto root = juce::XmlDocument::parse (inflated.readEntireStreamAsString());
+        return root != nullptr ? countElements (*root) : -1;
+    });
+
+    if (streamed.numElements < 0 || document.numElements < 0)
+    {
+        std::cerr << file.getFileName() << " isn't a readable set" << std::endl;
+        return 1;
+    }
+
+    std::cout << file.getFileName() << ": " << inflatedSize << " bytes of XML, " << streamed.numElements << " elements" << std::endl;
+
+    auto print = [inflatedSize] (const char* name, const Result& result)
+    {
+        std::cout << name << ": " << juce::String ((double) inflatedSize / juce::jmax (result.seconds, 1.0e-6) / 1.0e6, 1) << " MB/s, "
+                  << juce::String ((double) result.peakBytes / (1024.0 * 1024.0), 2) << " MiB peak" << std::endl;
+    };
+
+    print ("ColDawAlsReader", streamed);
+    print ("juce::XmlDocument", document);
+
+    return 0;
+}
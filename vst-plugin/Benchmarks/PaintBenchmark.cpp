@@ -0,0 +1,48 @@
+#include <juce_gui_basics/juce_gui_basics.h>
+#include <iostream>
+#include "../Source/LookAndFeel.h"
+
+//==============================================================================
+/**
+ * Times drawing a button's chrome directly and from ColDAWLookAndFeel's
+ * cache into a software image: the export button at its usual size,
+ * alternating hover state as a mouse pass would.
+ *
+ * Usage: ColDawPaintBenchmark [iterations]
+ */
+int main (int argc, char* argv[])
+{
+    const juce::ScopedJuceInitialiser_GUI initialiser;
+    const auto iterations = argc > 1 ? juce::jmax (1, juce::String (argv[1]).getIntValue()) : 500;
+
+    ColDAWLookAndFeel lookAndFeel;
+    juce::TextButton button ("EXPORT");
+    button.setSize (352, 40);
+
+    juce::Image target (juce::Image::ARGB, button.getWidth(), button.getHeight(), true, juce::SoftwareImageType());
+    juce::Graphics g (target);
+
+    auto microsecondsPerPaint = [iterations] (auto&& paint)
+    {
+        const auto start = juce::Time::getMillisecondCounterHiRes();
+
+        for (int i = 0; i < iterations; ++i)
+            paint ((i & 1) != 0);
+
+        return (juce::Time::getMillisecondCounterHiRes() - start) * 1000.0 / iterations;
+    };
+
+    const auto drawn = microsecondsPerPaint ([&] (bool highlighted)
+    {
+        lookAndFeel.paintButtonChrome (g, button.getLocalBounds().toFloat(), highlighted);
+    });
+
+    const auto cached = microsecondsPerPaint ([&] (bool highlighted)
+    {
+        lookAndFeel.drawButtonBackground (g, button, {}, highlighted, false);
+    });
+
+    std::cout << "Button chrome " << button.getWidth() << "x" << button.getHeight() << ", " << iterations << " paints: "
+              << juce::String (drawn, 1) << " us drawn, " << juce::String (cached, 1) << " us cached" << std::endl;
+    return 0;
+}
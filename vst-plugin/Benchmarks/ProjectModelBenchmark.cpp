@@ -0,0 +1,111 @@
+#include <juce_core/juce_core.h>
+#include <iostream>
+#include "AllocationCounter.h"
+#include "../Source/SemanticDelta.h"
+
+namespace
+{
+    template <typename Function>
+    double fastestSeconds (int iterations, Function&& function)
+    {
+        double fastest = 0.0;
+
+        for (int i = 0; i < iterations; ++i)
+        {
+            const auto start = juce::Time::getMillisecondCounterHiRes();
+            function();
+            const auto seconds = (juce::Time::getMillisecondCounterHiRes() - start) / 1000.0;
+            fastest = i == 0 ? seconds : juce::jmin (fastest, seconds);
+        }
+
+        return fastest;
+    }
+
+    juce::String toMiB (size_t bytes)
+    {
+        return juce::String ((double) bytes / (1024.0 * 1024.0), 2) + " MiB";
+    }
+
+    juce::String toMs (double seconds)
+    {
+        return juce::String (seconds * 1000.0, 1) + " ms";
+    }
+}
+
+//==============================================================================
+/**
+ * Loads a set into a ColDawProjectModel and into a juce::XmlDocument tree,
+ * printing the time and retained memory of each, then times the semantic
+ * delta between two versions of the set and hashing its canonical form.
+ *
+ * Usage: ColDawProjectModelBenchmark <base.als> [target.als] [iterations]
+ */
+int main (int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: ColDawProjectModelBenchmark <base.als> [target.als] [iterations]" << std::endl;
+        return 1;
+    }
+
+    const auto cwd = juce::File::getCurrentWorkingDirectory();
+    const auto baseFile = cwd.getChildFile (argv[1]);
+    const auto targetFile = argc > 2 ? cwd.getChildFile (argv[2]) : baseFile;
+    const auto iterations = argc > 3 ? juce::jmax (1, juce::String (argv[3]).getIntValue()) : 3;
+
+    juce::MemoryBlock baseData, targetData;
+    if (! baseFile.loadFileAsData (baseData) || ! targetFile.loadFileAsData (targetData))
+    {
+        std::cerr << "Can't read " << baseFile.getFullPathName() << " or " << targetFile.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    auto loadModel = [] (const juce::MemoryBlock& data)
+    {
+        juce::MemoryInputStream source (data, false);
+        return ColDawProjectModel::load (source);
+    };
+
+    auto loadDocument = [] (const juce::MemoryBlock& data)
+    {
+        juce::MemoryInputStream source (data, false);
+        juce::GZIPDecompressorInputStream inflated (&source, false, juce::GZIPDecompressorInputStream::gzipFormat);
+        return juce::XmlDocument::parse (inflated.readEntireStreamAsString());
+    };
+
+    // Memory each representation keeps once loaded
+    auto before = AllocationCounter::current.load();
+    auto base = loadModel (baseData);
+    const auto modelBytes = AllocationCounter::current - before;
+
+    before = AllocationCounter::current.load();
+    auto document = loadDocument (baseData);
+    const auto documentBytes = AllocationCounter::current - before;
+
+    auto target = loadModel (targetData);
+
+    if (base == nullptr || target == nullptr || document == nullptr)
+    {
+        std::cerr << "Not a readable set" << std::endl;
+        return 1;
+    }
+
+    document.reset();
+
+    const auto modelSeconds = fastestSeconds (iterations, [&] { loadModel (baseData); });
+    const auto documentSeconds = fastestSeconds (iterations, [&] { loadDocument (baseData); });
+
+    juce::var script;
+    const auto deltaSeconds = fastestSeconds (iterations, [&] { script = ColDawSemanticDelta::createEditScript (*base, *target); });
+    const auto hashSeconds = fastestSeconds (iterations, [&] { ColDawSemanticDelta::getCanonicalHash (*target); });
+
+    std::cout << baseFile.getFileName() << ": " << (int) base->getNumElements() << " elements" << std::endl
+              << "ColDawProjectModel: " << toMs (modelSeconds) << " to load, " << toMiB (modelBytes) << " retained ("
+              << toMiB (base->getMemoryUsage()) << " reported)" << std::endl
+              << "juce::XmlDocument: " << toMs (documentSeconds) << " to load, " << toMiB (documentBytes) << " retained" << std::endl
+              << "Edit script to " << targetFile.getFileName() << ": " << toMs (deltaSeconds) << ", "
+              << juce::JSON::toString (script, true).getNumBytesAsUTF8() << " bytes of JSON" << std::endl
+              << "Canonical hash: " << toMs (hashSeconds) << std::endl;
+
+    return 0;
+}
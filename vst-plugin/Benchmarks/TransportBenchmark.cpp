@@ -0,0 +1,94 @@
+#include <juce_core/juce_core.h>
+#include <iostream>
+#include "../Source/TransportCodec.h"
+
+namespace
+{
+    // encode() only asks the thread whether it should stop
+    struct IdleThread : public juce::Thread
+    {
+        IdleThread() : juce::Thread ("Benchmark") {}
+        void run() override {}
+    };
+}
+
+//==============================================================================
+/**
+ * Encodes a set with ColDawTransportCodec at each level the picker chooses
+ * from, and prints the encoded size, the ratio to the inflated XML and the
+ * compression speed, next to the gzipped .als it started from.
+ *
+ * Usage: ColDawTransportBenchmark <set.als> [iterations]
+ */
+int main (int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: ColDawTransportBenchmark <set.als> [iterations]" << std::endl;
+        return 1;
+    }
+
+    const juce::File file (juce::File::getCurrentWorkingDirectory().getChildFile (argv[1]));
+    const auto iterations = argc > 2 ? juce::jmax (1, juce::String (argv[2]).getIntValue()) : 3;
+
+    juce::MemoryBlock gzipped;
+    if (! file.loadFileAsData (gzipped))
+    {
+        std::cerr << "Can't read " << file.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    juce::MemoryOutputStream xml;
+    {
+        juce::MemoryInputStream source (gzipped, false);
+        juce::GZIPDecompressorInputStream inflated (&source, false, juce::GZIPDecompressorInputStream::gzipFormat);
+        xml.writeFromInputStream (inflated, -1);
+    }
+
+    if (! ColDawTransportCodec::isAvailable() || xml.getDataSize() == 0)
+    {
+        std::cerr << "zstd isn't available, or " << file.getFileName() << " isn't a gzipped set" << std::endl;
+        return 1;
+    }
+
+    const auto inflatedSize = (double) xml.getDataSize();
+    std::cout << file.getFileName() << ": " << (juce::int64) inflatedSize << " bytes of XML, gzip "
+              << (juce::int64) gzipped.getSize() << " bytes (" << juce::String (inflatedSize / (double) gzipped.getSize(), 1)
+              << "x), " << ColDawTransportCodec::getEncodingName() << std::endl;
+
+    ColDawTransportCodec codec;
+    IdleThread thread;
+
+    for (const int level : { 1, 3, 6, 9, 15, 19 })
+    {
+        size_t encodedSize = 0;
+        double fastestSeconds = 0.0;
+
+        for (int i = 0; i < iterations; ++i)
+        {
+            juce::MemoryInputStream source (gzipped, false);
+            juce::MemoryOutputStream encoded;
+            auto levelUsed = level;
+
+            const auto start = juce::Time::getMillisecondCounterHiRes();
+
+            if (! codec.encode (source, encoded, thread, levelUsed))
+            {
+                std::cerr << "Level " << level << " failed" << std::endl;
+                return 1;
+            }
+
+            const auto seconds = (juce::Time::getMillisecondCounterHiRes() - start) / 1000.0;
+
+            encodedSize = encoded.getDataSize();
+            fastestSeconds = i == 0 ? seconds : juce::jmin (fastestSeconds, seconds);
+        }
+
+        // Includes inflating the gzip, as uploads do
+        std::cout << "level " << level << ": " << (juce::int64) encodedSize << " bytes ("
+                  << juce::String (inflatedSize / (double) encodedSize, 1) << "x), "
+                  << juce::String (inflatedSize / juce::jmax (fastestSeconds, 1.0e-6) / 1.0e6, 1) << " MB/s" << std::endl;
+    }
+
+    return 0;
+}
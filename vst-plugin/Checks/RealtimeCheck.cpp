@@ -0,0 +1,61 @@
+#include <juce_events/juce_events.h>
+#include <iostream>
+#include "../Source/PluginProcessor.h"
+
+//==============================================================================
+/**
+ * Plays a few seconds of audio through the processor the way a host would,
+ * in a build with COLDAW_REALTIME_CHECKS, so that any allocation in
+ * processBlock() aborts the process (see Source/RealtimeCheck.h). Runs with
+ * audio capture off and then on, with varying block sizes. Exits with 0 if
+ * every block got through.
+ *
+ * Capturing writes a take to the usual captures directory, as the plugin does.
+ *
+ * Usage: ColDawRealtimeCheck [seconds]
+ */
+int main (int argc, char* argv[])
+{
+    const juce::ScopedJuceInitialiser_GUI initialiser;
+    const auto seconds = argc > 1 ? juce::jmax (1, juce::String (argv[1]).getIntValue()) : 5;
+
+    constexpr double sampleRate = 48000.0;
+    constexpr int maxBlockSize = 512;
+    constexpr int numChannels = 2;
+
+    ColDawExportProcessor processor;
+    processor.setPlayConfigDetails (numChannels, numChannels, sampleRate, maxBlockSize);
+    processor.prepareToPlay (sampleRate, maxBlockSize);
+
+    juce::AudioBuffer<float> buffer (numChannels, maxBlockSize);
+    juce::MidiBuffer midi;
+    juce::Random random (1);
+
+    for (const bool capture : { false, true })
+    {
+        processor.setAudioCapture (capture);
+
+        for (juce::int64 position = 0; position < (juce::int64) (seconds * sampleRate);)
+        {
+            // Hosts may pass any size up to the one they prepared with
+            const auto numSamples = 1 + random.nextInt (maxBlockSize);
+            buffer.setSize (numChannels, numSamples, false, false, true);
+
+            for (int channel = 0; channel < numChannels; ++channel)
+                for (int i = 0; i < numSamples; ++i)
+                    buffer.setSample (channel, i, 0.25f * std::sin ((float) (position + i) * 0.05f));
+
+            processor.processBlock (buffer, midi);
+            position += numSamples;
+
+            // Roughly real time, so the capture thread keeps up as it would in a host
+            juce::Thread::sleep ((int) (numSamples * 1000 / (int) sampleRate));
+        }
+    }
+
+    processor.setAudioCapture (false);
+    processor.releaseResources();
+
+    std::cout << "processBlock didn't allocate in " << seconds * 2 << " seconds of audio" << std::endl;
+    return 0;
+}
@@ -0,0 +1,525 @@
+#include "AlsReader.h"
+#include <atomic>
+#include <cstring>
+#include <iterator>
+#include <string>
+
+namespace
+{
+    using Tag = ColDawAlsReader::Tag;
+
+    //==============================================================================
+    // Names in Tag order
+    constexpr std::string_view tagNames[] =
+    {
+        "",
+        "Ableton", "LiveSet", "Tracks", "AudioTrack", "MidiTrack", "GroupTrack", "ReturnTrack", "MasterTrack", "MainTrack", "PreHearTrack",
+        "Name", "EffectiveName", "UserName", "Annotation", "Color",
+        "DeviceChain", "Devices", "Mixer", "Tempo", "TimeSignature", "Manual", "Volume", "Pan",
+        "MainSequencer", "ClipSlotList", "ClipSlot", "ArrangerAutomation", "Events", "AudioClip", "MidiClip", "CurrentStart", "CurrentEnd",
+        "KeyTracks", "KeyTrack", "Notes", "MidiNoteEvent", "MidiKey",
+        "AutomationEnvelopes", "AutomationEnvelope", "ClipEnvelope", "Automation", "FloatEvent", "EnumEvent", "BoolEvent",
+        "PluginDevice", "AuPluginDevice", "PluginDesc", "VstPluginInfo", "Vst3PluginInfo", "AuPluginInfo", "PlugName",
+        "InstrumentGroupDevice", "AudioEffectGroupDevice", "MidiEffectGroupDevice", "DrumGroupDevice", "Branches",
+        "SampleRef", "FileRef", "Path", "RelativePath", "RelativePathType", "RelativePathElement",
+        "LomId", "LomIdView", "OverwriteProtectionNumber",
+        "Scenes", "Scene", "Locators", "Locator"
+    };
+
+    static_assert (std::size (tagNames) == (size_t) Tag::numTags, "Every Tag needs a name, in the same order");
+
+    //==============================================================================
+    // Perfect hash: a seeded FNV-1a, with the seed searched for at compile
+    // time so that no two tag names share a slot
+    constexpr juce::uint32 hashTableSize = 1024;
+
+    constexpr juce::uint32 hashName (std::string_view name, juce::uint32 seed) noexcept
+    {
+        auto h = 2166136261u ^ seed;
+
+        for (auto c : name)
+            h = (h ^ (juce::uint8) c) * 16777619u;
+
+        return (h ^ (h >> 15)) & (hashTableSize - 1);
+    }
+
+    constexpr bool isPerfectSeed (juce::uint32 seed) noexcept
+    {
+        bool used[hashTableSize] = {};
+
+        for (size_t i = 1; i < std::size (tagNames); ++i)
+        {
+            const auto slot = hashName (tagNames[i], seed);
+
+            if (used[slot])
+                return false;
+
+            used[slot] = true;
+        }
+
+        return true;
+    }
+
+    constexpr juce::uint32 findPerfectSeed() noexcept
+    {
+        for (juce::uint32 seed = 1; seed < 10000; ++seed)
+            if (isPerfectSeed (seed))
+                return seed;
+
+        return 0;
+    }
+
+    constexpr auto hashSeed = findPerfectSeed();
+    static_assert (hashSeed != 0, "No perfect hash for the tag names; make the table bigger");
+
+    struct TagTable
+    {
+        juce::uint8 slots[hashTableSize] = {};  // Tag index, 0 for an empty slot
+    };
+
+    constexpr TagTable makeTagTable() noexcept
+    {
+        TagTable table;
+
+        for (size_t i = 1; i < std::size (tagNames); ++i)
+            table.slots[hashName (tagNames[i], hashSeed)] = (juce::uint8) i;
+
+        return table;
+    }
+
+    constexpr auto tagTable = makeTagTable();
+
+    //==============================================================================
+    constexpr int chunkSize = 1 << 19;
+    constexpr int numChunks = 4;
+
+    /**
+     * Reads (and so inflates) the source on its own thread, up to numChunks
+     * ahead of the tokenizer. Each chunk is handed over with a flag: the
+     * reader fills a chunk whose flag is clear and sets it, the tokenizer
+     * clears it once done with the chunk.
+     */
+    class ReadAheadThread : public juce::Thread
+    {
+    public:
+        explicit ReadAheadThread (juce::InputStream& s)
+            : juce::Thread ("ColDaw ALS Reader"),
+              source (s)
+        {
+            for (auto& chunk : chunks)
+                chunk.data.malloc (chunkSize);
+
+            startThread (juce::Thread::Priority::background);
+        }
+
+        ~ReadAheadThread() override
+        {
+            signalThreadShouldExit();
+            spaceReady.signal();
+            stopThread (10000);
+        }
+
+        /** The next chunk, waiting for it if need be; empty at the end of the stream. */
+        std::string_view next()
+        {
+            if (current != nullptr)
+            {
+                current->filled.store (false, std::memory_order_release);
+                spaceReady.signal();
+            }
+
+            current = &chunks[numTaken++ % numChunks];
+
+            while (! current->filled.load (std::memory_order_acquire))
+                dataReady.wait (-1);
+
+            return { current->data.get(), current->size };
+        }
+
+    private:
+        struct Chunk
+        {
+            juce::HeapBlock<char> data;
+            size_t size = 0;
+            std::atomic<bool> filled { false };
+        };
+
+        void run() override
+        {
+            for (size_t i = 0; ! threadShouldExit(); ++i)
+            {
+                auto& chunk = chunks[i % numChunks];
+
+                while (chunk.filled.load (std::memory_order_acquire))
+                {
+                    spaceReady.wait (-1);
+
+                    if (threadShouldExit())
+                        return;
+                }
+
+                const auto numRead = source.read (chunk.data, chunkSize);
+                chunk.size = (size_t) juce::jmax (0, numRead);
+                chunk.filled.store (true, std::memory_order_release);
+                dataReady.signal();
+
+                if (numRead <= 0)
+                    return;
+            }
+        }
+
+        juce::InputStream& source;
+        Chunk chunks[numChunks];
+        Chunk* current = nullptr;
+        size_t numTaken = 0;
+        juce::WaitableEvent dataReady, spaceReady;
+    };
+
+    bool isSpace (char c) noexcept    { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+}
+
+//==============================================================================
+/**
+ * Parses tags straight out of the read buffers. A tag cut off by the end
+ * of a buffer is kept back and finished from the next one; everything
+ * else is parsed in place.
+ */
+class ColDawAlsReader::Tokenizer
+{
+public:
+    explicit Tokenizer (Handler& h) : handler (h) {}
+
+    /** Parses a buffer; false if the document is malformed. */
+    bool feed (const char* data, size_t size)
+    {
+        auto* p = data;
+        auto* end = data + size;
+
+        // Finish the tag left over from the last buffer, one '>' at a time
+        while (! pending.empty() && p < end)
+        {
+            auto* close = static_cast<const char*> (std::memchr (p, '>', (size_t) (end - p)));
+            auto* stop = close != nullptr ? close + 1 : end;
+
+            pending.append (p, stop);
+            p = stop;
+
+            const char* next = nullptr;
+            const auto result = parseTag (pending.data(), pending.data() + pending.size(), next);
+
+            if (result == Result::malformed)
+                return false;
+
+            if (result == Result::complete)
+                pending.clear();
+        }
+
+        while (p < end)
+        {
+            auto* open = static_cast<const char*> (std::memchr (p, '<', (size_t) (end - p)));
+
+            if (open == nullptr)
+                break;  // Text between tags is skipped
+
+            const char* next = nullptr;
+            const auto result = parseTag (open, end, next);
+
+            if (result == Result::malformed)
+                return false;
+
+            if (result == Result::incomplete)
+            {
+                pending.assign (open, end);
+                break;
+            }
+
+            p = next;
+        }
+
+        return true;
+    }
+
+    bool isComplete() const noexcept    { return sawRoot && depth == 0 && pending.empty(); }
+
+private:
+    enum class Result { complete, incomplete, malformed };
+
+    static const char* find (const char* p, const char* end, std::string_view what) noexcept
+    {
+        const auto index = std::string_view (p, (size_t) (end - p)).find (what);
+        return index == std::string_view::npos ? nullptr : p + index + what.size();
+    }
+
+    /** Parses the tag starting at p ('<'); on success next points past its '>'. */
+    Result parseTag (const char* p, const char* end, const char*& next)
+    {
+        if (end - p < 2)
+            return Result::incomplete;
+
+        // Comments, CDATA, DOCTYPE and processing instructions
+        if (p[1] == '!' || p[1] == '?')
+        {
+            const auto* terminator = p[1] == '?' ? "?>" : ">";
+
+            if (p[1] == '!')
+            {
+                // Enough to tell a comment or CDATA from a DOCTYPE
+                if (end - p < 3 || end - p < (p[2] == '[' ? 9 : 4))
+                    return Result::incomplete;
+
+                if (std::string_view (p, 4) == "<!--")
+                    terminator = "-->";
+                else if (p[2] == '[' && std::string_view (p, 9) == "<![CDATA[")
+                    terminator = "]]>";
+            }
+
+            next = find (p + 2, end, terminator);
+            return next != nullptr ? Result::complete : Result::incomplete;
+        }
+
+        if (p[1] == '/')
+        {
+            auto* close = static_cast<const char*> (std::memchr (p, '>', (size_t) (end - p)));
+
+            if (close == nullptr)
+                return Result::incomplete;
+
+            auto name = std::string_view (p + 2, (size_t) (close - p - 2));
+
+            while (! name.empty() && isSpace (name.back()))
+                name.remove_suffix (1);
+
+            if (depth == 0)
+                return Result::malformed;
+
+            --depth;
+            handler.endElement (lookupTag (name), name);
+            next = close + 1;
+            return Result::complete;
+        }
+
+        auto* i = p + 1;
+
+        while (i < end && ! isSpace (*i) && *i != '>' && *i != '/')
+            ++i;
+
+        if (i >= end)
+            return Result::incomplete;
+
+        const auto name = std::string_view (p + 1, (size_t) (i - p - 1));
+        bool selfClosing = false;
+        attributes.list.clear();
+
+        if (name.empty())
+            return Result::malformed;
+
+        for (;;)
+        {
+            while (i < end && isSpace (*i))
+                ++i;
+
+            if (i >= end)
+                return Result::incomplete;
+
+            if (*i == '>')
+            {
+                next = i + 1;
+                break;
+            }
+
+            if (*i == '/')
+            {
+                if (i + 1 >= end)
+                    return Result::incomplete;
+
+                if (i[1] != '>')
+                    return Result::malformed;
+
+                selfClosing = true;
+                next = i + 2;
+                break;
+            }
+
+            const auto* nameStart = i;
+
+            while (i < end && *i != '=' && ! isSpace (*i) && *i != '>' && *i != '/')
+                ++i;
+
+            const auto attributeName = std::string_view (nameStart, (size_t) (i - nameStart));
+
+            if (attributeName.empty())
+                return Result::malformed;
+
+            while (i < end && isSpace (*i))
+                ++i;
+
+            if (i + 1 >= end)
+                return Result::incomplete;
+
+            if (*i != '=')
+            {
+                // Tolerate an attribute without a value, as the DOM parser did
+                attributes.list.emplace_back (attributeName, std::string_view());
+                continue;
+            }
+
+            ++i;
+
+            while (i < end && isSpace (*i))
+                ++i;
+
+            if (i >= end)
+                return Result::incomplete;
+
+            const auto quote = *i++;
+
+            if (quote != '"' && quote != '\'')
+                return Result::malformed;
+
+            auto* close = static_cast<const char*> (std::memchr (i, quote, (size_t) (end - i)));
+
+            if (close == nullptr)
+                return Result::incomplete;
+
+            attributes.list.emplace_back (attributeName, std::string_view (i, (size_t) (close - i)));
+            i = close + 1;
+        }
+
+        if (sawRoot && depth == 0)
+            return Result::malformed;  // A second root element
+
+        const auto tag = lookupTag (name);
+        sawRoot = true;
+        ++depth;
+        handler.startElement (tag, name, attributes);
+
+        if (selfClosing)
+        {
+            --depth;
+            handler.endElement (tag, name);
+        }
+
+        return Result::complete;
+    }
+
+    Handler& handler;
+    Attributes attributes;
+    std::string pending;
+    int depth = 0;
+    bool sawRoot = false;
+};
+
+//==============================================================================
+std::string_view ColDawAlsReader::Attributes::get (std::string_view name) const noexcept
+{
+    for (auto& attribute : list)
+        if (attribute.first == name)
+            return attribute.second;
+
+    return {};
+}
+
+bool ColDawAlsReader::Attributes::contains (std::string_view name) const noexcept
+{
+    for (auto& attribute : list)
+        if (attribute.first == name)
+            return true;
+
+    return false;
+}
+
+void ColDawAlsReader::HandlerList::startElement (Tag tag, std::string_view name, const Attributes& attributes)
+{
+    for (auto* handler : handlers)
+        handler->startElement (tag, name, attributes);
+}
+
+void ColDawAlsReader::HandlerList::endElement (Tag tag, std::string_view name)
+{
+    for (auto* handler : handlers)
+        handler->endElement (tag, name);
+}
+
+//==============================================================================
+ColDawAlsReader::Tag ColDawAlsReader::lookupTag (std::string_view name) noexcept
+{
+    const auto index = tagTable.slots[hashName (name, hashSeed)];
+    return index != 0 && tagNames[index] == name ? (Tag) index : Tag::unknown;
+}
+
+std::string_view ColDawAlsReader::getTagName (Tag tag) noexcept
+{
+    return (size_t) tag < std::size (tagNames) ? tagNames[(size_t) tag] : std::string_view();
+}
+
+juce::String ColDawAlsReader::toString (std::string_view value)
+{
+    if (value.find ('&') == std::string_view::npos)
+        return juce::String::fromUTF8 (value.data(), (int) value.size());
+
+    std::string decoded;
+    decoded.reserve (value.size());
+
+    for (size_t i = 0; i < value.size(); ++i)
+    {
+        const auto end = value[i] == '&' ? value.find (';', i) : std::string_view::npos;
+
+        if (end == std::string_view::npos)
+        {
+            decoded += value[i];
+            continue;
+        }
+
+        const auto entity = value.substr (i + 1, end - i - 1);
+
+        if (entity == "lt")         decoded += '<';
+        else if (entity == "gt")    decoded += '>';
+        else if (entity == "amp")   decoded += '&';
+        else if (entity == "quot")  decoded += '"';
+        else if (entity == "apos")  decoded += '\'';
+        else if (entity.size() > 1 && entity[0] == '#')
+        {
+            const auto digits = juce::String (entity.data() + 1, entity.size() - 1);
+            const auto code = digits.startsWithIgnoreCase ("x") ? digits.substring (1).getHexValue32() : digits.getIntValue();
+            decoded += juce::String::charToString ((juce::juce_wchar) code).toStdString();
+        }
+        else
+        {
+            decoded += value[i];
+            continue;
+        }
+
+        i = end;
+    }
+
+    return juce::String (decoded);
+}
+
+//==============================================================================
+bool ColDawAlsReader::read (juce::InputStream& input, Handler& handler, const std::function<bool()>& shouldAbort)
+{
+    // Sets are normally gzipped, but Live also reads plain XML
+    juce::uint8 magic[2] = {};
+    const bool gzipped = input.read (magic, 2) == 2 && magic[0] == 0x1f && magic[1] == 0x8b;
+
+    if (! input.setPosition (0))
+        return false;
+
+    juce::GZIPDecompressorInputStream inflated (&input, false, juce::GZIPDecompressorInputStream::gzipFormat);
+    ReadAheadThread source (gzipped ? static_cast<juce::InputStream&> (inflated) : input);
+    Tokenizer tokenizer (handler);
+
+    for (;;)
+    {
+        if (shouldAbort != nullptr && shouldAbort())
+            return false;
+
+        const auto chunk = source.next();
+
+        if (chunk.empty())
+            return tokenizer.isComplete();
+
+        if (! tokenizer.feed (chunk.data(), chunk.size()))
+            return false;
+    }
+}
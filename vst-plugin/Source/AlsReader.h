@@ -0,0 +1,108 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <functional>
+#include <initializer_list>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+//==============================================================================
+/**
+ * ColDaw Export Plugin - streaming .als reader
+ *
+ * Reads a set (gzipped or plain XML) in one pass and reports each element to
+ * a Handler as it goes, SAX style, without building a document. Memory use
+ * stays at a few read buffers however large the set is.
+ *
+ * Inflating runs on its own thread, a few buffers ahead of the tokenizer on
+ * the calling thread, so the two overlap. Element names are mapped to a Tag
+ * through a perfect hash of the Ableton names the plugin cares about, built
+ * at compile time; handlers switch on the Tag instead of comparing strings.
+ * Names not in the table come through as Tag::unknown, with the name still
+ * available.
+ *
+ * Text content, comments and processing instructions are skipped; Live
+ * keeps everything in attributes.
+ */
+class ColDawAlsReader
+{
+public:
+    //==============================================================================
+    /** Element names with a Tag. Add new ones before numTags; the hash adapts. */
+    enum class Tag : juce::uint8
+    {
+        unknown,
+        Ableton, LiveSet, Tracks, AudioTrack, MidiTrack, GroupTrack, ReturnTrack, MasterTrack, MainTrack, PreHearTrack,
+        Name, EffectiveName, UserName, Annotation, Color,
+        DeviceChain, Devices, Mixer, Tempo, TimeSignature, Manual, Volume, Pan,
+        MainSequencer, ClipSlotList, ClipSlot, ArrangerAutomation, Events, AudioClip, MidiClip, CurrentStart, CurrentEnd,
+        KeyTracks, KeyTrack, Notes, MidiNoteEvent, MidiKey,
+        AutomationEnvelopes, AutomationEnvelope, ClipEnvelope, Automation, FloatEvent, EnumEvent, BoolEvent,
+        PluginDevice, AuPluginDevice, PluginDesc, VstPluginInfo, Vst3PluginInfo, AuPluginInfo, PlugName,
+        InstrumentGroupDevice, AudioEffectGroupDevice, MidiEffectGroupDevice, DrumGroupDevice, Branches,
+        SampleRef, FileRef, Path, RelativePath, RelativePathType, RelativePathElement,
+        LomId, LomIdView, OverwriteProtectionNumber,
+        Scenes, Scene, Locators, Locator,
+        numTags
+    };
+
+    /** The attributes of one element, valid only during the callback. */
+    class Attributes
+    {
+    public:
+        using Attribute = std::pair<std::string_view, std::string_view>;
+
+        /** The raw value of an attribute (entities not decoded), or empty if it's absent. */
+        std::string_view get (std::string_view name) const noexcept;
+        bool contains (std::string_view name) const noexcept;
+
+        auto begin() const noexcept     { return list.begin(); }
+        auto end() const noexcept       { return list.end(); }
+        size_t size() const noexcept    { return list.size(); }
+
+    private:
+        friend class ColDawAlsReader;
+        std::vector<Attribute> list;
+    };
+
+    class Handler
+    {
+    public:
+        virtual ~Handler() = default;
+
+        virtual void startElement (Tag tag, std::string_view name, const Attributes& attributes) = 0;
+        virtual void endElement (Tag tag, std::string_view name) = 0;
+    };
+
+    /** Passes every element on to several handlers, so that one read can feed them all. */
+    class HandlerList : public Handler
+    {
+    public:
+        HandlerList (std::initializer_list<Handler*> handlersToCall) : handlers (handlersToCall) {}
+
+        void startElement (Tag tag, std::string_view name, const Attributes& attributes) override;
+        void endElement (Tag tag, std::string_view name) override;
+
+    private:
+        std::vector<Handler*> handlers;
+    };
+
+    //==============================================================================
+    /**
+     * Reads the whole set, calling the handler for every element. Returns false
+     * if the input isn't a complete, well-nested document or shouldAbort said so.
+     */
+    static bool read (juce::InputStream& input, Handler& handler, const std::function<bool()>& shouldAbort = nullptr);
+
+    static Tag lookupTag (std::string_view name) noexcept;
+    static std::string_view getTagName (Tag tag) noexcept;
+
+    /** An attribute value as a String, with XML entities decoded. */
+    static juce::String toString (std::string_view value);
+
+private:
+    class Tokenizer;
+
+    ColDawAlsReader() = delete;
+};
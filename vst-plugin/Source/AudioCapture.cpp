@@ -0,0 +1,322 @@
+#include "AudioCapture.h"
+#include <utility>
+
+namespace
+{
+    constexpr int maxChannels = 2;            // Previews are mono or stereo
+    constexpr double ringSeconds = 4.0;       // How far the encoder may fall behind before audio is lost
+    constexpr double maxTakeSeconds = 600.0;  // Longer takes keep only their first ten minutes
+    constexpr int previewTimeoutMs = 120000;
+
+    // Each instance touches its directory this often; one untouched for a day belongs to no one
+    constexpr juce::uint32 heartbeatIntervalMs = 60 * 60 * 1000;
+    const auto staleAfter = juce::RelativeTime::days (1);
+
+    using Severity = ColDawStatusLog::Severity;
+    using Operation = ColDawStatusLog::Operation;
+}
+
+//==============================================================================
+ColDawAudioCapture::ColDawAudioCapture (ColDawStatusLog& log, const juce::File& captureDirectory)
+    : juce::Thread ("ColDaw Audio Capture"),
+      statusLog (log),
+      directory (captureDirectory.getChildFile (juce::Uuid().toString())),
+      uploadThreads (1)
+{
+    // Every instance, in this host or another, records into its own directory.
+    // Only ones that have gone a day without their owner touching them are
+    // left over from a host that quit before its takes were sent.
+    const auto cutoff = juce::Time::getCurrentTime() - staleAfter;
+
+    for (auto& entry : juce::RangedDirectoryIterator (captureDirectory, false, "*", juce::File::findFilesAndDirectories))
+        if (entry.getModificationTime() < cutoff)
+            entry.getFile().deleteRecursively();
+
+    startThread (juce::Thread::Priority::background);
+}
+
+ColDawAudioCapture::~ColDawAudioCapture()
+{
+    stopThread (10000);
+    uploadThreads.removeAllJobs (true, 10000);
+    discardTake();
+    directory.deleteRecursively();
+}
+
+void ColDawAudioCapture::prepare (double newSampleRate, int numChannels)
+{
+    const juce::ScopedLock sl (lock);
+
+    const auto capacity = juce::jmax (1, juce::roundToInt (newSampleRate * ringSeconds));
+    sampleRate = newSampleRate;
+    ring.setSize (juce::jlimit (1, maxChannels, numChannels), capacity);
+    fifo.setTotalSize (capacity);
+    prepared = true;
+}
+
+void ColDawAudioCapture::process (const juce::AudioBuffer<float>& buffer) noexcept
+{
+    const auto numSamples = buffer.getNumSamples();
+    const auto numChannels = ring.getNumChannels();
+
+    if (! isEnabled() || numChannels == 0 || buffer.getNumChannels() == 0 || numSamples == 0)
+        return;
+
+    if (fifo.getFreeSpace() < numSamples)
+    {
+        droppedSamples.fetch_add (numSamples, std::memory_order_relaxed);
+        return;
+    }
+
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite (numSamples, start1, size1, start2, size2);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        // A mono signal fills both sides of a stereo take
+        const auto* source = buffer.getReadPointer (juce::jmin (channel, buffer.getNumChannels() - 1));
+
+        juce::FloatVectorOperations::copy (ring.getWritePointer (channel, start1), source, size1);
+
+        if (size2 > 0)
+            juce::FloatVectorOperations::copy (ring.getWritePointer (channel, start2), source + size1, size2);
+    }
+
+    fifo.finishedWrite (size1 + size2);
+}
+
+void ColDawAudioCapture::attach (const juce::URL& previewUrl, const juce::String& authToken)
+{
+    {
+        const juce::ScopedLock sl (lock);
+        pendingAttachment = std::make_unique<Attachment> (Attachment { previewUrl, authToken });
+    }
+
+    notify();
+}
+
+//==============================================================================
+void ColDawAudioCapture::run()
+{
+    auto lastHeartbeat = juce::Time::getMillisecondCounter();
+
+    while (! threadShouldExit())
+    {
+        wait (100);
+
+        // Tells other instances' startup cleanup that this directory is in use
+        if (juce::Time::getMillisecondCounter() - lastHeartbeat >= heartbeatIntervalMs)
+        {
+            lastHeartbeat = juce::Time::getMillisecondCounter();
+
+            if (directory.isDirectory())
+                directory.setLastModificationTime (juce::Time::getCurrentTime());
+        }
+
+        double rate = 0.0;
+        bool wasPrepared = false;
+        int numChannels = 0, numSamples = 0;
+        std::unique_ptr<Attachment> attachment;
+
+        {
+            // Only long enough to move the ready audio out of the ring; encoding happens after
+            const juce::ScopedLock sl (lock);
+            rate = sampleRate;
+            numChannels = ring.getNumChannels();
+            wasPrepared = std::exchange (prepared, false);
+            numSamples = takeReadySamples();
+            attachment = std::move (pendingAttachment);
+        }
+
+        if (wasPrepared)
+        {
+            // A new format needs a new take; the same one carries on, and a failed take is retried
+            if (writer != nullptr && (rate != takeSampleRate || (int) writer->getNumChannels() != numChannels))
+                discardTake();
+
+            takeFailed = false;
+        }
+
+        if (const auto dropped = droppedSamples.exchange (0, std::memory_order_relaxed))
+            statusLog.post (Severity::warning, Operation::audio,
+                            "Audio capture fell behind; " + juce::String (dropped / rate, 2) + " s of audio lost");
+
+        if (! isEnabled())
+            discardTake();
+        else if (numSamples > 0 && (writer != nullptr || startTake (rate)))
+            encode (numSamples);
+
+        if (attachment != nullptr)
+            finishTake (std::move (attachment));
+    }
+}
+
+int ColDawAudioCapture::takeReadySamples()
+{
+    const auto ready = fifo.getNumReady();
+
+    if (ready == 0)
+        return 0;
+
+    int start1, size1, start2, size2;
+    fifo.prepareToRead (ready, start1, size1, start2, size2);
+    scratch.setSize (ring.getNumChannels(), ready, false, false, true);
+
+    for (int channel = 0; channel < ring.getNumChannels(); ++channel)
+    {
+        auto* destination = scratch.getWritePointer (channel);
+        juce::FloatVectorOperations::copy (destination, ring.getReadPointer (channel, start1), size1);
+
+        if (size2 > 0)
+            juce::FloatVectorOperations::copy (destination + size1, ring.getReadPointer (channel, start2), size2);
+    }
+
+    fifo.finishedRead (size1 + size2);
+    return ready;
+}
+
+void ColDawAudioCapture::encode (int numSamples)
+{
+    const auto room = juce::jmax ((juce::int64) 0, (juce::int64) (maxTakeSeconds * takeSampleRate) - takeSamples);
+    const auto count = (int) juce::jmin ((juce::int64) numSamples, room);
+
+    if (count < numSamples && ! takeTruncated)
+    {
+        takeTruncated = true;
+        statusLog.post (Severity::warning, Operation::audio, "Audio preview is limited to the first ten minutes since the last export");
+    }
+
+    if (count <= 0)
+        return;
+
+    writer->writeFromFloatArrays (scratch.getArrayOfReadPointers(), scratch.getNumChannels(), count);
+    peaks.addSamples (scratch.getArrayOfReadPointers(), count);
+    takeSamples += count;
+}
+
+bool ColDawAudioCapture::startTake (double rate)
+{
+    if (takeFailed)
+        return false;
+
+    directory.createDirectory();
+    takeFile = directory.getNonexistentChildFile ("take", ".flac", false);
+
+    auto stream = std::make_unique<juce::FileOutputStream> (takeFile);
+
+    if (stream->openedOk())
+        writer.reset (juce::FlacAudioFormat().createWriterFor (stream.get(), rate, (unsigned int) scratch.getNumChannels(),
+                                                               16, {}, 5));
+
+    if (writer == nullptr)
+    {
+        // Reported once; preparing again (new format, or the host restarting) retries
+        takeFailed = true;
+        stream.reset();
+        takeFile.deleteFile();
+        takeFile = juce::File();
+        statusLog.post (Severity::error, Operation::audio, "Error: Couldn't write the audio preview in " + directory.getFullPathName());
+        return false;
+    }
+
+    stream.release();  // Owned by the writer now
+    peaks.reset (scratch.getNumChannels(), rate);
+    takeSampleRate = rate;
+    takeSamples = 0;
+    takeTruncated = false;
+    return true;
+}
+
+void ColDawAudioCapture::finishTake (std::unique_ptr<Attachment> attachment)
+{
+    if (writer == nullptr)
+    {
+        statusLog.post (Severity::info, Operation::audio, "No audio was captured for this export");
+        return;
+    }
+
+    // Closing the writer finishes the file; the next block starts a new take
+    writer.reset();
+
+    auto take = std::make_shared<Take>();
+    take->file = takeFile;
+    take->attachment = std::move (*attachment);
+
+    juce::MemoryOutputStream peakStream (take->peakData, false);
+    peaks.writeTo (peakStream);
+
+    takeFile = juce::File();
+    takeSamples = 0;
+    takeTruncated = false;
+
+    // Sending can take far longer than the ring holds, so it doesn't hold up encoding
+    uploadThreads.addJob ([this, take]
+    {
+        upload (*take);
+        take->file.deleteFile();
+    });
+}
+
+void ColDawAudioCapture::discardTake()
+{
+    writer.reset();
+
+    if (takeFile != juce::File())
+        takeFile.deleteFile();
+
+    takeFile = juce::File();
+    takeSamples = 0;
+    takeTruncated = false;
+}
+
+void ColDawAudioCapture::upload (const Take& take)
+{
+    const auto& attachment = take.attachment;
+    const auto& peakData = take.peakData;
+    const double started = juce::Time::getMillisecondCounterHiRes();
+    const auto size = take.file.getSize();
+
+    statusLog.post (Severity::progress, Operation::audio,
+                    "Uploading audio preview (" + juce::File::descriptionOfSizeInBytes (size) + ")...");
+
+    auto response = put (attachment.url, attachment.authToken, "audio/flac",
+                         [&] { return std::make_unique<juce::FileInputStream> (take.file); });
+
+    // The peaks are only useful next to the audio they describe
+    if (response.isSuccess())
+        response = put (attachment.url.getChildURL ("peaks"), attachment.authToken, "application/octet-stream",
+                        [&] { return std::make_unique<juce::MemoryInputStream> (peakData, false); });
+
+    if (threadShouldExit())
+        return;
+
+    const auto seconds = (juce::Time::getMillisecondCounterHiRes() - started) / 1000.0;
+
+    if (response.isSuccess())
+        statusLog.post (Severity::success, Operation::audio,
+                        "Audio preview attached (" + juce::File::descriptionOfSizeInBytes (size) + " with "
+                            + juce::File::descriptionOfSizeInBytes ((juce::int64) peakData.getSize()) + " of waveform peaks)", seconds);
+    else if (response.connected)
+        statusLog.post (Severity::error, Operation::audio,
+                        "Error: Audio preview upload failed (HTTP " + juce::String (response.statusCode) + ")", seconds);
+    else
+        statusLog.post (Severity::error, Operation::audio, "Error: Audio preview upload failed (no connection)", seconds);
+}
+
+ColDawHttpClient::Response ColDawAudioCapture::put (const juce::URL& url, const juce::String& authToken, const juce::String& contentType,
+                                                    const std::function<std::unique_ptr<juce::InputStream>()>& openBody)
+{
+    return ColDawHttpClient::performWithRetry (*this, [&]
+    {
+        const auto body = openBody();
+
+        ColDawHttpClient::Request request;
+        request.url = url;
+        request.method = "PUT";
+        request.headers = "Authorization: Bearer " + authToken + "\r\nContent-Type: " + contentType;
+        request.body = body.get();
+        request.connectionTimeoutMs = previewTimeoutMs;
+        request.shouldAbort = [this] { return threadShouldExit(); };
+        return httpClient->perform (request);
+    });
+}
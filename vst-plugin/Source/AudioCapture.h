@@ -0,0 +1,106 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <atomic>
+#include <memory>
+#include "HttpClient.h"
+#include "PeakPyramid.h"
+#include "StatusLog.h"
+
+//==============================================================================
+/**
+ * ColDaw Export Plugin - Audio Capture
+ *
+ * Records what passes through the plugin while capture is on, so an export
+ * can carry an audio preview that collaborators can listen to on the web.
+ *
+ * The audio thread only copies each block into a ring buffer that is
+ * allocated in prepare(): no allocations, no locks, and if the ring is ever
+ * full the block is counted as lost instead of waiting. A background thread
+ * moves the audio out of the ring and encodes it into a FLAC file - the
+ * current take - and into a waveform peak pyramid of it. When an export has
+ * been uploaded, attach() has that thread close the take and start a new
+ * one; the closed take and its peaks are sent to the server as the export's
+ * preview on a separate upload thread, so a slow upload never stops the
+ * ring from being drained.
+ */
+class ColDawAudioCapture : private juce::Thread
+{
+public:
+    //==============================================================================
+    /** Takes are recorded in a subdirectory of captureDirectory of this instance's own. */
+    ColDawAudioCapture (ColDawStatusLog& statusLog, const juce::File& captureDirectory);
+    ~ColDawAudioCapture() override;
+
+    /** Allocates the ring for this format. Must not be called while process() can
+        run, which the host guarantees for prepareToPlay(). A take recorded in a
+        different format is discarded.
+    */
+    void prepare (double sampleRate, int numChannels);
+
+    void setEnabled (bool shouldCapture) noexcept   { enabled.store (shouldCapture, std::memory_order_relaxed); }
+    bool isEnabled() const noexcept                 { return enabled.load (std::memory_order_relaxed); }
+
+    /** Audio thread: queues a block for the current take. Never allocates or blocks. */
+    void process (const juce::AudioBuffer<float>& buffer) noexcept;
+
+    /** Sends the current take, closed at this point, to previewUrl with a PUT. */
+    void attach (const juce::URL& previewUrl, const juce::String& authToken);
+
+private:
+    //==============================================================================
+    struct Attachment
+    {
+        juce::URL url;
+        juce::String authToken;
+    };
+
+    struct Take
+    {
+        juce::File file;
+        juce::MemoryBlock peakData;
+        Attachment attachment;
+    };
+
+    void run() override;
+    int takeReadySamples();
+    void encode (int numSamples);
+    bool startTake (double rate);
+    void finishTake (std::unique_ptr<Attachment>);
+    void discardTake();
+    void upload (const Take&);
+    ColDawHttpClient::Response put (const juce::URL&, const juce::String& authToken, const juce::String& contentType,
+                                    const std::function<std::unique_ptr<juce::InputStream>()>& openBody);
+
+    ColDawStatusLog& statusLog;
+    const juce::File directory;  // This instance's own
+    juce::SharedResourcePointer<ColDawHttpClient> httpClient;
+
+    std::atomic<bool> enabled { false };
+    std::atomic<juce::int64> droppedSamples { 0 };
+
+    // Reallocated by prepare() only; the audio thread writes the ring through the FIFO
+    juce::AudioBuffer<float> ring;
+    juce::AbstractFifo fifo { 1 };
+
+    // Ring format and pending attachment; held briefly, and never by the audio thread
+    juce::CriticalSection lock;
+    double sampleRate = 0.0;
+    bool prepared = false;
+    std::unique_ptr<Attachment> pendingAttachment;
+
+    // The capture thread's own
+    juce::AudioBuffer<float> scratch;
+    std::unique_ptr<juce::AudioFormatWriter> writer;
+    juce::File takeFile;
+    double takeSampleRate = 0.0;
+    juce::int64 takeSamples = 0;
+    ColDawPeakPyramid peaks;
+    bool takeTruncated = false;
+    bool takeFailed = false;
+
+    juce::ThreadPool uploadThreads;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ColDawAudioCapture)
+};
@@ -0,0 +1,84 @@
+#include "BackgroundRequests.h"
+
+//==============================================================================
+ColDawBackgroundRequests::ColDawBackgroundRequests()
+    : juce::Thread ("ColDaw Background Requests")
+{
+    startThread (juce::Thread::Priority::background);
+}
+
+ColDawBackgroundRequests::~ColDawBackgroundRequests()
+{
+    stopThread (10000);
+    cancelPendingUpdate();
+}
+
+void ColDawBackgroundRequests::perform (ColDawHttpClient::Request request, const juce::String& body, Callback onResponse)
+{
+    auto pending = std::make_unique<Pending>();
+    pending->request = std::move (request);
+    pending->body = body;
+    pending->onResponse = std::move (onResponse);
+
+    {
+        const juce::ScopedLock sl (lock);
+        queued.push_back (std::move (pending));
+    }
+
+    notify();
+}
+
+//==============================================================================
+void ColDawBackgroundRequests::run()
+{
+    while (! threadShouldExit())
+    {
+        std::unique_ptr<Pending> pending;
+
+        {
+            const juce::ScopedLock sl (lock);
+
+            if (! queued.empty())
+            {
+                pending = std::move (queued.front());
+                queued.pop_front();
+            }
+        }
+
+        if (pending == nullptr)
+        {
+            wait (-1);
+            continue;
+        }
+
+        juce::MemoryInputStream body (pending->body.toRawUTF8(), pending->body.getNumBytesAsUTF8(), false);
+
+        auto& request = pending->request;
+        request.body = pending->body.isNotEmpty() ? &body : nullptr;
+        request.shouldAbort = [this] { return threadShouldExit(); };
+
+        pending->response = httpClient->perform (request);
+        request.body = nullptr;
+
+        {
+            const juce::ScopedLock sl (lock);
+            answered.push_back (std::move (pending));
+        }
+
+        triggerAsyncUpdate();
+    }
+}
+
+void ColDawBackgroundRequests::handleAsyncUpdate()
+{
+    std::deque<std::unique_ptr<Pending>> responses;
+
+    {
+        const juce::ScopedLock sl (lock);
+        responses.swap (answered);
+    }
+
+    for (auto& pending : responses)
+        if (pending->onResponse != nullptr)
+            pending->onResponse (pending->response);
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_events/juce_events.h>
+#include <deque>
+#include <functional>
+#include <memory>
+#include "HttpClient.h"
+
+//==============================================================================
+/**
+ * ColDaw Export Plugin - Background Requests
+ *
+ * Runs the processor's one-off API requests (login, update checks,
+ * confirmations) on a background thread, one at a time in the order they
+ * were made, and hands each response to its callback on the message thread.
+ * Responses still queued or on their way when this is destroyed are dropped
+ * without calling back.
+ */
+class ColDawBackgroundRequests : private juce::Thread,
+                                 private juce::AsyncUpdater
+{
+public:
+    //==============================================================================
+    using Callback = std::function<void (const ColDawHttpClient::Response&)>;
+
+    ColDawBackgroundRequests();
+    ~ColDawBackgroundRequests() override;
+
+    /** Queues a request. A non-empty body is sent as the request body, and
+        onResponse (if set) is called on the message thread.
+    */
+    void perform (ColDawHttpClient::Request request, const juce::String& body, Callback onResponse);
+
+private:
+    //==============================================================================
+    struct Pending
+    {
+        ColDawHttpClient::Request request;
+        juce::String body;
+        Callback onResponse;
+        ColDawHttpClient::Response response;
+    };
+
+    void run() override;
+    void handleAsyncUpdate() override;
+
+    juce::SharedResourcePointer<ColDawHttpClient> httpClient;
+
+    juce::CriticalSection lock;
+    std::deque<std::unique_ptr<Pending>> queued, answered;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ColDawBackgroundRequests)
+};
@@ -0,0 +1,499 @@
+#include "ChangePreview.h"
+#include <cmath>
+#include <map>
+#include <unordered_map>
+
+namespace
+{
+    constexpr int maxChangeLines = 12;
+
+    using Tag = ColDawAlsReader::Tag;
+
+    //==============================================================================
+    /** FNV-1a over the tokens of a subtree. */
+    struct Digest
+    {
+        juce::uint64 value = 14695981039346656037ull;
+
+        void add (std::string_view text) noexcept
+        {
+            for (auto c : text)
+                value = (value ^ (juce::uint8) c) * 1099511628211ull;
+
+            value = (value ^ 0xff) * 1099511628211ull;  // Separator, so "ab","c" != "a","bc"
+        }
+    };
+
+    bool isVolatile (Tag tag) noexcept
+    {
+        return tag == Tag::LomId || tag == Tag::LomIdView || tag == Tag::OverwriteProtectionNumber;
+    }
+
+    bool isTrack (Tag tag) noexcept
+    {
+        return tag == Tag::AudioTrack || tag == Tag::MidiTrack || tag == Tag::GroupTrack || tag == Tag::ReturnTrack;
+    }
+
+    //==============================================================================
+    /**
+     * Turns the element stream into a Summary. Depths count from the root
+     * element (Ableton = 0, LiveSet = 1, Tracks = 2, each track = 3).
+     */
+    class SummaryBuilder : public ColDawAlsReader::Handler
+    {
+    public:
+        explicit SummaryBuilder (ColDawChangePreview::Summary& s) : summary (s) {}
+
+        void startElement (Tag tag, std::string_view name, const ColDawAlsReader::Attributes& attributes) override
+        {
+            const auto depth = (int) stack.size();
+            const auto parent = depth > 0 ? stack.back() : Tag::unknown;
+
+            if (depth == 3 && parent == Tag::Tracks && stack[1] == Tag::LiveSet && isTrack (tag))
+            {
+                trackDepth = depth;
+                track = {};
+                track.type = ColDawAlsReader::toString (name);
+                track.id = ColDawAlsReader::toString (attributes.get ("Id"));
+                trackDigest = {};
+                clipKeys.clear();
+            }
+            else if (depth == 2 && parent == Tag::LiveSet && (tag == Tag::MasterTrack || tag == Tag::MainTrack))
+            {
+                mainTrackDepth = depth;
+            }
+            else if (mainTrackDepth >= 0)
+            {
+                readTempo (tag, attributes, depth);
+            }
+            else if (trackDepth >= 0)
+            {
+                readTrackElement (tag, name, attributes, depth, parent);
+            }
+
+            // A rename is reported as such, not as a settings change
+            if (depth == trackDepth + 1 && tag == Tag::Name)
+                trackNameDepth = depth;
+
+            // The element's own tag belongs to the innermost subtree being digested
+            auto* digest = deviceDepth >= 0 ? &deviceDigest : clipDepth >= 0 ? &clipDigest
+                                            : trackDepth >= 0 && trackNameDepth < 0 ? &trackDigest : nullptr;
+
+            if (digest != nullptr)
+            {
+                digest->add (name);
+
+                if (! isVolatile (tag))
+                {
+                    for (auto& attribute : attributes)
+                    {
+                        digest->add (attribute.first);
+                        digest->add (attribute.second);
+                    }
+                }
+            }
+
+            stack.push_back (tag);
+        }
+
+        void endElement (Tag, std::string_view) override
+        {
+            stack.pop_back();
+            const auto depth = (int) stack.size();
+
+            if (deviceDepth >= 0)
+                deviceDigest.add ("/");
+            else if (clipDepth >= 0)
+                clipDigest.add ("/");
+            else if (trackDepth >= 0 && trackNameDepth < 0)
+                trackDigest.add ("/");
+
+            if (depth == deviceDepth)
+            {
+                device.digest = deviceDigest.value;
+                track.devices.push_back (std::move (device));
+                deviceDepth = -1;
+            }
+            else if (depth == devicesDepth)
+            {
+                devicesDepth = -1;
+            }
+            else if (depth == clipDepth)
+            {
+                clip.digest = clipDigest.value;
+                track.clips.push_back (std::move (clip));
+                clipDepth = -1;
+            }
+            else if (depth == trackNameDepth)
+            {
+                trackNameDepth = -1;
+            }
+            else if (depth == slotDepth)
+            {
+                slotDepth = -1;
+                slotId = {};
+            }
+            else if (depth == trackDepth)
+            {
+                track.digest = trackDigest.value;
+                summary.tracks.push_back (std::move (track));
+                trackDepth = -1;
+            }
+            else if (depth == mainTrackDepth)
+            {
+                mainTrackDepth = -1;
+            }
+        }
+
+    private:
+        void readTempo (Tag tag, const ColDawAlsReader::Attributes& attributes, int depth)
+        {
+            // MainTrack/DeviceChain/Mixer/{Tempo,TimeSignature}/Manual
+            if (tag != Tag::Manual || stack[(size_t) depth - 2] != Tag::Mixer)
+                return;
+
+            const auto value = ColDawAlsReader::toString (attributes.get ("Value"));
+
+            if (stack.back() == Tag::Tempo)
+            {
+                summary.tempo = value.getDoubleValue();
+            }
+            else if (stack.back() == Tag::TimeSignature)
+            {
+                // Live stores (numerator - 1) + 99 * log2 (denominator)
+                summary.timeSignatureNumerator = value.getIntValue() % 99 + 1;
+                summary.timeSignatureDenominator = 1 << juce::jlimit (0, 6, value.getIntValue() / 99);
+            }
+        }
+
+        void readTrackElement (Tag tag, std::string_view name, const ColDawAlsReader::Attributes& attributes,
+                               int depth, Tag parent)
+        {
+            if (tag == Tag::EffectiveName && depth == trackDepth + 2 && parent == Tag::Name)
+            {
+                track.name = ColDawAlsReader::toString (attributes.get ("Value"));
+            }
+            else if (clipDepth >= 0)
+            {
+                if (depth == clipDepth + 1 && tag == Tag::Name && clip.name.isEmpty())
+                    clip.name = ColDawAlsReader::toString (attributes.get ("Value"));
+            }
+            else if (deviceDepth >= 0)
+            {
+                // VST2 plug-ins carry PlugName, VST3 and AU plug-ins a Name in their info
+                const bool isPluginName = tag == Tag::PlugName
+                                       || (tag == Tag::Name && (parent == Tag::Vst3PluginInfo || parent == Tag::AuPluginInfo));
+
+                if (isPluginName && ! pluginNamed)
+                {
+                    device.name = ColDawAlsReader::toString (attributes.get ("Value"));
+                    pluginNamed = true;
+                }
+            }
+            else if (tag == Tag::AudioClip || tag == Tag::MidiClip)
+            {
+                clipDepth = depth;
+                clip = {};
+                clip.key = slotDepth >= 0 ? "slot " + slotId
+                                          : "arrangement " + ColDawAlsReader::toString (attributes.get ("Time"));
+
+                // Take lanes can hold several clips at the same position
+                if (const auto repeat = clipKeys[clip.key]++; repeat > 0)
+                    clip.key << " #" << repeat;
+
+                clipDigest = {};
+            }
+            else if (tag == Tag::ClipSlot && parent == Tag::ClipSlotList)
+            {
+                slotDepth = depth;
+                slotId = ColDawAlsReader::toString (attributes.get ("Id"));
+            }
+            else if (tag == Tag::Devices && depth == trackDepth + 3 && parent == Tag::DeviceChain)
+            {
+                // Track/DeviceChain/DeviceChain/Devices; devices nested in racks are part of the rack
+                devicesDepth = depth;
+            }
+            else if (devicesDepth >= 0 && depth == devicesDepth + 1)
+            {
+                deviceDepth = depth;
+                device = {};
+                device.name = ColDawAlsReader::toString (name);
+                pluginNamed = false;
+                deviceDigest = {};
+            }
+        }
+
+        ColDawChangePreview::Summary& summary;
+        std::vector<Tag> stack;
+
+        int mainTrackDepth = -1, trackDepth = -1, trackNameDepth = -1, slotDepth = -1, clipDepth = -1, devicesDepth = -1, deviceDepth = -1;
+        ColDawChangePreview::Track track;
+        ColDawChangePreview::Clip clip;
+        ColDawChangePreview::Device device;
+        Digest trackDigest, clipDigest, deviceDigest;
+        juce::String slotId;
+        std::unordered_map<juce::String, int> clipKeys;
+        bool pluginNamed = false;
+    };
+
+    //==============================================================================
+    juce::String describeTrack (const ColDawChangePreview::Track& track)
+    {
+        auto type = track.type.upToLastOccurrenceOf ("Track", false, false);
+        type = type == "Midi" ? juce::String ("MIDI") : type.toLowerCase();
+
+        return type + " track \"" + track.name + "\"";
+    }
+
+    juce::String countOf (int count, const juce::String& noun, const juce::String& what)
+    {
+        return juce::String (count) + " " + noun + (count == 1 ? "" : "s") + " " + what;
+    }
+
+    /** What changed among the clips and devices of one track, as short phrases. */
+    juce::StringArray describeTrackContents (const ColDawChangePreview::Track& from, const ColDawChangePreview::Track& to)
+    {
+        juce::StringArray parts;
+
+        // Clips are matched by where they sit
+        std::map<juce::String, juce::uint64> oldClips;
+        for (auto& clip : from.clips)
+            oldClips[clip.key] = clip.digest;
+
+        int clipsAdded = 0, clipsChanged = 0;
+
+        for (auto& clip : to.clips)
+        {
+            auto old = oldClips.find (clip.key);
+
+            if (old == oldClips.end())
+            {
+                ++clipsAdded;
+                continue;
+            }
+
+            if (old->second != clip.digest)
+                ++clipsChanged;
+
+            oldClips.erase (old);
+        }
+
+        if (clipsChanged > 0)   parts.add (countOf (clipsChanged, "clip", "changed"));
+        if (clipsAdded > 0)     parts.add (countOf (clipsAdded, "clip", "added"));
+        if (! oldClips.empty()) parts.add (countOf ((int) oldClips.size(), "clip", "removed"));
+
+        // Devices are matched by name, in chain order
+        std::vector<bool> matched (from.devices.size(), false);
+        juce::StringArray added;
+        int devicesChanged = 0;
+
+        for (auto& device : to.devices)
+        {
+            bool found = false;
+
+            for (size_t i = 0; i < from.devices.size() && ! found; ++i)
+            {
+                if (! matched[i] && from.devices[i].name == device.name)
+                {
+                    matched[i] = found = true;
+
+                    if (from.devices[i].digest != device.digest)
+                        ++devicesChanged;
+                }
+            }
+
+            if (! found)
+                added.add (device.name);
+        }
+
+        juce::StringArray removed;
+        for (size_t i = 0; i < from.devices.size(); ++i)
+            if (! matched[i])
+                removed.add (from.devices[i].name);
+
+        if (! added.isEmpty())   parts.add ("added " + added.joinIntoString (", "));
+        if (! removed.isEmpty()) parts.add ("removed " + removed.joinIntoString (", "));
+        if (devicesChanged > 0)  parts.add (countOf (devicesChanged, "device", "changed"));
+
+        if (parts.isEmpty() && from.digest != to.digest)
+            parts.add ("mixer or track settings changed");
+
+        return parts;
+    }
+}
+
+//==============================================================================
+ColDawChangePreview::ColDawChangePreview (Listener& l)
+    : juce::Thread ("ColDaw Change Preview"),
+      listener (l)
+{
+    startThread (juce::Thread::Priority::background);
+}
+
+ColDawChangePreview::~ColDawChangePreview()
+{
+    stopThread (10000);
+    readerThread.removeAllJobs (true, 10000);
+    cancelPendingUpdate();
+}
+
+void ColDawChangePreview::preview (const juce::File& current, const juce::File& incoming, const juce::String& versionId)
+{
+    {
+        const juce::ScopedLock sl (lock);
+        pendingTask = { current, incoming, versionId };
+        hasPendingTask = true;
+    }
+
+    notify();
+}
+
+//==============================================================================
+bool ColDawChangePreview::readSummary (juce::InputStream& input, Summary& summary, const std::function<bool()>& shouldAbort)
+{
+    summary = {};
+    SummaryBuilder builder (summary);
+    return ColDawAlsReader::read (input, builder, shouldAbort);
+}
+
+std::unique_ptr<ColDawAlsReader::Handler> ColDawChangePreview::createSummaryReader (Summary& summary)
+{
+    return std::make_unique<SummaryBuilder> (summary);
+}
+
+juce::StringArray ColDawChangePreview::describeChanges (const Summary& from, const Summary& to)
+{
+    juce::StringArray changes;
+
+    if (std::abs (from.tempo - to.tempo) > 0.001)
+        changes.add ("Tempo: " + juce::String (from.tempo, 2) + " -> " + juce::String (to.tempo, 2) + " BPM");
+
+    if (from.timeSignatureNumerator != to.timeSignatureNumerator || from.timeSignatureDenominator != to.timeSignatureDenominator)
+        changes.add ("Time signature: " + juce::String (from.timeSignatureNumerator) + "/" + juce::String (from.timeSignatureDenominator)
+                     + " -> " + juce::String (to.timeSignatureNumerator) + "/" + juce::String (to.timeSignatureDenominator));
+
+    // Track IDs stay the same through renames and moves
+    std::map<juce::String, const Track*> oldTracks;
+    for (auto& track : from.tracks)
+        oldTracks[track.id] = &track;
+
+    juce::StringArray commonOrderBefore, commonOrderAfter;
+
+    for (auto& track : to.tracks)
+    {
+        auto old = oldTracks.find (track.id);
+
+        if (old == oldTracks.end())
+        {
+            changes.add ("Added " + describeTrack (track));
+            continue;
+        }
+
+        const auto& oldTrack = *old->second;
+        oldTracks.erase (old);
+        commonOrderAfter.add (track.id);
+
+        if (oldTrack.name != track.name)
+            changes.add ("Renamed \"" + oldTrack.name + "\" to \"" + track.name + "\"");
+
+        const auto parts = describeTrackContents (oldTrack, track);
+
+        if (! parts.isEmpty())
+            changes.add ("\"" + track.name + "\": " + parts.joinIntoString (", "));
+    }
+
+    for (auto& track : from.tracks)
+    {
+        if (oldTracks.count (track.id) > 0)
+            changes.add ("Removed " + describeTrack (track));
+        else
+            commonOrderBefore.add (track.id);
+    }
+
+    if (commonOrderBefore != commonOrderAfter)
+        changes.add ("Tracks reordered");
+
+    if (changes.size() > maxChangeLines)
+    {
+        const auto more = changes.size() - (maxChangeLines - 1);
+        changes.removeRange (maxChangeLines - 1, more);
+        changes.add ("...and " + juce::String (more) + " more");
+    }
+
+    return changes;
+}
+
+//==============================================================================
+void ColDawChangePreview::run()
+{
+    while (! threadShouldExit())
+    {
+        Task task;
+
+        {
+            const juce::ScopedLock sl (lock);
+
+            if (hasPendingTask)
+            {
+                task = std::move (pendingTask);
+                hasPendingTask = false;
+            }
+        }
+
+        if (task.versionId.isEmpty())
+        {
+            wait (-1);
+            continue;
+        }
+
+        const auto startTime = juce::Time::getMillisecondCounterHiRes();
+        const auto shouldAbort = [this] { return threadShouldExit(); };
+
+        // The two sets are read side by side
+        Summary current, incoming;
+        bool currentRead = false;
+        juce::WaitableEvent currentDone;
+
+        readerThread.addJob ([&]
+        {
+            juce::FileInputStream input (task.current);
+            currentRead = input.openedOk() && readSummary (input, current, shouldAbort);
+            currentDone.signal();
+        });
+
+        juce::FileInputStream input (task.incoming);
+        const bool incomingRead = input.openedOk() && readSummary (input, incoming, shouldAbort);
+        currentDone.wait();
+
+        Result result;
+        result.versionId = task.versionId;
+        result.succeeded = currentRead && incomingRead;
+        result.seconds = (juce::Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+
+        if (result.succeeded)
+            result.changes = describeChanges (current, incoming);
+
+        if (threadShouldExit())
+            break;
+
+        {
+            const juce::ScopedLock sl (lock);
+            finishedResults.push_back (std::move (result));
+        }
+
+        triggerAsyncUpdate();
+    }
+}
+
+void ColDawChangePreview::handleAsyncUpdate()
+{
+    std::vector<Result> results;
+
+    {
+        const juce::ScopedLock sl (lock);
+        results.swap (finishedResults);
+    }
+
+    for (auto& result : results)
+        listener.changePreviewReady (result);
+}
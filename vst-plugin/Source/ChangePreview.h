@@ -0,0 +1,113 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_events/juce_events.h>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "AlsReader.h"
+
+//==============================================================================
+/**
+ * ColDaw Export Plugin - structural preview of incoming updates
+ *
+ * Reads the local set and a downloaded update on a background thread, one
+ * on each core, and says what the update would change: tracks added,
+ * removed, renamed or reordered, clips and devices added, removed or edited,
+ * other track settings, tempo and time signature.
+ *
+ * The sets are streamed through ColDawAlsReader rather than parsed into a
+ * DOM, keeping only a summary: per track its name, a digest of every clip
+ * and device, and a digest of everything else on the track.
+ * Digests follow the canonical form in SemanticDelta.h (Values of volatile
+ * elements such as LomId are left out), so a set written back by the server
+ * doesn't count as changed.
+ */
+class ColDawChangePreview : private juce::Thread,
+                            private juce::AsyncUpdater
+{
+public:
+    //==============================================================================
+    struct Clip
+    {
+        juce::String key;   // Session slot or arrangement position
+        juce::String name;
+        juce::uint64 digest = 0;
+    };
+
+    struct Device
+    {
+        juce::String name;  // Plug-in name, or the device's element name for Live devices
+        juce::uint64 digest = 0;
+    };
+
+    struct Track
+    {
+        juce::String id, type, name;
+        juce::uint64 digest = 0;  // Everything on the track except its clips and devices
+        std::vector<Clip> clips;
+        std::vector<Device> devices;
+    };
+
+    struct Summary
+    {
+        double tempo = 0.0;
+        int timeSignatureNumerator = 0, timeSignatureDenominator = 0;
+        std::vector<Track> tracks;
+    };
+
+    /** Outcome of a preview, delivered on the message thread. */
+    struct Result
+    {
+        juce::String versionId;
+        bool succeeded = false;     // False if either set couldn't be read
+        juce::StringArray changes;  // One line per change; empty if nothing structural changed
+        double seconds = 0.0;
+    };
+
+    class Listener
+    {
+    public:
+        virtual ~Listener() = default;
+
+        /** Called on the message thread when a preview is ready. */
+        virtual void changePreviewReady (const Result& result) = 0;
+    };
+
+    //==============================================================================
+    explicit ColDawChangePreview (Listener& listener);
+    ~ColDawChangePreview() override;
+
+    /** Compares the two sets in the background. Replaces a preview that hasn't started yet. */
+    void preview (const juce::File& current, const juce::File& incoming, const juce::String& versionId);
+
+    /** Summarises a .als (gzipped or plain XML); false if it isn't a complete set or shouldAbort said so. */
+    static bool readSummary (juce::InputStream& input, Summary& summary, const std::function<bool()>& shouldAbort = nullptr);
+
+    /** The handler behind readSummary, for reading a set alongside other handlers. Fills summary as it goes. */
+    static std::unique_ptr<ColDawAlsReader::Handler> createSummaryReader (Summary& summary);
+
+    /** Human-readable lines describing how to differs from from. */
+    static juce::StringArray describeChanges (const Summary& from, const Summary& to);
+
+private:
+    //==============================================================================
+    struct Task
+    {
+        juce::File current, incoming;
+        juce::String versionId;
+    };
+
+    void run() override;
+    void handleAsyncUpdate() override;
+
+    Listener& listener;
+    juce::ThreadPool readerThread { 1 };
+
+    juce::CriticalSection lock;
+    Task pendingTask;
+    bool hasPendingTask = false;
+    std::vector<Result> finishedResults;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ColDawChangePreview)
+};
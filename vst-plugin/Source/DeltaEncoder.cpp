@@ -0,0 +1,265 @@
+#include "DeltaEncoder.h"
+#include "Sha256.h"
+#include <juce_cryptography/juce_cryptography.h>
+#include <unordered_map>
+
+namespace
+{
+    enum DeltaOp : juce::uint8
+    {
+        opEnd     = 0,
+        opCopy    = 1,  // u32 first block, u32 number of blocks
+        opLiteral = 2   // u32 length, then the bytes
+    };
+
+    constexpr juce::uint32 formatVersion = 1;
+    constexpr int applyBufferSize = 1 << 16;
+}
+
+//==============================================================================
+bool ColDawDeltaEncoder::Signature::parse (const juce::MemoryBlock& data)
+{
+    juce::MemoryInputStream in (data, false);
+
+    char magic[4] = {};
+    if (in.read (magic, 4) != 4 || memcmp (magic, "CDSG", 4) != 0)
+        return false;
+
+    if ((juce::uint32) in.readInt() != formatVersion)
+        return false;
+
+    blockSize = (juce::uint32) in.readInt();
+    fileSize = in.readInt64();
+    const auto numBlocks = (juce::int64) (juce::uint32) in.readInt();
+
+    if (blockSize == 0 || in.getNumBytesRemaining() != numBlocks * 20)
+        return false;
+
+    weak.resize ((size_t) numBlocks);
+    strong.resize ((size_t) numBlocks * 16);
+
+    for (size_t i = 0; i < (size_t) numBlocks; ++i)
+    {
+        weak[i] = (juce::uint32) in.readInt();
+        in.read (strong.data() + i * 16, 16);
+    }
+
+    return true;
+}
+
+//==============================================================================
+bool ColDawDeltaEncoder::encode (const Signature& base, const void* data, size_t size,
+                                 const juce::String& targetHash, juce::OutputStream& out, Stats& stats)
+{
+    auto* bytes = static_cast<const juce::uint8*> (data);
+    const size_t blockSize = base.blockSize;
+
+    juce::MemoryBlock rawHash;
+    rawHash.loadFromHexString (targetHash);
+    rawHash.ensureSize (32, true);
+
+    bool ok = out.write ("CDDL", 4)
+           && out.writeInt ((int) formatVersion)
+           && out.writeInt ((int) base.blockSize)
+           && out.writeInt64 ((juce::int64) size)
+           && out.write (rawHash.getData(), 32);
+
+    // Weak checksum -> candidate blocks
+    std::unordered_map<juce::uint32, std::vector<int>> blocksByWeak;
+    blocksByWeak.reserve ((size_t) base.getNumBlocks());
+
+    for (int i = 0; i < base.getNumBlocks(); ++i)
+        blocksByWeak[base.weak[(size_t) i]].push_back (i);
+
+    int pendingFirst = -1, pendingCount = 0;
+
+    auto flushCopy = [&]
+    {
+        if (pendingCount > 0)
+        {
+            ok = out.writeByte ((char) opCopy)
+              && out.writeInt (pendingFirst)
+              && out.writeInt (pendingCount)
+              && ok;
+            ++stats.numCopies;
+        }
+
+        pendingCount = 0;
+    };
+
+    auto writeLiteral = [&] (size_t start, size_t end)
+    {
+        if (end <= start)
+            return;
+
+        flushCopy();
+        ok = out.writeByte ((char) opLiteral)
+          && out.writeInt ((int) (end - start))
+          && out.write (bytes + start, end - start)
+          && ok;
+        stats.literalBytes += (juce::int64) (end - start);
+    };
+
+    // rsync weak checksum of the window at pos: a + (b << 16), both mod 2^16
+    size_t pos = 0, literalStart = 0;
+    juce::uint32 a = 0, b = 0;
+
+    auto startWindow = [&]
+    {
+        a = b = 0;
+
+        for (size_t i = 0; i < blockSize; ++i)
+        {
+            a += bytes[pos + i];
+            b += (juce::uint32) (blockSize - i) * bytes[pos + i];
+        }
+    };
+
+    if (blockSize > 0 && ! blocksByWeak.empty() && size >= blockSize)
+    {
+        startWindow();
+
+        while (pos + blockSize <= size)
+        {
+            int matchedBlock = -1;
+            auto candidates = blocksByWeak.find ((a & 0xffff) | ((b & 0xffff) << 16));
+
+            if (candidates != blocksByWeak.end())
+            {
+                const auto digest = juce::MD5 (bytes + pos, blockSize).getRawChecksumData();
+
+                for (auto block : candidates->second)
+                {
+                    if (memcmp (digest.getData(), base.strong.data() + (size_t) block * 16, 16) == 0)
+                    {
+                        matchedBlock = block;
+                        break;
+                    }
+                }
+            }
+
+            if (matchedBlock >= 0)
+            {
+                writeLiteral (literalStart, pos);
+
+                if (pendingCount > 0 && matchedBlock == pendingFirst + pendingCount)
+                {
+                    ++pendingCount;
+                }
+                else
+                {
+                    flushCopy();
+                    pendingFirst = matchedBlock;
+                    pendingCount = 1;
+                }
+
+                stats.copiedBytes += (juce::int64) blockSize;
+                pos += blockSize;
+                literalStart = pos;
+
+                if (pos + blockSize <= size)
+                    startWindow();
+            }
+            else
+            {
+                // Roll the window one byte forward
+                if (pos + blockSize < size)
+                {
+                    const juce::uint32 outgoing = bytes[pos];
+                    const juce::uint32 incoming = bytes[pos + blockSize];
+                    a = a - outgoing + incoming;
+                    b = b - (juce::uint32) blockSize * outgoing + a;
+                }
+
+                ++pos;
+            }
+        }
+    }
+
+    writeLiteral (literalStart, size);
+    flushCopy();
+    ok = out.writeByte ((char) opEnd) && ok;
+    out.flush();
+
+    return ok;
+}
+
+//==============================================================================
+bool ColDawDeltaEncoder::apply (juce::InputStream& base, juce::InputStream& delta, juce::OutputStream& result,
+                                const std::function<bool()>& shouldAbort)
+{
+    char magic[4] = {};
+    if (delta.read (magic, 4) != 4 || memcmp (magic, "CDDL", 4) != 0)
+        return false;
+
+    if ((juce::uint32) delta.readInt() != formatVersion)
+        return false;
+
+    const auto blockSize = (juce::int64) (juce::uint32) delta.readInt();
+    const auto targetSize = delta.readInt64();
+
+    juce::uint8 targetHash[32];
+    if (blockSize == 0 || targetSize < 0 || delta.read (targetHash, 32) != 32)
+        return false;
+
+    const auto numBaseBlocks = base.getTotalLength() / blockSize;
+
+    ColDawSha256 hash;
+    juce::HeapBlock<char> buffer (applyBufferSize);
+    juce::int64 written = 0;
+
+    // Moves numBytes from source to the result, hashing them on the way
+    auto copy = [&] (juce::InputStream& source, juce::int64 numBytes)
+    {
+        if (numBytes > targetSize - written)
+            return false;
+
+        while (numBytes > 0)
+        {
+            if (shouldAbort != nullptr && shouldAbort())
+                return false;
+
+            const auto size = (int) juce::jmin (numBytes, (juce::int64) applyBufferSize);
+
+            if (source.read (buffer, size) != size || ! result.write (buffer, (size_t) size))
+                return false;
+
+            hash.update (buffer, (size_t) size);
+            written += size;
+            numBytes -= size;
+        }
+
+        return true;
+    };
+
+    for (;;)
+    {
+        if (delta.isExhausted())
+            return false;
+
+        const auto op = (juce::uint8) delta.readByte();
+
+        if (op == opEnd)
+            break;
+
+        if (op == opCopy)
+        {
+            const auto first = (juce::int64) (juce::uint32) delta.readInt();
+            const auto count = (juce::int64) (juce::uint32) delta.readInt();
+
+            if (first + count > numBaseBlocks || ! base.setPosition (first * blockSize) || ! copy (base, count * blockSize))
+                return false;
+        }
+        else if (op == opLiteral)
+        {
+            if (! copy (delta, (juce::int64) (juce::uint32) delta.readInt()))
+                return false;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    return written == targetSize && hash.finish() == juce::String::toHexString (targetHash, 32, 0);
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <functional>
+#include <vector>
+
+//==============================================================================
+/**
+ * ColDaw Export Plugin - rsync-style delta encoder
+ *
+ * The server describes a version it already has as a block signature: a weak
+ * rolling checksum and an MD5 for every full block of the file. The encoder
+ * slides a window over the new file, emits a block reference wherever the
+ * window matches one of those blocks, and sends everything else as literal
+ * ranges. Runs of consecutive blocks collapse into a single reference.
+ *
+ * The same deltas come the other way as update patches: the server encodes
+ * a new version against one the plugin already has, and apply() rebuilds it.
+ *
+ * Signature ("CDSG") and delta ("CDDL") formats are little-endian and are
+ * mirrored in server/src/utils/delta.ts.
+ */
+class ColDawDeltaEncoder
+{
+public:
+    //==============================================================================
+    struct Signature
+    {
+        juce::uint32 blockSize = 0;
+        juce::int64 fileSize = 0;
+        std::vector<juce::uint32> weak;
+        std::vector<juce::uint8> strong;  // 16 MD5 bytes per block
+
+        int getNumBlocks() const noexcept { return (int) weak.size(); }
+
+        /** Reads a signature as served by /api/projects/:id/signature/:versionId. */
+        bool parse (const juce::MemoryBlock& data);
+    };
+
+    struct Stats
+    {
+        juce::int64 literalBytes = 0;
+        juce::int64 copiedBytes = 0;
+        int numCopies = 0;
+    };
+
+    //==============================================================================
+    /**
+     * Writes a delta that turns the signed base into the given data.
+     * targetHash is the hex SHA-256 of the data, so the server can check its
+     * reconstruction. Returns false if the output stream failed.
+     */
+    static bool encode (const Signature& base, const void* data, size_t size,
+                        const juce::String& targetHash, juce::OutputStream& out, Stats& stats);
+
+    /**
+     * Rebuilds the data a delta describes from its base, writing it to result
+     * as it goes; the base must be able to seek, the delta is read in order.
+     * Returns false if the delta is malformed, refers past the end of the
+     * base, the result doesn't match the SHA-256 the delta carries or
+     * shouldAbort said so - in which case whatever was written is garbage.
+     */
+    static bool apply (juce::InputStream& base, juce::InputStream& delta, juce::OutputStream& result,
+                       const std::function<bool()>& shouldAbort = nullptr);
+
+private:
+    ColDawDeltaEncoder() = delete;
+};
@@ -0,0 +1,561 @@
+#include "Downloader.h"
+#include "Sha256.h"
+#include "DeltaEncoder.h"
+#include <algorithm>
+#include <utility>
+
+namespace
+{
+    constexpr int connectionTimeoutMs = 30000;
+    constexpr juce::uint32 progressIntervalMs = 200;
+
+    constexpr int copyBufferSize = 1 << 16;
+
+    /** Start and total size from a "bytes start-end/total" Content-Range; -1 where absent. */
+    void parseContentRange (const juce::String& value, juce::int64& start, juce::int64& total)
+    {
+        start = total = -1;
+
+        if (! value.trimStart().startsWithIgnoreCase ("bytes "))
+            return;
+
+        const auto range = value.fromFirstOccurrenceOf ("bytes ", false, true).trim();
+
+        if (range.containsChar ('-'))
+            start = range.upToFirstOccurrenceOf ("-", false, false).getLargeIntValue();
+
+        const auto totalText = range.fromFirstOccurrenceOf ("/", false, false);
+
+        if (totalText.isNotEmpty() && totalText != "*")
+            total = totalText.getLargeIntValue();
+    }
+}
+
+//==============================================================================
+/**
+ * Where the response body goes: appended to the part file and hashed on the
+ * way, or, for error responses, thrown away.
+ */
+class ColDawDownloader::Transfer : public juce::OutputStream
+{
+public:
+    enum class Mode { append, restart, discard };
+
+    Transfer (ColDawDownloader& d, int id, const juce::File& file)
+        : owner (d), downloadId (id), part (file)
+    {
+    }
+
+    /** Brings the hash up to date with the part file and returns its size. */
+    juce::int64 prepare (const std::function<bool()>& shouldAbort)
+    {
+        const auto partSize = part.existsAsFile() ? part.getSize() : 0;
+
+        if (hash != nullptr && hashedBytes == partSize)
+            return hashedBytes;
+
+        hash = std::make_unique<ColDawSha256>();
+        hashedBytes = 0;
+
+        if (partSize > 0)
+        {
+            juce::FileInputStream input (part);
+
+            if (input.openedOk() && hash->update (input, shouldAbort))
+            {
+                hashedBytes = partSize;
+            }
+            else
+            {
+                hash = std::make_unique<ColDawSha256>();
+
+                if (! shouldAbort())
+                    part.deleteFile();
+            }
+        }
+
+        return hashedBytes;
+    }
+
+    /** Called once the response headers are in; false if the part file can't be written. */
+    bool begin (Mode newMode)
+    {
+        mode = newMode;
+
+        if (mode == Mode::discard)
+            return true;
+
+        if (mode == Mode::restart)
+        {
+            hash = std::make_unique<ColDawSha256>();
+            hashedBytes = 0;
+        }
+
+        fileStream = std::make_unique<juce::FileOutputStream> (part);
+
+        if (! fileStream->openedOk())
+            return false;
+
+        if (mode == Mode::restart)
+        {
+            fileStream->setPosition (0);
+            fileStream->truncate();
+        }
+
+        return true;
+    }
+
+    /** Flushes and closes the part file after a request. */
+    void end()
+    {
+        fileStream.reset();
+        mode = Mode::discard;
+    }
+
+    juce::String finishHash()
+    {
+        auto result = hash->finish();
+        hash.reset();
+        return result;
+    }
+
+    juce::int64 total = -1;
+
+    //==============================================================================
+    bool write (const void* data, size_t numBytes) override
+    {
+        if (mode == Mode::discard)
+            return true;
+
+        if (! fileStream->write (data, numBytes))
+            return false;
+
+        hash->update (data, numBytes);
+        hashedBytes += (juce::int64) numBytes;
+
+        const auto now = juce::Time::getMillisecondCounter();
+
+        if (now - lastReport >= progressIntervalMs)
+        {
+            lastReport = now;
+            owner.reportProgress ({ downloadId, hashedBytes, total });
+        }
+
+        return true;
+    }
+
+    void flush() override                            { if (fileStream != nullptr) fileStream->flush(); }
+    bool setPosition (juce::int64) override          { return false; }
+    juce::int64 getPosition() override               { return hashedBytes; }
+
+private:
+    ColDawDownloader& owner;
+    const int downloadId;
+    const juce::File part;
+
+    Mode mode = Mode::discard;
+    std::unique_ptr<juce::FileOutputStream> fileStream;
+    std::unique_ptr<ColDawSha256> hash;
+    juce::int64 hashedBytes = 0;
+    juce::uint32 lastReport = 0;
+};
+
+//==============================================================================
+ColDawDownloader::ColDawDownloader (Listener& l, const juce::File& directoryForParts)
+    : juce::Thread ("ColDaw Downloader"),
+      listener (l),
+      partDirectory (directoryForParts)
+{
+    startThread (juce::Thread::Priority::background);
+}
+
+ColDawDownloader::~ColDawDownloader()
+{
+    stopThread (10000);
+    cancelPendingUpdate();
+}
+
+int ColDawDownloader::start (Request request)
+{
+    const auto id = nextDownloadId++;
+
+    {
+        const juce::ScopedLock sl (lock);
+        pendingTasks.push_back ({ id, std::move (request) });
+    }
+
+    notify();
+    return id;
+}
+
+void ColDawDownloader::discardPartial (const juce::File& target) const
+{
+    getPartFile (target).deleteFile();
+    getRecordFile (target).deleteFile();
+}
+
+juce::File ColDawDownloader::getPartFile (const juce::File& target) const
+{
+    // Named after the whole path, so targets with the same name in different folders don't collide
+    return partDirectory.getChildFile (target.getFileName() + "-"
+                                       + juce::String::toHexString (target.getFullPathName().hashCode64()) + ".part");
+}
+
+juce::File ColDawDownloader::getRecordFile (const juce::File& target) const
+{
+    return getPartFile (target).withFileExtension (".part.json");
+}
+
+//==============================================================================
+void ColDawDownloader::run()
+{
+    while (! threadShouldExit())
+    {
+        Task task;
+
+        {
+            const juce::ScopedLock sl (lock);
+
+            if (! pendingTasks.empty())
+            {
+                task = std::move (pendingTasks.front());
+                pendingTasks.pop_front();
+            }
+        }
+
+        if (task.id == 0)
+        {
+            wait (-1);
+            continue;
+        }
+
+        auto result = download (task);
+
+        // Best effort: the download itself succeeded either way
+        if (result.succeeded() && task.request.cacheCopy != juce::File())
+        {
+            task.request.cacheCopy.getParentDirectory().createDirectory();
+            task.request.target.copyFileTo (task.request.cacheCopy);
+        }
+
+        {
+            const juce::ScopedLock sl (lock);
+            finishedResults.push_back (std::move (result));
+        }
+
+        triggerAsyncUpdate();
+    }
+}
+
+ColDawDownloader::Result ColDawDownloader::download (const Task& task)
+{
+    const auto& target = task.request.target;
+    const auto part = getPartFile (target);
+    const auto recordFile = getRecordFile (target);
+    const auto url = task.request.url.toString (true);
+
+    partDirectory.createDirectory();
+
+    Result result;
+    result.downloadId = task.id;
+    result.target = target;
+
+    if (! task.request.patchUrl.isEmpty() && task.request.patchBase.existsAsFile()
+         && downloadPatch (task, result))
+        return result;
+
+    // What an earlier attempt left behind - but only if it was for the same URL
+    auto record = recordFile.existsAsFile() ? juce::JSON::parse (recordFile) : juce::var();
+
+    if (record.getProperty ("url", "").toString() != url)
+    {
+        discardPartial (target);
+        record = {};
+    }
+
+    auto etag = record.getProperty ("etag", "").toString();
+    auto expectedHash = record.getProperty ("sha256", "").toString();
+
+    Transfer transfer (*this, task.id, part);
+    transfer.total = (juce::int64) record.getProperty ("size", -1);
+
+    const auto shouldAbort = [this] { return threadShouldExit(); };
+    result.resumed = part.existsAsFile() && part.getSize() > 0;
+
+    // A part that is already complete only needs checking
+    const bool alreadyComplete = transfer.total >= 0 && expectedHash.isNotEmpty()
+                                  && transfer.prepare (shouldAbort) == transfer.total;
+
+    if (alreadyComplete)
+    {
+        result.connected = true;
+        result.statusCode = 200;
+    }
+    else
+    {
+        bool mustRestart = false;
+
+        const auto response = ColDawHttpClient::performWithRetry (*this, [&]
+        {
+            const auto offset = transfer.prepare (shouldAbort);
+
+            ColDawHttpClient::Request request;
+            request.url = task.request.url;
+            request.headers = "Authorization: Bearer " + task.request.authToken;
+            request.response = &transfer;
+            request.connectionTimeoutMs = connectionTimeoutMs;
+            request.shouldAbort = shouldAbort;
+
+            // Only the missing bytes, and only if the file is still the one we started
+            if (offset > 0)
+            {
+                request.headers << "\r\nRange: bytes=" << offset << "-";
+
+                if (etag.isNotEmpty())
+                    request.headers << "\r\nIf-Range: " << etag;
+            }
+
+            request.responseStarted = [&] (const ColDawHttpClient::Response& r)
+            {
+                juce::int64 rangeStart, rangeTotal;
+                parseContentRange (r.headers["Content-Range"], rangeStart, rangeTotal);
+                const auto announcedHash = r.headers["X-ColDaw-SHA256"].toLowerCase();
+
+                if (r.statusCode == 206 && rangeStart == offset && announcedHash == expectedHash)
+                {
+                    transfer.total = rangeTotal;
+                    return transfer.begin (Transfer::Mode::append);
+                }
+
+                if (r.statusCode == 200)
+                {
+                    etag = r.headers["ETag"];
+                    expectedHash = announcedHash;
+                    transfer.total = r.headers.containsKey ("Content-Length") ? r.headers["Content-Length"].getLargeIntValue() : -1;
+
+                    auto* newRecord = new juce::DynamicObject();
+                    newRecord->setProperty ("url", url);
+                    newRecord->setProperty ("etag", etag);
+                    newRecord->setProperty ("sha256", expectedHash);
+                    newRecord->setProperty ("size", transfer.total);
+                    recordFile.replaceWithText (juce::JSON::toString (juce::var (newRecord)));
+
+                    return transfer.begin (Transfer::Mode::restart);
+                }
+
+                // A range we can't use; the next attempt starts from scratch
+                if (r.statusCode == 206 || r.statusCode == 416)
+                    mustRestart = true;
+
+                return transfer.begin (Transfer::Mode::discard);
+            };
+
+            auto httpResponse = httpClient->perform (request);
+            transfer.end();
+
+            if (mustRestart)
+                part.deleteFile();
+
+            return httpResponse;
+        },
+        [&] (const ColDawHttpClient::Response& r)
+        {
+            return std::exchange (mustRestart, false) || ColDawHttpClient::isTransientFailure (r);
+        });
+
+        result.connected = response.connected;
+        result.statusCode = response.statusCode;
+
+        // The part file stays, so the next attempt picks up from here
+        if (threadShouldExit())
+        {
+            result.errorMessage = "Download cancelled";
+            return result;
+        }
+
+        if (! response.isSuccess())
+        {
+            result.errorMessage = response.connected ? "Download failed (Status: " + juce::String (response.statusCode) + ")"
+                                                     : juce::String ("Could not connect to server");
+            return result;
+        }
+    }
+
+    // An empty body never opens the part file
+    if (! part.existsAsFile())
+        part.create();
+
+    result.size = part.getSize();
+
+    if (transfer.total >= 0 && result.size != transfer.total)
+    {
+        result.errorMessage = "Download incomplete";
+        return result;
+    }
+
+    result.sha256 = transfer.finishHash();
+
+    if (expectedHash.isNotEmpty())
+    {
+        if (result.sha256 != expectedHash)
+        {
+            discardPartial (target);
+            result.errorMessage = "Downloaded file is damaged (checksum mismatch)";
+            return result;
+        }
+
+        result.verified = true;
+    }
+
+    if (! (target.deleteFile() && part.moveFileTo (target)))
+    {
+        result.errorMessage = "Could not save the downloaded file";
+        return result;
+    }
+
+    recordFile.deleteFile();
+    return result;
+}
+
+bool ColDawDownloader::downloadPatch (const Task& task, Result& result)
+{
+    const auto& target = task.request.target;
+    const auto shouldAbort = [this] { return threadShouldExit(); };
+
+    // The patch is against the base's XML, not its gzipped bytes. It is
+    // inflated to a file, hashed on the way, so that applying can seek in it.
+    juce::TemporaryFile baseXml (".xml");
+    ColDawSha256 baseHash;
+
+    {
+        juce::FileInputStream input (task.request.patchBase);
+        juce::FileOutputStream output (baseXml.getFile());
+
+        if (! input.openedOk() || ! output.openedOk())
+            return false;
+
+        juce::GZIPDecompressorInputStream inflated (&input, false, juce::GZIPDecompressorInputStream::gzipFormat);
+        juce::HeapBlock<char> buffer (copyBufferSize);
+
+        for (;;)
+        {
+            if (threadShouldExit())
+                return false;
+
+            const auto numRead = inflated.read (buffer, copyBufferSize);
+
+            if (numRead < 0)
+                return false;
+
+            if (numRead == 0)
+                break;
+
+            if (! output.write (buffer, (size_t) numRead))
+                return false;
+
+            baseHash.update (buffer, (size_t) numRead);
+        }
+
+        if (output.getPosition() == 0)
+            return false;
+    }
+
+    juce::TemporaryFile patch (".patch");
+
+    {
+        juce::FileOutputStream patchOutput (patch.getFile());
+
+        if (! patchOutput.openedOk())
+            return false;
+
+        ColDawHttpClient::Request request;
+        request.url = task.request.patchUrl.withParameter ("baseSha256", baseHash.finish());
+        request.headers = "Authorization: Bearer " + task.request.authToken;
+        request.response = &patchOutput;
+        request.connectionTimeoutMs = connectionTimeoutMs;
+        request.shouldAbort = shouldAbort;
+
+        // Anything but a patch (409 for a base the server doesn't have) means a full download
+        if (! httpClient->perform (request).isSuccess() || threadShouldExit())
+            return false;
+    }
+
+    // Inflating the patch, applying it and gzipping the result all stream, so
+    // neither version of the set is ever held in memory
+    juce::TemporaryFile temp (target);
+
+    {
+        juce::FileInputStream base (baseXml.getFile()), patchInput (patch.getFile());
+        juce::FileOutputStream output (temp.getFile());
+
+        if (! base.openedOk() || ! patchInput.openedOk() || ! output.openedOk())
+            return false;
+
+        juce::GZIPDecompressorInputStream delta (&patchInput, false, juce::GZIPDecompressorInputStream::gzipFormat);
+        juce::GZIPCompressorOutputStream gzip (output, 6, juce::GZIPCompressorOutputStream::windowBitsGZIP);
+
+        if (! ColDawDeltaEncoder::apply (base, delta, gzip, shouldAbort))
+            return false;
+    }
+
+    // Hashed as saved for the caller; the patch only vouched for the XML
+    ColDawSha256 fileHash;
+
+    {
+        juce::FileInputStream written (temp.getFile());
+
+        if (! written.openedOk() || ! fileHash.update (written, shouldAbort))
+            return false;
+    }
+
+    if (! temp.overwriteTargetFileWithTemporary())
+        return false;
+
+    result.sha256 = fileHash.finish();
+
+    // A partial full download of the same file is no use any more
+    discardPartial (target);
+
+    result.connected = true;
+    result.statusCode = 200;
+    result.verified = true;
+    result.patched = true;
+    result.size = target.getSize();
+    return true;
+}
+
+//==============================================================================
+void ColDawDownloader::reportProgress (const Progress& progress)
+{
+    {
+        const juce::ScopedLock sl (lock);
+
+        auto existing = std::find_if (progressUpdates.begin(), progressUpdates.end(),
+                                      [&] (const Progress& p) { return p.downloadId == progress.downloadId; });
+
+        if (existing != progressUpdates.end())
+            *existing = progress;
+        else
+            progressUpdates.push_back (progress);
+    }
+
+    triggerAsyncUpdate();
+}
+
+void ColDawDownloader::handleAsyncUpdate()
+{
+    std::vector<Progress> progress;
+    std::vector<Result> results;
+
+    {
+        const juce::ScopedLock sl (lock);
+        progress.swap (progressUpdates);
+        results.swap (finishedResults);
+    }
+
+    for (auto& update : progress)
+        listener.downloadProgress (update);
+
+    for (auto& result : results)
+        listener.downloadFinished (result);
+}
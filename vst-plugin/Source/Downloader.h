@@ -0,0 +1,131 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_events/juce_events.h>
+#include <deque>
+#include "HttpClient.h"
+
+//==============================================================================
+/**
+ * ColDaw Export Plugin - resumable, verified downloads
+ *
+ * Downloads files on a background thread into a ".part" file in the
+ * plugin's own directory for them, next to a small ".part.json" that records
+ * the URL, the server's ETag, the size and the SHA-256 the server announced
+ * (X-ColDaw-SHA256). Nothing but the finished file appears next to the
+ * target. A dropped
+ * connection is retried with an HTTP Range request for the bytes still
+ * missing, guarded by If-Range so a file that changed on the server starts
+ * over instead of being spliced. The partial file and its record stay on
+ * disk, so asking for the same download after a host restart continues
+ * where it stopped.
+ *
+ * A request can also name a local copy of an earlier version (patchBase) and
+ * where to get a patch from it (patchUrl). The patch is a delta between the
+ * two versions' inflated XML (see DeltaEncoder.h), asked for with the
+ * SHA-256 of the base's XML so the server can refuse a base it doesn't
+ * have; the rebuilt XML is checked against the hash in the patch and
+ * gzipped into the target. The base, the patch and the result all stream
+ * through temporary files, never whole in memory. If anything about that fails, the full file is
+ * downloaded instead.
+ *
+ * The data is hashed as it arrives (a resumed download first hashes the
+ * part it already has), so verifying the finished file doesn't need a
+ * second pass over it. Only a verified file is moved to the target.
+ *
+ * Progress and results are reported to the Listener on the message thread.
+ */
+class ColDawDownloader : private juce::Thread,
+                         private juce::AsyncUpdater
+{
+public:
+    //==============================================================================
+    struct Request
+    {
+        juce::URL url;
+        juce::String authToken;
+        juce::File target;
+
+        juce::URL patchUrl;     // Optional: patch against patchBase
+        juce::File patchBase;   // Optional: local copy of an earlier version
+        juce::File cacheCopy;   // Optional: where to keep a copy of the finished file
+    };
+
+    struct Progress
+    {
+        int downloadId = 0;
+        juce::int64 received = 0;
+        juce::int64 total = -1;  // -1 until the server says
+    };
+
+    /** Outcome of a download, delivered on the message thread. */
+    struct Result
+    {
+        int downloadId = 0;
+        juce::File target;
+        bool connected = false;     // False if no response was ever received
+        int statusCode = 0;
+        bool verified = false;      // True if the file matched the server's SHA-256
+        bool resumed = false;       // True if part of the file came from an earlier attempt
+        bool patched = false;       // True if the file was rebuilt from a patch
+        juce::int64 size = 0;
+        juce::String sha256;        // Of the file as saved at target
+        juce::String errorMessage;  // Empty on success
+
+        bool succeeded() const noexcept { return errorMessage.isEmpty(); }
+    };
+
+    class Listener
+    {
+    public:
+        virtual ~Listener() = default;
+
+        /** Called on the message thread, at most a few times a second per download. */
+        virtual void downloadProgress (const Progress& progress) = 0;
+
+        /** Called on the message thread once a download has finished or failed. */
+        virtual void downloadFinished (const Result& result) = 0;
+    };
+
+    //==============================================================================
+    /** Partial downloads are kept in partDirectory, which is created as needed. */
+    ColDawDownloader (Listener& listener, const juce::File& partDirectory);
+    ~ColDawDownloader() override;
+
+    /** Queues a download and returns its ID. Never blocks. */
+    int start (Request request);
+
+    /** Drops any partial download for this target. */
+    void discardPartial (const juce::File& target) const;
+
+private:
+    //==============================================================================
+    struct Task
+    {
+        int id = 0;
+        Request request;
+    };
+
+    class Transfer;
+
+    void run() override;
+    Result download (const Task&);
+    bool downloadPatch (const Task&, Result&);
+    juce::File getPartFile (const juce::File& target) const;
+    juce::File getRecordFile (const juce::File& target) const;
+    void reportProgress (const Progress&);
+    void handleAsyncUpdate() override;
+
+    Listener& listener;
+    const juce::File partDirectory;
+    juce::SharedResourcePointer<ColDawHttpClient> httpClient;
+
+    juce::CriticalSection lock;
+    std::deque<Task> pendingTasks;
+    std::vector<Progress> progressUpdates;
+    std::vector<Result> finishedResults;
+
+    std::atomic<int> nextDownloadId { 1 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ColDawDownloader)
+};
@@ -0,0 +1,225 @@
+#include "HashCache.h"
+#include "Sha256.h"
+#include <algorithm>
+#include <vector>
+
+#if JUCE_WINDOWS
+ #include <windows.h>
+#else
+ #include <sys/stat.h>
+#endif
+
+namespace
+{
+    constexpr int formatVersion = 1;
+    constexpr int maxHashThreads = 8;
+}
+
+//==============================================================================
+ColDawHashCache::ColDawHashCache (const juce::File& file)
+    : cacheFile (file),
+      hashThreads (juce::jlimit (1, maxHashThreads, juce::SystemStats::getNumCpus()))
+{
+}
+
+ColDawHashCache::~ColDawHashCache()
+{
+    hashThreads.removeAllJobs (true, 10000);
+    save();
+}
+
+//==============================================================================
+ColDawHashCache::Identity ColDawHashCache::getIdentity (const juce::File& file)
+{
+    Identity identity;
+
+   #if JUCE_WINDOWS
+    auto handle = CreateFileW (file.getFullPathName().toWideCharPointer(), 0,
+                               FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                               nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, nullptr);
+
+    if (handle == INVALID_HANDLE_VALUE)
+        return identity;
+
+    BY_HANDLE_FILE_INFORMATION info;
+
+    if (GetFileInformationByHandle (handle, &info))
+    {
+        identity.size = ((juce::int64) info.nFileSizeHigh << 32) | info.nFileSizeLow;
+        identity.modified = ((juce::int64) info.ftLastWriteTime.dwHighDateTime << 32) | info.ftLastWriteTime.dwLowDateTime;
+        identity.fileId = ((juce::uint64) info.nFileIndexHigh << 32) | info.nFileIndexLow;
+    }
+
+    CloseHandle (handle);
+   #else
+    struct stat info;
+
+    if (stat (file.getFullPathName().toRawUTF8(), &info) != 0 || ! S_ISREG (info.st_mode))
+        return identity;
+
+    identity.size = (juce::int64) info.st_size;
+    identity.fileId = (juce::uint64) info.st_ino;
+
+    #if JUCE_MAC || JUCE_IOS
+     identity.modified = (juce::int64) info.st_mtimespec.tv_sec * 1000000000 + info.st_mtimespec.tv_nsec;
+    #else
+     identity.modified = (juce::int64) info.st_mtim.tv_sec * 1000000000 + info.st_mtim.tv_nsec;
+    #endif
+   #endif
+
+    return identity;
+}
+
+juce::String ColDawHashCache::hashFile (const juce::File& file, const std::function<bool()>& shouldAbort)
+{
+    juce::FileInputStream input (file);
+
+    if (! input.openedOk())
+        return {};
+
+    ColDawSha256 hash;
+    return hash.update (input, shouldAbort) ? hash.finish() : juce::String();
+}
+
+//==============================================================================
+juce::String ColDawHashCache::findEntry (const juce::String& path, const Identity& identity) const
+{
+    if (identity.size < 0)
+        return {};
+
+    auto entry = entries.find (path);
+    return entry != entries.end() && entry->second.identity == identity ? entry->second.sha256 : juce::String();
+}
+
+juce::StringArray ColDawHashCache::hashFiles (const juce::Array<juce::File>& files, const juce::Thread& thread)
+{
+    juce::StringArray hashes;
+    std::vector<Identity> identities;
+    std::vector<int> cold;
+
+    {
+        const juce::ScopedLock sl (lock);
+
+        // Read on first use, on a background thread rather than at startup
+        if (! loaded)
+            load();
+
+        for (int i = 0; i < files.size(); ++i)
+        {
+            identities.push_back (getIdentity (files.getReference (i)));
+            hashes.add (findEntry (files.getReference (i).getFullPathName(), identities.back()));
+
+            if (hashes[i].isEmpty() && identities.back().size >= 0)
+                cold.push_back (i);
+        }
+    }
+
+    if (cold.empty())
+        return hashes;
+
+    // Largest first, so one big file doesn't start last and hold up the batch
+    std::sort (cold.begin(), cold.end(), [&] (int a, int b) { return identities[(size_t) a].size > identities[(size_t) b].size; });
+
+    std::vector<juce::String> results (cold.size());
+    std::atomic<size_t> next { 0 };
+    std::atomic<int> workersLeft { juce::jmin (hashThreads.getNumThreads(), (int) cold.size()) };
+    juce::WaitableEvent allDone;
+
+    for (int worker = workersLeft; --worker >= 0;)
+    {
+        hashThreads.addJob ([&]
+        {
+            for (auto i = next++; i < cold.size() && ! thread.threadShouldExit(); i = next++)
+                results[i] = hashFile (files[cold[i]], [&thread] { return thread.threadShouldExit(); });
+
+            if (--workersLeft == 0)
+                allDone.signal();
+        });
+    }
+
+    allDone.wait();
+
+    const juce::ScopedLock sl (lock);
+
+    for (size_t i = 0; i < cold.size(); ++i)
+    {
+        if (results[i].isEmpty())
+            continue;
+
+        // A file that changed while it was read would be cached under the wrong hash
+        const auto index = cold[i];
+        const auto identity = getIdentity (files[index]);
+
+        if (! (identity == identities[(size_t) index]))
+            continue;
+
+        hashes.set (index, results[i]);
+        entries[files[index].getFullPathName()] = { identity, results[i] };
+        dirty = true;
+    }
+
+    save();
+    return hashes;
+}
+
+//==============================================================================
+void ColDawHashCache::load()
+{
+    loaded = true;
+
+    if (! cacheFile.existsAsFile())
+        return;
+
+    auto json = juce::JSON::parse (cacheFile);
+
+    if ((int) json.getProperty ("version", 0) != formatVersion)
+        return;
+
+    if (auto* files = json.getProperty ("files", {}).getDynamicObject())
+    {
+        for (auto& file : files->getProperties())
+        {
+            Entry entry;
+            entry.identity.size = (juce::int64) file.value.getProperty ("size", -1);
+            entry.identity.modified = (juce::int64) file.value.getProperty ("modified", 0);
+            entry.identity.fileId = (juce::uint64) file.value.getProperty ("fileId", "0").toString().getLargeIntValue();
+            entry.sha256 = file.value.getProperty ("sha256", "").toString();
+
+            // Files that are gone are dropped on load rather than kept forever
+            if (entry.sha256.isNotEmpty() && juce::File (file.name.toString()).existsAsFile())
+                entries[file.name.toString()] = std::move (entry);
+        }
+    }
+}
+
+void ColDawHashCache::save()
+{
+    const juce::ScopedLock sl (lock);
+
+    if (! dirty)
+        return;
+
+    auto* files = new juce::DynamicObject();
+    juce::var filesVar (files);
+
+    for (auto& entry : entries)
+    {
+        auto* file = new juce::DynamicObject();
+        file->setProperty ("size", entry.second.identity.size);
+        file->setProperty ("modified", entry.second.identity.modified);
+        file->setProperty ("fileId", juce::String (entry.second.identity.fileId));
+        file->setProperty ("sha256", entry.second.sha256);
+        files->setProperty (entry.first, juce::var (file));
+    }
+
+    auto* cache = new juce::DynamicObject();
+    juce::var cacheVar (cache);
+
+    cache->setProperty ("version", formatVersion);
+    cache->setProperty ("files", filesVar);
+
+    cacheFile.getParentDirectory().createDirectory();
+
+    if (cacheFile.replaceWithText (juce::JSON::toString (cacheVar, true)))
+        dirty = false;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <functional>
+#include <unordered_map>
+
+//==============================================================================
+/**
+ * ColDaw Export Plugin - persistent file hash cache
+ *
+ * Remembers the SHA-256 of files the plugin has hashed, keyed by path and
+ * checked against the file's size, modification time and file ID (inode on
+ * macOS and Linux, file index on Windows), and keeps that on disk between
+ * sessions. An unchanged file is answered from memory with one stat, so
+ * exporting a set again doesn't re-read gigabytes of samples.
+ *
+ * Files that do need hashing are spread over a pool of threads, largest
+ * first, so a batch of cold files keeps the disk busy rather than one core.
+ */
+class ColDawHashCache
+{
+public:
+    //==============================================================================
+    explicit ColDawHashCache (const juce::File& cacheFile);
+    ~ColDawHashCache();
+
+    /** SHA-256 (hex) of each file, in order. Files that can't be read get an
+        empty string, as do the rest if the thread is asked to stop.
+    */
+    juce::StringArray hashFiles (const juce::Array<juce::File>& files, const juce::Thread& thread);
+
+    /** Hashes one file, reading it in blocks. Empty if it can't be read or shouldAbort returns true. */
+    static juce::String hashFile (const juce::File& file, const std::function<bool()>& shouldAbort);
+
+private:
+    //==============================================================================
+    /** What has to stay the same for a cached hash to still hold. */
+    struct Identity
+    {
+        juce::int64 size = -1;
+        juce::int64 modified = 0;   // Nanoseconds where the platform has them
+        juce::uint64 fileId = 0;
+
+        bool operator== (const Identity& other) const noexcept
+        {
+            return size == other.size && modified == other.modified && fileId == other.fileId;
+        }
+    };
+
+    struct Entry
+    {
+        Identity identity;
+        juce::String sha256;
+    };
+
+    static Identity getIdentity (const juce::File& file);
+    juce::String findEntry (const juce::String& path, const Identity& identity) const;  // Cached hash if still valid
+
+    void load();
+    void save();
+
+    juce::File cacheFile;
+    juce::ThreadPool hashThreads;
+
+    juce::CriticalSection lock;
+    std::unordered_map<juce::String, Entry> entries;  // Keyed by full path
+    bool loaded = false, dirty = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ColDawHashCache)
+};
@@ -0,0 +1,510 @@
+#include "HttpClient.h"
+#include <algorithm>
+#include <array>
+
+#ifndef COLDAW_HAS_CURL
+ #define COLDAW_HAS_CURL 0
+#endif
+
+#if COLDAW_HAS_CURL
+ #include <curl/curl.h>
+#endif
+
+namespace
+{
+    constexpr size_t timingHistorySize = 64;
+    constexpr size_t maxIdleHandlesPerHost = 4;
+    constexpr int maxAttempts = 8;
+    constexpr int initialRetryDelayMs = 500;
+    constexpr int maxRetryDelayMs = 30000;
+    constexpr juce::int64 maxBodyWithoutExpect = 64 * 1024;
+
+   #if COLDAW_HAS_CURL
+    /** State shared with the libcurl callbacks for one request. */
+    struct Transfer
+    {
+        const ColDawHttpClient::Request& request;
+        juce::OutputStream& output;
+        ColDawHttpClient::Response& response;
+        CURL* curl;
+        bool started = false;
+        bool declined = false;  // responseStarted turned the body down
+    };
+
+    size_t readBody (char* buffer, size_t size, size_t numItems, void* userData)
+    {
+        auto& transfer = *static_cast<Transfer*> (userData);
+        return (size_t) juce::jmax (0, transfer.request.body->read (buffer, (int) (size * numItems)));
+    }
+
+    int seekBody (void* userData, curl_off_t offset, int origin)
+    {
+        auto& transfer = *static_cast<Transfer*> (userData);
+
+        if (origin != SEEK_SET)
+            return CURL_SEEKFUNC_CANTSEEK;
+
+        return transfer.request.body->setPosition ((juce::int64) offset) ? CURL_SEEKFUNC_OK : CURL_SEEKFUNC_FAIL;
+    }
+
+    size_t readHeader (char* data, size_t size, size_t numItems, void* userData)
+    {
+        auto& transfer = *static_cast<Transfer*> (userData);
+        const auto line = juce::String::fromUTF8 (data, (int) (size * numItems)).trim();
+
+        // Each response (a redirect, a 100 Continue) starts with its status line
+        if (line.startsWith ("HTTP/"))
+            transfer.response.headers.clear();
+        else if (line.containsChar (':'))
+            transfer.response.headers.set (line.upToFirstOccurrenceOf (":", false, false).trim(),
+                                           line.fromFirstOccurrenceOf (":", false, false).trim());
+
+        return size * numItems;
+    }
+
+    size_t writeResponse (char* data, size_t size, size_t numItems, void* userData)
+    {
+        auto& transfer = *static_cast<Transfer*> (userData);
+
+        if (! transfer.started)
+        {
+            transfer.started = true;
+
+            long statusCode = 0;
+            curl_easy_getinfo (transfer.curl, CURLINFO_RESPONSE_CODE, &statusCode);
+            transfer.response.statusCode = (int) statusCode;
+
+            if (transfer.request.responseStarted != nullptr && ! transfer.request.responseStarted (transfer.response))
+            {
+                transfer.declined = true;
+                return 0;
+            }
+        }
+
+        return transfer.output.write (data, size * numItems) ? size * numItems : 0;
+    }
+
+    int checkAbort (void* userData, curl_off_t, curl_off_t, curl_off_t, curl_off_t)
+    {
+        auto& transfer = *static_cast<Transfer*> (userData);
+        return transfer.request.shouldAbort != nullptr && transfer.request.shouldAbort() ? 1 : 0;
+    }
+
+    double getMilliseconds (CURL* curl, CURLINFO info)
+    {
+        curl_off_t microseconds = 0;
+        curl_easy_getinfo (curl, info, &microseconds);
+        return (double) microseconds / 1000.0;
+    }
+   #endif
+
+    juce::String getHostKey (const juce::URL& url)
+    {
+        return url.getScheme() + "://" + url.getDomain() + ":" + juce::String (url.getPort());
+    }
+}
+
+//==============================================================================
+#if COLDAW_HAS_CURL
+/**
+ * Idle easy handles by host, plus the DNS and TLS session caches they share.
+ * A handle is only ever used by one thread at a time: it is taken out of the
+ * pool for the request and put back afterwards.
+ */
+struct ColDawHttpClient::Pool
+{
+    Pool()
+    {
+        static const bool curlReady = curl_global_init (CURL_GLOBAL_DEFAULT) == CURLE_OK;
+
+        if (! curlReady)
+            return;
+
+        share = curl_share_init();
+
+        if (share != nullptr)
+        {
+            curl_share_setopt (share, CURLSHOPT_LOCKFUNC, lockShare);
+            curl_share_setopt (share, CURLSHOPT_UNLOCKFUNC, unlockShare);
+            curl_share_setopt (share, CURLSHOPT_USERDATA, this);
+            curl_share_setopt (share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+            curl_share_setopt (share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+        }
+    }
+
+    ~Pool()
+    {
+        for (auto& host : idleHandles)
+            for (auto* handle : host.second)
+                curl_easy_cleanup (handle);
+
+        if (share != nullptr)
+            curl_share_cleanup (share);
+    }
+
+    bool isReady() const noexcept { return share != nullptr; }
+
+    CURL* acquire (const juce::String& host)
+    {
+        {
+            const juce::ScopedLock sl (lock);
+            auto& idle = idleHandles[host];
+
+            if (! idle.empty())
+            {
+                auto* handle = idle.back();
+                idle.pop_back();
+                return handle;
+            }
+        }
+
+        return curl_easy_init();
+    }
+
+    void release (const juce::String& host, CURL* handle, bool reusable)
+    {
+        if (reusable)
+        {
+            // Reset clears the options but keeps the handle's open connections
+            curl_easy_reset (handle);
+
+            const juce::ScopedLock sl (lock);
+            auto& idle = idleHandles[host];
+
+            if (idle.size() < maxIdleHandlesPerHost)
+            {
+                idle.push_back (handle);
+                return;
+            }
+        }
+
+        curl_easy_cleanup (handle);
+    }
+
+    static void lockShare (CURL*, curl_lock_data data, curl_lock_access, void* userData)
+    {
+        static_cast<Pool*> (userData)->shareLocks[(size_t) data].enter();
+    }
+
+    static void unlockShare (CURL*, curl_lock_data data, void* userData)
+    {
+        static_cast<Pool*> (userData)->shareLocks[(size_t) data].exit();
+    }
+
+    CURLSH* share = nullptr;
+    std::array<juce::CriticalSection, CURL_LOCK_DATA_LAST> shareLocks;
+
+    juce::CriticalSection lock;
+    std::map<juce::String, std::vector<CURL*>> idleHandles;
+};
+#else
+struct ColDawHttpClient::Pool {};
+#endif
+
+//==============================================================================
+ColDawHttpClient::ColDawHttpClient()
+{
+   #if COLDAW_HAS_CURL
+    pool = std::make_unique<Pool>();
+
+    if (! pool->isReady())
+        pool.reset();
+   #endif
+}
+
+ColDawHttpClient::~ColDawHttpClient()
+{
+    warmUpThread.removeAllJobs (true, 15000);
+}
+
+ColDawHttpClient::Response ColDawHttpClient::perform (const Request& request)
+{
+    auto response = pool != nullptr ? performWithCurl (request) : performWithUrl (request);
+    recordTiming (request, response);
+    return response;
+}
+
+void ColDawHttpClient::warmUp (const juce::URL& url)
+{
+    warmUpThread.addJob ([this, url]
+    {
+        Request request;
+        request.url = url;
+        request.method = "HEAD";
+        request.connectionTimeoutMs = 10000;
+        perform (request);
+    });
+}
+
+bool ColDawHttpClient::isTransientFailure (const Response& response)
+{
+    return ! response.connected || response.statusCode == 408 || response.statusCode == 429
+        || response.statusCode >= 500;
+}
+
+ColDawHttpClient::Response ColDawHttpClient::performWithRetry (const juce::Thread& thread,
+                                                               const std::function<Response()>& attempt,
+                                                               const std::function<bool (const Response&)>& shouldRetry)
+{
+    juce::Random random;
+    auto delayMs = initialRetryDelayMs;
+
+    for (int i = 1;; ++i)
+    {
+        auto response = attempt();
+
+        if (i == maxAttempts || ! shouldRetry (response))
+            return response;
+
+        const auto end = juce::Time::getMillisecondCounter() + (juce::uint32) random.nextInt (delayMs + 1);
+
+        while (juce::Time::getMillisecondCounter() < end)
+        {
+            if (thread.threadShouldExit())
+                return response;
+
+            juce::Thread::sleep (50);
+        }
+
+        delayMs = juce::jmin (delayMs * 2, maxRetryDelayMs);
+    }
+}
+
+//==============================================================================
+ColDawHttpClient::Response ColDawHttpClient::performWithCurl (const Request& request)
+{
+    Response response;
+
+   #if COLDAW_HAS_CURL
+    const auto host = getHostKey (request.url);
+    auto* curl = pool->acquire (host);
+
+    if (curl == nullptr)
+        return response;
+
+    juce::MemoryOutputStream bufferedResponse (response.body, false);
+    Transfer transfer { request, request.response != nullptr ? *request.response : bufferedResponse, response, curl };
+
+    // Expect is decided here, by body size, whatever the caller put in: curl
+    // goes by the first Expect line, so a caller's would win over ours
+    curl_slist* headerList = nullptr;
+    for (auto& line : juce::StringArray::fromLines (request.headers))
+        if (line.isNotEmpty() && ! line.trimStart().startsWithIgnoreCase ("Expect:"))
+            headerList = curl_slist_append (headerList, line.toRawUTF8());
+
+    // Waiting for a 100 Continue lets the server refuse a big body before it is
+    // sent (e.g. an upload against a stale base). For small bodies it only
+    // costs curl's expect timeout with servers that read the body first.
+    if (request.body != nullptr)
+        headerList = curl_slist_append (headerList, request.body->getTotalLength() > maxBodyWithoutExpect ? "Expect: 100-continue"
+                                                                                                        : "Expect:");
+
+    const auto urlString = request.url.toString (true);
+
+    curl_easy_setopt (curl, CURLOPT_URL, urlString.toRawUTF8());
+    curl_easy_setopt (curl, CURLOPT_SHARE, pool->share);
+    curl_easy_setopt (curl, CURLOPT_HTTPHEADER, headerList);
+    curl_easy_setopt (curl, CURLOPT_HEADERFUNCTION, readHeader);
+    curl_easy_setopt (curl, CURLOPT_HEADERDATA, &transfer);
+    curl_easy_setopt (curl, CURLOPT_WRITEFUNCTION, writeResponse);
+    curl_easy_setopt (curl, CURLOPT_WRITEDATA, &transfer);
+    curl_easy_setopt (curl, CURLOPT_XFERINFOFUNCTION, checkAbort);
+    curl_easy_setopt (curl, CURLOPT_XFERINFODATA, &transfer);
+    curl_easy_setopt (curl, CURLOPT_NOPROGRESS, 0L);
+    curl_easy_setopt (curl, CURLOPT_CONNECTTIMEOUT_MS, (long) request.connectionTimeoutMs);
+    curl_easy_setopt (curl, CURLOPT_LOW_SPEED_LIMIT, 1L);
+    curl_easy_setopt (curl, CURLOPT_LOW_SPEED_TIME, (long) juce::jmax (1, request.connectionTimeoutMs / 1000));
+    curl_easy_setopt (curl, CURLOPT_TIMEOUT_MS, (long) request.timeoutMs);
+    curl_easy_setopt (curl, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt (curl, CURLOPT_MAXREDIRS, 5L);
+    curl_easy_setopt (curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt (curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt (curl, CURLOPT_TCP_KEEPIDLE, 30L);
+    curl_easy_setopt (curl, CURLOPT_TCP_KEEPINTVL, 15L);
+    curl_easy_setopt (curl, CURLOPT_HTTP_VERSION, (long) CURL_HTTP_VERSION_2TLS);
+
+    if (request.method == "HEAD")
+    {
+        curl_easy_setopt (curl, CURLOPT_NOBODY, 1L);
+    }
+    else if (request.method == "POST" || request.body != nullptr)
+    {
+        curl_easy_setopt (curl, CURLOPT_POST, 1L);
+
+        if (request.body != nullptr)
+        {
+            curl_easy_setopt (curl, CURLOPT_POSTFIELDSIZE_LARGE, (curl_off_t) request.body->getTotalLength());
+            curl_easy_setopt (curl, CURLOPT_READFUNCTION, readBody);
+            curl_easy_setopt (curl, CURLOPT_READDATA, &transfer);
+            curl_easy_setopt (curl, CURLOPT_SEEKFUNCTION, seekBody);
+            curl_easy_setopt (curl, CURLOPT_SEEKDATA, &transfer);
+        }
+        else
+        {
+            curl_easy_setopt (curl, CURLOPT_POSTFIELDSIZE, 0L);
+            curl_easy_setopt (curl, CURLOPT_POSTFIELDS, "");
+        }
+
+        if (request.method != "POST")
+            curl_easy_setopt (curl, CURLOPT_CUSTOMREQUEST, request.method.toRawUTF8());
+    }
+    else if (request.method != "GET")
+    {
+        curl_easy_setopt (curl, CURLOPT_CUSTOMREQUEST, request.method.toRawUTF8());
+    }
+
+    const auto result = curl_easy_perform (curl);
+    curl_slist_free_all (headerList);
+
+    if (result == CURLE_OK || (result == CURLE_WRITE_ERROR && transfer.declined))
+    {
+        long statusCode = 0, newConnections = 0;
+        curl_easy_getinfo (curl, CURLINFO_RESPONSE_CODE, &statusCode);
+        curl_easy_getinfo (curl, CURLINFO_NUM_CONNECTS, &newConnections);
+
+        response.connected = true;
+        response.statusCode = (int) statusCode;
+
+        // curl's times are cumulative from the start of the request
+        auto& timing = response.timing;
+        timing.nameLookup = getMilliseconds (curl, CURLINFO_NAMELOOKUP_TIME_T);
+        timing.connect = getMilliseconds (curl, CURLINFO_CONNECT_TIME_T) - timing.nameLookup;
+        timing.tlsHandshake = juce::jmax (0.0, getMilliseconds (curl, CURLINFO_APPCONNECT_TIME_T) - timing.nameLookup - timing.connect);
+        timing.firstByte = getMilliseconds (curl, CURLINFO_STARTTRANSFER_TIME_T);
+        timing.total = getMilliseconds (curl, CURLINFO_TOTAL_TIME_T);
+        timing.reusedConnection = newConnections == 0;
+
+        // Responses without a body never reach writeResponse
+        if (! transfer.started && request.responseStarted != nullptr)
+            request.responseStarted (response);
+    }
+
+    bufferedResponse.flush();
+
+    // A handle whose transfer was aborted may hold a half-read connection
+    pool->release (host, curl, result == CURLE_OK);
+   #else
+    juce::ignoreUnused (request);
+   #endif
+
+    return response;
+}
+
+ColDawHttpClient::Response ColDawHttpClient::performWithUrl (const Request& request)
+{
+    Response response;
+    const auto started = juce::Time::getMillisecondCounterHiRes();
+
+    auto url = request.url;
+
+    // juce::URL can only send a body it holds in memory
+    if (request.body != nullptr)
+    {
+        juce::MemoryBlock bodyData;
+
+        {
+            juce::MemoryOutputStream bodyStream (bodyData, false);
+            bodyStream.writeFromInputStream (*request.body, -1);
+        }
+
+        url = url.withPOSTData (bodyData);
+    }
+
+    auto options = juce::URL::InputStreamOptions (juce::URL::ParameterHandling::inAddress)
+                       .withConnectionTimeoutMs (request.connectionTimeoutMs)
+                       .withStatusCode (&response.statusCode)
+                       .withResponseHeaders (&response.headers)
+                       .withExtraHeaders (request.headers)
+                       .withHttpRequestCmd (request.method)
+                       .withProgressCallback ([&request] (int, int)
+                       {
+                           return request.shouldAbort == nullptr || ! request.shouldAbort();
+                       });
+
+    std::unique_ptr<juce::InputStream> stream (url.createInputStream (options));
+
+    if (stream == nullptr)
+        return response;
+
+    response.connected = true;
+    response.timing.firstByte = juce::Time::getMillisecondCounterHiRes() - started;
+
+    if (request.responseStarted != nullptr && ! request.responseStarted (response))
+    {
+        response.timing.total = juce::Time::getMillisecondCounterHiRes() - started;
+        return response;
+    }
+
+    juce::MemoryOutputStream bufferedResponse (response.body, false);
+    auto& output = request.response != nullptr ? *request.response : bufferedResponse;
+    juce::HeapBlock<char> buffer (65536);
+
+    while (! stream->isExhausted())
+    {
+        if ((request.shouldAbort != nullptr && request.shouldAbort())
+             || juce::Time::getMillisecondCounterHiRes() - started > request.timeoutMs)
+        {
+            response.connected = false;
+            break;
+        }
+
+        const auto numRead = stream->read (buffer, 65536);
+        if (numRead <= 0)
+            break;
+
+        output.write (buffer, (size_t) numRead);
+    }
+
+    bufferedResponse.flush();
+    response.timing.total = juce::Time::getMillisecondCounterHiRes() - started;
+    return response;
+}
+
+//==============================================================================
+void ColDawHttpClient::recordTiming (const Request& request, const Response& response)
+{
+    if (! response.connected)
+        return;
+
+    TimingRecord record { request.method, request.url.toString (false), response.statusCode, response.timing };
+    const juce::ScopedLock sl (timingLock);
+
+    if (timings.size() < timingHistorySize)
+        timings.push_back (std::move (record));
+    else
+        timings[nextTiming] = std::move (record);
+
+    nextTiming = (nextTiming + 1) % timingHistorySize;
+}
+
+std::vector<ColDawHttpClient::TimingRecord> ColDawHttpClient::getRecentTimings() const
+{
+    const juce::ScopedLock sl (timingLock);
+
+    if (timings.size() < timingHistorySize)
+        return timings;
+
+    std::vector<TimingRecord> ordered (timings.begin() + (std::ptrdiff_t) nextTiming, timings.end());
+    ordered.insert (ordered.end(), timings.begin(), timings.begin() + (std::ptrdiff_t) nextTiming);
+    return ordered;
+}
+
+juce::String ColDawHttpClient::getTimingSummary() const
+{
+    std::vector<double> reused, fresh;
+
+    // Time to first byte, so big bodies don't swamp the setup cost
+    for (auto& record : getRecentTimings())
+        (record.timing.reusedConnection ? reused : fresh).push_back (record.timing.firstByte);
+
+    auto median = [] (std::vector<double>& values)
+    {
+        std::sort (values.begin(), values.end());
+        return values.empty() ? 0.0 : values[values.size() / 2];
+    };
+
+    return juce::String ((int) (reused.size() + fresh.size())) + " requests, "
+         + juce::String ((int) reused.size()) + " on reused connections; median time to first byte "
+         + juce::String (median (reused), 1) + " ms reused, "
+         + juce::String (median (fresh), 1) + " ms new";
+}
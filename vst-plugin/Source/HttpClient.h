@@ -0,0 +1,127 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <functional>
+#include <map>
+#include <vector>
+
+//==============================================================================
+/**
+ * ColDaw Export Plugin - shared HTTP client
+ *
+ * Every request the plugin makes goes through here, so connections to the
+ * server are set up once and then reused. Hold it through a
+ * juce::SharedResourcePointer; all plugin instances in a host share one.
+ *
+ * With libcurl, finished easy handles are kept in a small pool per host
+ * (scheme, host and port). A handle keeps its connection open after a
+ * request, so the next request to that host skips DNS, TCP and TLS setup.
+ * DNS results and TLS sessions are also shared between handles, so a
+ * second concurrent connection resumes the TLS session. HTTP/2 is
+ * negotiated over TLS when the server offers it. Without libcurl, requests
+ * go through juce::URL and rely on the platform stack's own keep-alive.
+ *
+ * The timing of each request is kept in a short history so the effect of
+ * connection reuse can be measured.
+ */
+class ColDawHttpClient
+{
+public:
+    //==============================================================================
+    /** Where the time of one request went, in milliseconds. */
+    struct Timing
+    {
+        double nameLookup = 0.0;  // Zero when the connection was reused
+        double connect = 0.0;
+        double tlsHandshake = 0.0;
+        double firstByte = 0.0;
+        double total = 0.0;
+        bool reusedConnection = false;
+    };
+
+    struct Response
+    {
+        bool connected = false;          // False if no response was received
+        int statusCode = 0;
+        juce::StringPairArray headers;   // Names are matched case-insensitively
+        juce::MemoryBlock body;          // Empty if Request::response was set
+        Timing timing;
+
+        bool isSuccess() const noexcept { return connected && statusCode >= 200 && statusCode < 300; }
+        juce::String getBodyAsString() const { return body.toString(); }
+        juce::var getJson() const { return juce::JSON::parse (getBodyAsString()); }
+    };
+
+    struct Request
+    {
+        juce::URL url;
+        juce::String method { "GET" };
+        juce::String headers;                        // "Name: value" lines; Expect is set by body size
+        juce::InputStream* body = nullptr;           // Request body, read as it is sent
+        juce::OutputStream* response = nullptr;      // Where the response body goes; Response::body if null
+        int connectionTimeoutMs = 30000;             // Also how long the transfer may stall
+        int timeoutMs = 10 * 60 * 1000;              // The whole request, body included
+        std::function<bool()> shouldAbort;           // Polled during the transfer
+
+        /** Called with the status code and headers once they are in, before
+            any of the body is written (also for responses without one).
+            Returning false drops the body and ends the request; the response
+            still counts as received.
+        */
+        std::function<bool (const Response&)> responseStarted;
+    };
+
+    struct TimingRecord
+    {
+        juce::String method, url;
+        int statusCode = 0;
+        Timing timing;
+    };
+
+    //==============================================================================
+    ColDawHttpClient();
+    ~ColDawHttpClient();
+
+    /** Performs a request on the calling thread. */
+    Response perform (const Request& request);
+
+    /** Opens a connection to the server in the background, so the first
+        real request finds it ready.
+    */
+    void warmUp (const juce::URL& url);
+
+    /** Worth trying again: no response, or one that says the server is struggling. */
+    static bool isTransientFailure (const Response& response);
+
+    /** Runs a request until it gets a response that isn't transient (or
+        shouldRetry says so), backing off exponentially with full jitter
+        between attempts. Gives up early if the thread is asked to stop.
+    */
+    static Response performWithRetry (const juce::Thread& thread,
+                                      const std::function<Response()>& attempt,
+                                      const std::function<bool (const Response&)>& shouldRetry = isTransientFailure);
+
+    /** The most recent requests, oldest first. */
+    std::vector<TimingRecord> getRecentTimings() const;
+
+    /** One line comparing requests on new and reused connections. */
+    juce::String getTimingSummary() const;
+
+private:
+    //==============================================================================
+    struct Pool;
+
+    Response performWithCurl (const Request& request);
+    Response performWithUrl (const Request& request);
+    void recordTiming (const Request& request, const Response& response);
+
+    std::unique_ptr<Pool> pool;  // Null without libcurl
+
+    juce::CriticalSection timingLock;
+    std::vector<TimingRecord> timings;
+    size_t nextTiming = 0;
+
+    juce::ThreadPool warmUpThread { 1 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ColDawHttpClient)
+};
@@ -0,0 +1,99 @@
+#include "LookAndFeel.h"
+
+//==============================================================================
+ColDAWLookAndFeel::ColDAWLookAndFeel()
+{
+    // Initialize gradient colors matching web theme
+    gradientColors.add(juce::Colour(0xff89AAF8)); // rgba(137, 170, 248, 0.8)
+    gradientColors.add(juce::Colour(0xffB770FC)); // rgba(183, 112, 252, 0.8)
+    gradientColors.add(juce::Colour(0xffD24DC3)); // rgba(210, 77, 195, 0.8)
+    gradientColors.add(juce::Colour(0xffE85560)); // rgba(232, 85, 96, 0.8)
+    gradientColors.add(juce::Colour(0xffF5A193)); // rgba(245, 161, 147, 0.8)
+}
+
+void ColDAWLookAndFeel::drawButtonBackground (juce::Graphics& g,
+                                            juce::Button& button,
+                                            const juce::Colour&,
+                                            bool shouldDrawButtonAsHighlighted,
+                                            bool)
+{
+    // Drawn at the physical resolution, so this is a plain blit
+    const auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    const auto& chrome = getButtonChrome(button.getWidth(), button.getHeight(), shouldDrawButtonAsHighlighted, scale);
+    
+    g.drawImageTransformed(chrome, juce::AffineTransform::scale(1.0f / scale));
+}
+
+const juce::Image& ColDAWLookAndFeel::getButtonChrome (int width, int height, bool highlighted, float scale)
+{
+    const ChromeKey key { width, height, juce::roundToInt(scale * 100.0f), highlighted };
+    auto cached = chromeCache.find(key);
+    
+    if (cached != chromeCache.end())
+        return cached->second;
+    
+    // A handful of buttons at one or two sizes; anything beyond that is left over from earlier layouts
+    if (chromeCache.size() >= 32)
+        chromeCache.clear();
+    
+    juce::Image image(juce::Image::ARGB,
+                      juce::jmax(1, juce::roundToInt(width * scale)),
+                      juce::jmax(1, juce::roundToInt(height * scale)),
+                      true);
+    {
+        juce::Graphics g(image);
+        g.addTransform(juce::AffineTransform::scale(scale));
+        paintButtonChrome(g, juce::Rectangle<int>(width, height).toFloat(), highlighted);
+    }
+    
+    return chromeCache.emplace(key, image).first->second;
+}
+
+void ColDAWLookAndFeel::paintButtonChrome (juce::Graphics& g, juce::Rectangle<float> bounds, bool highlighted) const
+{
+    auto cornerSize = 6.0f; // Match web theme border-radius
+    
+    // The background itself stays transparent
+    if (highlighted)
+    {
+        // Draw gradient border effect on hover
+        juce::ColourGradient gradient(gradientColors[0], bounds.getTopLeft(),
+                                    gradientColors[4], bounds.getBottomRight(), false);
+        
+        for (int i = 1; i < gradientColors.size() - 1; ++i)
+        {
+            gradient.addColour(static_cast<double>(i) / (gradientColors.size() - 1), gradientColors[i]);
+        }
+        
+        g.setGradientFill(gradient);
+        g.drawRoundedRectangle(bounds, cornerSize, 2.0f);
+    }
+    else
+    {
+        // Normal border
+        g.setColour(juce::Colour(0xff2a2a2a)); // borderColor
+        g.drawRoundedRectangle(bounds, cornerSize, 1.0f);
+    }
+}
+
+void ColDAWLookAndFeel::clearCache()
+{
+    chromeCache.clear();
+}
+
+void ColDAWLookAndFeel::drawButtonText (juce::Graphics& g,
+                                      juce::TextButton& button,
+                                      bool shouldDrawButtonAsHighlighted,
+                                      bool)
+{
+    auto font = juce::FontOptions(13.0f, juce::Font::plain); // Use consistent font
+    g.setFont(font);
+    
+    auto textColour = shouldDrawButtonAsHighlighted ? 
+        juce::Colour(0xffffffff) : juce::Colour(0xffb0b0b0); // textPrimary : textSecondary
+    
+    g.setColour(textColour);
+    
+    auto bounds = button.getLocalBounds();
+    g.drawText(button.getButtonText(), bounds, juce::Justification::centred);
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <juce_gui_basics/juce_gui_basics.h>
+#include <map>
+#include <tuple>
+
+//==============================================================================
+/**
+ * Custom Look and Feel class for ColDAW style buttons with gradient borders
+ *
+ * Button chrome is rendered once per size, hover state and display scale
+ * and then drawn as an image, rather than building and stroking the
+ * gradient on every repaint.
+ */
+class ColDAWLookAndFeel : public juce::LookAndFeel_V4
+{
+public:
+    ColDAWLookAndFeel();
+    
+    void drawButtonBackground (juce::Graphics& g,
+                             juce::Button& button,
+                             const juce::Colour& backgroundColour,
+                             bool shouldDrawButtonAsHighlighted,
+                             bool shouldDrawButtonAsDown) override;
+                             
+    void drawButtonText (juce::Graphics& g,
+                        juce::TextButton& button,
+                        bool shouldDrawButtonAsHighlighted,
+                        bool shouldDrawButtonAsDown) override;
+    
+    /** Drops all pre-rendered chrome; call after changing the theme colours. */
+    void clearCache();
+    
+    /** Draws the chrome directly, bypassing the cache. */
+    void paintButtonChrome (juce::Graphics& g, juce::Rectangle<float> bounds, bool highlighted) const;
+
+private:
+    struct ChromeKey
+    {
+        int width, height, scale;  // scale in percent
+        bool highlighted;
+        
+        bool operator< (const ChromeKey& other) const
+        {
+            return std::tie (width, height, scale, highlighted) < std::tie (other.width, other.height, other.scale, other.highlighted);
+        }
+    };
+    
+    const juce::Image& getButtonChrome (int width, int height, bool highlighted, float scale);
+    
+    // Gradient colors for border effect
+    juce::Array<juce::Colour> gradientColors;
+    
+    std::map<ChromeKey, juce::Image> chromeCache;
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ColDAWLookAndFeel)
+};
@@ -0,0 +1,100 @@
+#include "MultipartFormStream.h"
+
+//==============================================================================
+ColDawMultipartFormStream::ColDawMultipartFormStream (const juce::StringPairArray& formFields,
+                                                      const juce::String& fileFieldName,
+                                                      const juce::String& fileName,
+                                                      std::unique_ptr<juce::InputStream> fileContent)
+    : boundary ("----WebKitFormBoundary" + juce::String::toHexString (juce::Random::getSystemRandom().nextInt64())),
+      content (std::move (fileContent))
+{
+    juce::MemoryOutputStream headStream (head, false);
+
+    for (int i = 0; i < formFields.size(); ++i)
+    {
+        headStream << "--" << boundary << "\r\n";
+        headStream << "Content-Disposition: form-data; name=\"" << formFields.getAllKeys()[i] << "\"\r\n\r\n";
+        headStream << formFields.getAllValues()[i] << "\r\n";
+    }
+
+    headStream << "--" << boundary << "\r\n";
+    headStream << "Content-Disposition: form-data; name=\"" << fileFieldName
+               << "\"; filename=\"" << fileName << "\"\r\n";
+    headStream << "Content-Type: application/octet-stream\r\n\r\n";
+    headStream.flush();
+
+    juce::MemoryOutputStream tailStream (tail, false);
+    tailStream << "\r\n--" << boundary << "--\r\n";
+    tailStream.flush();
+
+    if (content != nullptr)
+    {
+        contentLength = content->getTotalLength();
+        content->setPosition (0);
+    }
+}
+
+//==============================================================================
+juce::int64 ColDawMultipartFormStream::getTotalLength()
+{
+    return (juce::int64) head.getSize() + juce::jmax ((juce::int64) 0, contentLength) + (juce::int64) tail.getSize();
+}
+
+bool ColDawMultipartFormStream::isExhausted()
+{
+    return position >= getTotalLength();
+}
+
+int ColDawMultipartFormStream::read (void* destBuffer, int maxBytesToRead)
+{
+    auto* dest = static_cast<char*> (destBuffer);
+    const auto headSize = (juce::int64) head.getSize();
+    const auto contentEnd = headSize + juce::jmax ((juce::int64) 0, contentLength);
+    int numRead = 0;
+
+    while (numRead < maxBytesToRead && ! isExhausted())
+    {
+        const int wanted = maxBytesToRead - numRead;
+        int got = 0;
+
+        if (position < headSize)
+        {
+            got = (int) juce::jmin ((juce::int64) wanted, headSize - position);
+            memcpy (dest + numRead, static_cast<const char*> (head.getData()) + position, (size_t) got);
+        }
+        else if (position < contentEnd)
+        {
+            got = content->read (dest + numRead, (int) juce::jmin ((juce::int64) wanted, contentEnd - position));
+
+            // The file got shorter underneath us - there is nothing sensible left to send
+            if (got <= 0)
+                break;
+        }
+        else
+        {
+            const auto offset = position - contentEnd;
+            got = (int) juce::jmin ((juce::int64) wanted, (juce::int64) tail.getSize() - offset);
+            memcpy (dest + numRead, static_cast<const char*> (tail.getData()) + offset, (size_t) got);
+        }
+
+        numRead += got;
+        position += got;
+    }
+
+    return numRead;
+}
+
+bool ColDawMultipartFormStream::setPosition (juce::int64 newPosition)
+{
+    if (newPosition < 0 || newPosition > getTotalLength())
+        return false;
+
+    const auto headSize = (juce::int64) head.getSize();
+    const auto contentOffset = juce::jlimit ((juce::int64) 0, juce::jmax ((juce::int64) 0, contentLength), newPosition - headSize);
+
+    if (content != nullptr && ! content->setPosition (contentOffset))
+        return false;
+
+    position = newPosition;
+    return true;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+//==============================================================================
+/**
+ * ColDaw Export Plugin - Streaming multipart/form-data body
+ *
+ * Produces a multipart request body on the fly: the form fields and part
+ * headers are rendered up front (they are tiny), while the file part is pulled
+ * from the supplied content stream in whatever chunk size the transport asks
+ * for. The whole body is never held in memory, so uploading a 200 MB set costs
+ * the same extra memory as uploading a 200 KB one.
+ *
+ * The content stream must know its length and be seekable, so the transport
+ * can send Content-Length and rewind if it has to resend the body.
+ */
+class ColDawMultipartFormStream : public juce::InputStream
+{
+public:
+    //==============================================================================
+    ColDawMultipartFormStream (const juce::StringPairArray& formFields,
+                               const juce::String& fileFieldName,
+                               const juce::String& fileName,
+                               std::unique_ptr<juce::InputStream> fileContent);
+
+    /** The Content-Type header value, including the boundary. */
+    juce::String getContentType() const { return "multipart/form-data; boundary=" + boundary; }
+
+    /** False if the content stream could not report its length. */
+    bool isValid() const noexcept { return contentLength >= 0; }
+
+    //==============================================================================
+    juce::int64 getTotalLength() override;
+    bool isExhausted() override;
+    int read (void* destBuffer, int maxBytesToRead) override;
+    juce::int64 getPosition() override { return position; }
+    bool setPosition (juce::int64 newPosition) override;
+
+private:
+    //==============================================================================
+    juce::String boundary;
+    juce::MemoryBlock head, tail;
+    std::unique_ptr<juce::InputStream> content;
+    juce::int64 contentLength = -1;
+    juce::int64 position = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ColDawMultipartFormStream)
+};
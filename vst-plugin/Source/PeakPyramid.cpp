@@ -0,0 +1,170 @@
+#include "PeakPyramid.h"
+#include <cmath>
+
+namespace
+{
+    constexpr juce::uint8 formatVersion = 1;
+
+    /** Eight independent running sums instead of one, so the compiler can keep
+        them in a vector register; a single accumulator can't be vectorised
+        without reordering float additions, which it won't do by itself.
+    */
+    float sumOfSquares (const float* data, int num) noexcept
+    {
+        constexpr int lanes = 8;
+        float partial[lanes] = {};
+        int i = 0;
+
+        for (; i + lanes <= num; i += lanes)
+            for (int lane = 0; lane < lanes; ++lane)
+                partial[lane] += data[i + lane] * data[i + lane];
+
+        float sum = 0.0f;
+
+        for (auto p : partial)
+            sum += p;
+
+        for (; i < num; ++i)
+            sum += data[i] * data[i];
+
+        return sum;
+    }
+
+    juce::int16 toShort (float value) noexcept
+    {
+        return (juce::int16) juce::roundToInt (juce::jlimit (-1.0f, 1.0f, value) * 32767.0f);
+    }
+}
+
+//==============================================================================
+void ColDawPeakPyramid::Bucket::merge (const Bucket& other) noexcept
+{
+    min = juce::jmin (min, other.min);
+    max = juce::jmax (max, other.max);
+    sumOfSquares += other.sumOfSquares;
+}
+
+void ColDawPeakPyramid::reset (int newNumChannels, double newSampleRate)
+{
+    numChannels = newNumChannels;
+    sampleRate = newSampleRate;
+    numSamples = 0;
+    levels.assign (numLevels, {});
+
+    for (auto& level : levels)
+        level.partial.resize ((size_t) numChannels);
+}
+
+void ColDawPeakPyramid::addSamples (const float* const* channels, int num)
+{
+    auto& base = levels.front();
+
+    for (int done = 0; done < num;)
+    {
+        const auto count = juce::jmin (num - done, baseBucketSize - base.partialCount);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            const auto* data = channels[channel] + done;
+            const auto range = juce::FloatVectorOperations::findMinAndMax (data, count);
+            const Bucket block { range.getStart(), range.getEnd(), sumOfSquares (data, count) };
+
+            if (base.partialCount == 0)
+                base.partial[(size_t) channel] = block;
+            else
+                base.partial[(size_t) channel].merge (block);
+        }
+
+        base.partialCount += count;
+        numSamples += count;
+        done += count;
+
+        if (base.partialCount == baseBucketSize)
+            finishBucket (0);
+    }
+}
+
+void ColDawPeakPyramid::finishBucket (size_t index)
+{
+    auto& level = levels[index];
+    level.buckets.insert (level.buckets.end(), level.partial.begin(), level.partial.end());
+
+    if (index + 1 < levels.size())
+    {
+        auto& above = levels[index + 1];
+
+        for (size_t channel = 0; channel < level.partial.size(); ++channel)
+        {
+            if (above.partialCount == 0)
+                above.partial[channel] = level.partial[channel];
+            else
+                above.partial[channel].merge (level.partial[channel]);
+        }
+
+        if (++above.partialCount == fanOut)
+            finishBucket (index + 1);
+    }
+
+    level.partialCount = 0;
+}
+
+//==============================================================================
+void ColDawPeakPyramid::writeTo (juce::OutputStream& out) const
+{
+    out.write ("CDPK", 4);
+    out.writeByte ((char) formatVersion);
+    out.writeByte ((char) numChannels);
+    out.writeShort ((short) levels.size());
+    out.writeInt (juce::roundToInt (sampleRate));
+    out.writeInt64 (numSamples);
+
+    juce::int64 samplesPerBucket = baseBucketSize;
+
+    for (size_t index = 0; index < levels.size(); ++index)
+    {
+        auto& level = levels[index];
+        const auto finished = numChannels > 0 ? (juce::int64) level.buckets.size() / numChannels : 0;
+        const auto tailSamples = numSamples - finished * samplesPerBucket;
+        const auto hasPartial = tailSamples > 0;
+
+        out.writeInt ((int) samplesPerBucket);
+        out.writeInt ((int) (finished + (hasPartial ? 1 : 0)));
+
+        auto writeBucket = [&out] (const Bucket& bucket, juce::int64 bucketSamples)
+        {
+            out.writeShort (toShort (bucket.min));
+            out.writeShort (toShort (bucket.max));
+            out.writeShort (toShort ((float) std::sqrt (bucket.sumOfSquares / (double) bucketSamples)));
+        };
+
+        for (auto& bucket : level.buckets)
+            writeBucket (bucket, samplesPerBucket);
+
+        if (hasPartial)
+        {
+            // The tail: this level's partial bucket plus whatever hasn't reached it from the levels below
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                Bucket tail;
+                bool empty = true;
+
+                for (size_t below = 0; below <= index; ++below)
+                {
+                    if (levels[below].partialCount > 0)
+                    {
+                        if (empty)
+                            tail = levels[below].partial[(size_t) channel];
+                        else
+                            tail.merge (levels[below].partial[(size_t) channel]);
+
+                        empty = false;
+                    }
+                }
+
+                writeBucket (tail, tailSamples);
+            }
+        }
+
+        samplesPerBucket *= fanOut;
+    }
+}
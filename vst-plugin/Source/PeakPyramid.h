@@ -0,0 +1,68 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <vector>
+
+//==============================================================================
+/**
+ * ColDaw Export Plugin - Waveform Peak Pyramid
+ *
+ * Minimum, maximum and RMS of a recording at several zoom levels, built
+ * block by block while the audio is captured, so the web client can draw
+ * the waveform of a preview at any zoom without decoding the audio.
+ *
+ * Level 0 summarises every baseBucketSize samples, and each level above
+ * summarises fanOut buckets of the one below. Only level 0 looks at the
+ * samples; the others merge finished buckets, so adding audio costs the
+ * same however long the recording gets.
+ *
+ * Written as little-endian binary:
+ *
+ *   "CDPK", uint8 version (1), uint8 channels, uint16 levels,
+ *   uint32 sample rate, uint64 samples,
+ *   then per level: uint32 samples per bucket, uint32 buckets,
+ *   and per bucket, per channel: int16 min, max, rms (full scale = 32767)
+ *
+ * The last bucket of a level covers whatever is left of the recording.
+ */
+class ColDawPeakPyramid
+{
+public:
+    //==============================================================================
+    static constexpr int baseBucketSize = 256;
+    static constexpr int fanOut = 4;
+    static constexpr int numLevels = 5;     // 256 to 65536 samples per bucket
+
+    /** Starts an empty recording. */
+    void reset (int numChannels, double sampleRate);
+
+    void addSamples (const float* const* channels, int numSamples);
+
+    juce::int64 getNumSamples() const noexcept      { return numSamples; }
+
+    void writeTo (juce::OutputStream& out) const;
+
+private:
+    //==============================================================================
+    struct Bucket
+    {
+        float min = 0.0f, max = 0.0f;
+        double sumOfSquares = 0.0;
+
+        void merge (const Bucket& other) noexcept;
+    };
+
+    struct Level
+    {
+        std::vector<Bucket> buckets;    // Finished, interleaved by channel
+        std::vector<Bucket> partial;    // The one being filled, per channel
+        int partialCount = 0;           // Samples (level 0) or buckets below that it covers
+    };
+
+    void finishBucket (size_t level);
+
+    int numChannels = 0;
+    double sampleRate = 0.0;
+    juce::int64 numSamples = 0;
+    std::vector<Level> levels;
+};
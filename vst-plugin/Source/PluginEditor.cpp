@@ -1,77 +1,15 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
 
-//==============================================================================
-ColDAWLookAndFeel::ColDAWLookAndFeel()
-{
-    // Initialize gradient colors matching web theme
-    gradientColors.add(juce::Colour(0xff89AAF8)); // rgba(137, 170, 248, 0.8)
-    gradientColors.add(juce::Colour(0xffB770FC)); // rgba(183, 112, 252, 0.8)
-    gradientColors.add(juce::Colour(0xffD24DC3)); // rgba(210, 77, 195, 0.8)
-    gradientColors.add(juce::Colour(0xffE85560)); // rgba(232, 85, 96, 0.8)
-    gradientColors.add(juce::Colour(0xffF5A193)); // rgba(245, 161, 147, 0.8)
-}
-
-void ColDAWLookAndFeel::drawButtonBackground (juce::Graphics& g,
-                                            juce::Button& button,
-                                            const juce::Colour&,
-                                            bool shouldDrawButtonAsHighlighted,
-                                            bool)
-{
-    auto bounds = button.getLocalBounds().toFloat();
-    auto cornerSize = 6.0f; // Match web theme border-radius
-    
-    // Always draw transparent background
-    g.setColour(juce::Colours::transparentBlack);
-    g.fillRoundedRectangle(bounds, cornerSize);
-    
-    // Draw border
-    if (shouldDrawButtonAsHighlighted)
-    {
-        // Create gradient border on hover        
-        // Draw gradient border effect
-        juce::ColourGradient gradient(gradientColors[0], bounds.getTopLeft(),
-                                    gradientColors[4], bounds.getBottomRight(), false);
-        
-        for (int i = 1; i < gradientColors.size() - 1; ++i)
-        {
-            gradient.addColour(static_cast<double>(i) / (gradientColors.size() - 1), gradientColors[i]);
-        }
-        
-        g.setGradientFill(gradient);
-        g.drawRoundedRectangle(bounds, cornerSize, 2.0f);
-    }
-    else
-    {
-        // Normal border
-        g.setColour(juce::Colour(0xff2a2a2a)); // borderColor
-        g.drawRoundedRectangle(bounds, cornerSize, 1.0f);
-    }
-}
-
-void ColDAWLookAndFeel::drawButtonText (juce::Graphics& g,
-                                      juce::TextButton& button,
-                                      bool shouldDrawButtonAsHighlighted,
-                                      bool)
-{
-    auto font = juce::FontOptions(13.0f, juce::Font::plain); // Use consistent font
-    g.setFont(font);
-    
-    auto textColour = shouldDrawButtonAsHighlighted ? 
-        juce::Colour(0xffffffff) : juce::Colour(0xffb0b0b0); // textPrimary : textSecondary
-    
-    g.setColour(textColour);
-    
-    auto bounds = button.getLocalBounds();
-    g.drawText(button.getButtonText(), bounds, juce::Justification::centred);
-}
-
 //==============================================================================
 ColDawExportEditor::ColDawExportEditor (ColDawExportProcessor& p)
     : AudioProcessorEditor (&p), audioProcessor (p)
 {
     // Set size - increased for better spacing
-    setSize (400, 600);
+    setSize (400, 700);
+    
+    // The background layer covers everything, so nothing behind the editor needs painting
+    setOpaque(true);
     
     // Apply custom look and feel
     setLookAndFeel(&customLookAndFeel);
@@ -181,11 +119,18 @@ ColDawExportEditor::ColDawExportEditor (ColDawExportProcessor& p)
     
     // Status label with improved readability
     addAndMakeVisible(statusLabel);
-    statusLabel.setText(audioProcessor.getStatusMessage(), juce::dontSendNotification);
     statusLabel.setFont(juce::FontOptions(11.0f));
     statusLabel.setColour(juce::Label::textColourId, accentPrimary);
     statusLabel.setJustificationType(juce::Justification::centred);
     
+    // Status history below it, newest at the bottom
+    addAndMakeVisible(statusHistoryList);
+    statusHistoryList.setModel(this);
+    statusHistoryList.setRowHeight(16);
+    statusHistoryList.setColour(juce::ListBox::backgroundColourId, bgSecondary);
+    statusHistoryList.setColour(juce::ListBox::outlineColourId, borderColor);
+    statusHistoryList.setOutlineThickness(1);
+    
     // Current file with improved typography
     addAndMakeVisible(currentFileLabel);
     currentFileLabel.setText("PROJECT", juce::dontSendNotification);
@@ -254,30 +199,56 @@ ColDawExportEditor::ColDawExportEditor (ColDawExportProcessor& p)
     authorEditor.setFont(juce::FontOptions(13.0f));
     authorEditor.addListener(this);
     
-    // Start timer to update status
-    startTimer(500);
+    // Status and project details follow the processor's editor state
+    audioProcessor.addChangeListener(this);
+    refresh();
 }
 
 ColDawExportEditor::~ColDawExportEditor()
 {
-    stopTimer();
+    audioProcessor.removeChangeListener(this);
     setLookAndFeel(nullptr);
 }
 
 //==============================================================================
 void ColDawExportEditor::paint (juce::Graphics& g)
 {
-    // Deep black background - teenage engineering style
-    g.fillAll(bgPrimary);
+    const auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
     
-    // Subtle section dividers
-    g.setColour(borderColor);
-    g.drawHorizontalLine(120, 0, getWidth());  // Below title
-    g.drawHorizontalLine(280, 0, getWidth());  // Below login section
+    if (background.isNull() || backgroundScale != scale)
+    {
+        background = juce::Image(juce::Image::RGB,
+                                 juce::jmax(1, juce::roundToInt(getWidth() * scale)),
+                                 juce::jmax(1, juce::roundToInt(getHeight() * scale)),
+                                 false);
+        backgroundScale = scale;
+        
+        juce::Graphics bg(background);
+        bg.addTransform(juce::AffineTransform::scale(scale));
+        
+        // Deep black background - teenage engineering style
+        bg.fillAll(bgPrimary);
+        
+        // Subtle section dividers
+        bg.setColour(borderColor);
+        bg.drawHorizontalLine(120, 0, getWidth());  // Below title
+        bg.drawHorizontalLine(280, 0, getWidth());  // Below login section
+    }
+    
+    g.drawImageTransformed(background, juce::AffineTransform::scale(1.0f / scale));
 }
 
 void ColDawExportEditor::resized()
 {
+    // Also called when a button is shown or hidden; only a new size needs new layers
+    if (background.isValid()
+        && (juce::roundToInt(background.getWidth() / backgroundScale) != getWidth()
+            || juce::roundToInt(background.getHeight() / backgroundScale) != getHeight()))
+    {
+        background = {};
+        customLookAndFeel.clearCache();
+    }
+    
     auto area = getLocalBounds().reduced(24); // Increased padding to match web style
     int margin = 16;  // Match web theme spacing (md)
     int smallMargin = 8; // Match web theme spacing (sm)
@@ -336,7 +307,7 @@ void ColDawExportEditor::resized()
         // Show update preview if available
         if (updatePreviewLabel.isVisible())
         {
-            updatePreviewLabel.setBounds(area.removeFromTop(80));
+            updatePreviewLabel.setBounds(area.removeFromTop(150));
             area.removeFromTop(margin);
         }
     }
@@ -346,6 +317,8 @@ void ColDawExportEditor::resized()
     
     // Status section
     statusLabel.setBounds(area.removeFromTop(24));
+    area.removeFromTop(smallMargin);
+    statusHistoryList.setBounds(area.removeFromTop(84));
     area.removeFromTop(margin);
     
     // Current file section
@@ -366,61 +339,114 @@ void ColDawExportEditor::resized()
     authorEditor.setBounds(area.removeFromTop(32));
 }
 
-void ColDawExportEditor::timerCallback()
+void ColDawExportEditor::lookAndFeelChanged()
 {
-    // Update login status
-    bool loggedIn = audioProcessor.isLoggedIn();
-    exportButton.setEnabled(loggedIn);
-    loginButton.setVisible(!loggedIn);
-    logoutButton.setVisible(loggedIn);
-    usernameEditor.setEnabled(!loggedIn);
-    passwordEditor.setEnabled(!loggedIn);
-    
-    if (loggedIn)
-    {
-        loginStatusLabel.setText("LOGGED IN AS: " + audioProcessor.getUsername().toUpperCase(), juce::dontSendNotification);
-        loginStatusLabel.setColour(juce::Label::textColourId, accentOrange);
-    }
-    else
-    {
-        loginStatusLabel.setText("NOT LOGGED IN", juce::dontSendNotification);
-        loginStatusLabel.setColour(juce::Label::textColourId, textSecondary);
-    }
+    background = {};
+    customLookAndFeel.clearCache();
+}
+
+void ColDawExportEditor::changeListenerCallback (juce::ChangeBroadcaster*)
+{
+    refresh();
+}
+
+void ColDawExportEditor::visibilityChanged()
+{
+    // Also called when the host window is minimised or restored
+    refresh();
+}
+
+void ColDawExportEditor::parentHierarchyChanged()
+{
+    refresh();
+}
+
+void ColDawExportEditor::refresh()
+{
+    // Hidden or minimised editors skip updates; the version says whether
+    // anything was missed once they are showing again
+    if (hasShownState && !isShowing())
+        return;
     
-    // Update status message
-    statusLabel.setText(audioProcessor.getStatusMessage(), juce::dontSendNotification);
+    const auto& state = audioProcessor.getEditorState();
     
-    // Show Fetch/Confirm Updates button if user can fetch updates
-    bool canFetch = audioProcessor.canFetchUpdates();
-    bool hasPreviewed = audioProcessor.hasPreviewedUpdate();
+    if (hasShownState && state.version == shownState.version)
+        return;
     
-    // Button should be visible if user can fetch OR has already previewed
-    bool shouldShowButton = canFetch || hasPreviewed;
+    showState(state, !hasShownState);
+    shownState = state;
+    hasShownState = true;
+}
+
+void ColDawExportEditor::showState (const ColDawExportProcessor::EditorState& state, bool showAll)
+{
+    using State = ColDawExportProcessor::EditorState;
+    auto changed = [&] (auto State::* member) { return showAll || state.*member != shownState.*member; };
+    bool layoutChanged = false;
+    
+    // Update login status
+    if (changed(&State::loggedIn) || changed(&State::username))
+    {
+        bool loggedIn = state.loggedIn;
+        exportButton.setEnabled(loggedIn);
+        loginButton.setVisible(!loggedIn);
+        logoutButton.setVisible(loggedIn);
+        usernameEditor.setEnabled(!loggedIn);
+        passwordEditor.setEnabled(!loggedIn);
+        
+        if (loggedIn)
+        {
+            loginStatusLabel.setText("LOGGED IN AS: " + state.username.toUpperCase(), juce::dontSendNotification);
+            loginStatusLabel.setColour(juce::Label::textColourId, accentOrange);
+        }
+        else
+        {
+            loginStatusLabel.setText("NOT LOGGED IN", juce::dontSendNotification);
+            loginStatusLabel.setColour(juce::Label::textColourId, textSecondary);
+        }
+    }
     
-    if (confirmUpdatesButton.isVisible() != shouldShowButton)
+    // Update status message, and its color - TE style
+    if (changed(&State::statusEventId))
     {
-        confirmUpdatesButton.setVisible(shouldShowButton);
-        resized(); // Trigger layout update
+        statusLabel.setText(state.statusMessage, juce::dontSendNotification);
+        statusLabel.setColour(juce::Label::textColourId, getSeverityColour(state.statusSeverity));
+        
+        // Follow new events only if the list was showing the newest ones
+        auto& scrollBar = statusHistoryList.getVerticalScrollBar();
+        bool wasAtEnd = scrollBar.getCurrentRangeStart() + scrollBar.getCurrentRangeSize() >= scrollBar.getMaximumRangeLimit() - 1.0;
+        
+        statusHistoryList.updateContent();
+        
+        if (wasAtEnd || showAll)
+            statusHistoryList.scrollToEnsureRowIsOnscreen(getNumRows() - 1);
     }
     
-    // Update button text and color based on preview state
-    if (shouldShowButton)
+    // Show Fetch/Confirm Updates button if user can fetch updates
+    if (changed(&State::canFetchUpdates)
+        || changed(&State::previewedUpdate)
+        || changed(&State::updatePreview))
     {
+        bool hasPreviewed = state.previewedUpdate;
+        
+        // Button should be visible if user can fetch OR has already previewed
+        bool shouldShowButton = state.canFetchUpdates || hasPreviewed;
+        bool shouldShowPreview = shouldShowButton && hasPreviewed;
+        
+        if (confirmUpdatesButton.isVisible() != shouldShowButton)
+        {
+            confirmUpdatesButton.setVisible(shouldShowButton);
+            layoutChanged = true;
+        }
+        
+        // Update button text and color based on preview state
         if (hasPreviewed)
         {
             // User has fetched/previewed update - show CONFIRM button
             confirmUpdatesButton.setButtonText("CONFIRM UPDATES");
             confirmUpdatesButton.setColour(juce::TextButton::buttonColourId, successColor);
             confirmUpdatesButton.setColour(juce::TextButton::buttonOnColourId, successColor.brighter(0.2f));
-            
-            // Show and update preview label
-            juce::String previewText = audioProcessor.getUpdatePreview();
-            updatePreviewLabel.setText(previewText, juce::dontSendNotification);
-            if (!updatePreviewLabel.isVisible())
-            {
-                updatePreviewLabel.setVisible(true);
-                resized();
-            }
+            updatePreviewLabel.setText(state.updatePreview, juce::dontSendNotification);
         }
         else
         {
@@ -428,67 +454,84 @@ void ColDawExportEditor::timerCallback()
             confirmUpdatesButton.setButtonText("FETCH UPDATES");
             confirmUpdatesButton.setColour(juce::TextButton::buttonColourId, juce::Colour(0xff4a90e2)); // Blue color
             confirmUpdatesButton.setColour(juce::TextButton::buttonOnColourId, juce::Colour(0xff4a90e2).brighter(0.2f));
-            
-            // Hide preview label when not previewed
-            if (updatePreviewLabel.isVisible())
-            {
-                updatePreviewLabel.setVisible(false);
-                resized();
-            }
+        }
+        
+        if (updatePreviewLabel.isVisible() != shouldShowPreview)
+        {
+            updatePreviewLabel.setVisible(shouldShowPreview);
+            layoutChanged = true;
         }
     }
-    else
+    
+    // Only show "Use Detected File" button if we have a detected file and no current file selected
+    if (changed(&State::hasDetectedFile) || changed(&State::projectName))
     {
-        // Hide preview label when button not shown
-        if (updatePreviewLabel.isVisible())
+        bool hasCurrentFile = !state.projectName.isEmpty() && state.projectName != "None";
+        bool shouldShowDetectedButton = state.hasDetectedFile && !hasCurrentFile;
+        
+        if (useDetectedButton.isVisible() != shouldShowDetectedButton)
         {
-            updatePreviewLabel.setVisible(false);
-            resized();
+            useDetectedButton.setVisible(shouldShowDetectedButton);
+            layoutChanged = true;
         }
     }
     
-    // Show/hide "Use Detected File" button
-    juce::File detectedFile = audioProcessor.getDetectedFile();
-    bool hasDetectedFile = detectedFile.existsAsFile();
-    bool hasCurrentFile = !audioProcessor.getCurrentProjectName().isEmpty() && 
-                          audioProcessor.getCurrentProjectName() != "None";
-    
-    // Only show button if we have a detected file and no current file selected
-    bool shouldShowDetectedButton = hasDetectedFile && !hasCurrentFile;
-    if (useDetectedButton.isVisible() != shouldShowDetectedButton)
+    // Update current file display, with what the metadata index knows about it
+    if (changed(&State::projectName) || changed(&State::projectSummary))
     {
-        useDetectedButton.setVisible(shouldShowDetectedButton);
-        resized(); // Trigger layout update
+        juce::String currentFileText = state.projectName;
+        if (state.projectSummary.isNotEmpty())
+            currentFileText += "  (" + state.projectSummary + ")";
+        currentFileValue.setText(currentFileText, juce::dontSendNotification);
     }
     
-    // Update current file display
-    currentFileValue.setText(audioProcessor.getCurrentProjectName(), juce::dontSendNotification);
-    
     // Update project path from processor (in case it was loaded from mapping)
-    juce::String currentPath = audioProcessor.getProjectPath();
-    if (projectPathEditor.getText() != currentPath)
+    if (changed(&State::projectPath) && projectPathEditor.getText() != state.projectPath)
+        projectPathEditor.setText(state.projectPath, juce::dontSendNotification);
+    
+    if (layoutChanged)
+        resized();
+}
+
+juce::Colour ColDawExportEditor::getSeverityColour (ColDawStatusLog::Severity severity) const
+{
+    switch (severity)
     {
-        projectPathEditor.setText(currentPath, juce::dontSendNotification);
+        case ColDawStatusLog::Severity::error:    return juce::Colour(0xffff0000);      // Red for errors
+        case ColDawStatusLog::Severity::warning:  return juce::Colours::orange;
+        case ColDawStatusLog::Severity::success:  return accentOrange;                  // Orange for success
+        case ColDawStatusLog::Severity::progress: return textSecondary;                 // Gray for processing
+        case ColDawStatusLog::Severity::info:     return accentOrange.darker(0.2f);     // Muted orange
     }
     
-    // Update status color based on message - TE style
-    if (audioProcessor.getStatusMessage().contains("Error") || 
-        audioProcessor.getStatusMessage().contains("failed"))
-        statusLabel.setColour(juce::Label::textColourId, juce::Colour(0xffff0000));  // Red for errors
-    else if (audioProcessor.getStatusMessage().contains("Success"))
-        statusLabel.setColour(juce::Label::textColourId, accentOrange);  // Orange for success
-    else if (audioProcessor.isExporting() || 
-             audioProcessor.getStatusMessage().contains("Logging in"))
-        statusLabel.setColour(juce::Label::textColourId, textSecondary);  // Gray for processing
-    else if (audioProcessor.getStatusMessage().contains("Detected"))
-        statusLabel.setColour(juce::Label::textColourId, accentOrange.darker(0.2f));  // Muted orange
-    else if (audioProcessor.getStatusMessage().contains("selected") ||
-             audioProcessor.getStatusMessage().contains("Logged in"))
-        statusLabel.setColour(juce::Label::textColourId, accentOrange);  // Orange for status
-    else if (audioProcessor.getStatusMessage().contains("Please"))
-        statusLabel.setColour(juce::Label::textColourId, juce::Colours::orange);
-    else
-        statusLabel.setColour(juce::Label::textColourId, juce::Colours::lightblue);
+    return textSecondary;
+}
+
+int ColDawExportEditor::getNumRows()
+{
+    return audioProcessor.getStatusLog().getNumEvents();
+}
+
+void ColDawExportEditor::paintListBoxItem (int rowNumber, juce::Graphics& g, int width, int height, bool)
+{
+    const auto& log = audioProcessor.getStatusLog();
+    
+    if (!juce::isPositiveAndBelow(rowNumber, log.getNumEvents()))
+        return;
+    
+    const auto& event = log.getEvent(rowNumber);
+    auto area = juce::Rectangle<int>(0, 0, width, height).reduced(6, 0);
+    
+    g.setFont(juce::FontOptions(10.0f));
+    g.setColour(textTertiary);
+    g.drawText(event.time.formatted("%H:%M:%S"), area.removeFromLeft(50), juce::Justification::centredLeft);
+    g.drawText(ColDawStatusLog::getName(event.operation).toUpperCase(), area.removeFromLeft(54), juce::Justification::centredLeft);
+    
+    if (event.durationSeconds >= 0.0)
+        g.drawText(juce::String(event.durationSeconds, 1) + " s", area.removeFromRight(40), juce::Justification::centredRight);
+    
+    g.setColour(getSeverityColour(event.severity));
+    g.drawText(event.message, area, juce::Justification::centredLeft, true);
 }
 
 void ColDawExportEditor::buttonClicked (juce::Button* button)
@@ -2,40 +2,19 @@
 
 #include <juce_gui_extra/juce_gui_extra.h>
 #include "PluginProcessor.h"
-
-//==============================================================================
-/**
- * Custom Look and Feel class for ColDAW style buttons with gradient borders
- */
-class ColDAWLookAndFeel : public juce::LookAndFeel_V4
-{
-public:
-    ColDAWLookAndFeel();
-    
-    void drawButtonBackground (juce::Graphics& g,
-                             juce::Button& button,
-                             const juce::Colour& backgroundColour,
-                             bool shouldDrawButtonAsHighlighted,
-                             bool shouldDrawButtonAsDown) override;
-                             
-    void drawButtonText (juce::Graphics& g,
-                        juce::TextButton& button,
-                        bool shouldDrawButtonAsHighlighted,
-                        bool shouldDrawButtonAsDown) override;
-
-private:
-    // Gradient colors for border effect
-    juce::Array<juce::Colour> gradientColors;
-    
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ColDAWLookAndFeel)
-};
+#include "LookAndFeel.h"
 
 //==============================================================================
 /**
  * ColDaw Export Plugin - Editor (GUI)
+ *
+ * Redrawn from the processor's editor state when it reports a change, and
+ * then only the components whose part of the state changed. Nothing is
+ * updated while the editor isn't showing; it catches up when it is shown.
  */
 class ColDawExportEditor : public juce::AudioProcessorEditor,
-                            public juce::Timer,
+                            private juce::ChangeListener,
+                            private juce::ListBoxModel,
                             public juce::Button::Listener,
                             public juce::TextEditor::Listener,
                             public juce::Label::Listener
@@ -47,14 +26,31 @@ public:
     //==============================================================================
     void paint (juce::Graphics&) override;
     void resized() override;
+    void lookAndFeelChanged() override;
+    void visibilityChanged() override;
+    void parentHierarchyChanged() override;
     
-    void timerCallback() override;
     void buttonClicked (juce::Button* button) override;
     void textEditorTextChanged (juce::TextEditor&) override;
     void labelTextChanged (juce::Label* label) override;
 
 private:
+    void changeListenerCallback (juce::ChangeBroadcaster*) override;
+    void refresh();
+    void showState (const ColDawExportProcessor::EditorState& state, bool showAll);
+    juce::Colour getSeverityColour (ColDawStatusLog::Severity severity) const;
+    
+    // Status history - a ListBox only paints the rows in view
+    int getNumRows() override;
+    void paintListBoxItem (int rowNumber, juce::Graphics& g, int width, int height, bool rowIsSelected) override;
+    
     ColDawExportProcessor& audioProcessor;
+    ColDawExportProcessor::EditorState shownState;
+    bool hasShownState = false;
+    
+    // Panels and dividers, rendered once per size and display scale
+    juce::Image background;
+    float backgroundScale = 0.0f;
     
     // Custom Look and Feel
     ColDAWLookAndFeel customLookAndFeel;
@@ -69,6 +65,7 @@ private:
     juce::ToggleButton autoExportToggle;
     
     juce::Label statusLabel;
+    juce::ListBox statusHistoryList;
     juce::Label titleLabel;
     juce::Label loginStatusLabel;
     
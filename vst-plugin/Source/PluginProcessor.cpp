@@ -1,5 +1,12 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "RealtimeCheck.h"
+
+namespace
+{
+    using Severity = ColDawStatusLog::Severity;
+    using Operation = ColDawStatusLog::Operation;
+}
 
 //==============================================================================
 ColDawExportProcessor::ColDawExportProcessor()
@@ -19,9 +26,14 @@ ColDawExportProcessor::ColDawExportProcessor()
     userId = "default_user";
     author = "Ableton User";
     autoExport = false;
+    deltaUploads = true;
+    semanticUploads = false;
+    zstdTransport = false;
+    sampleUploads = true;
     exporting = false;
+    exportQueued = false;
     fileWatcherActive = false;
-    statusMessage = "Please login to continue";
+    statusLog.post(Severity::warning, Operation::login, "Please login to continue");
     username = "";
     authToken = "";
     currentUserId = "";
@@ -35,23 +47,57 @@ ColDawExportProcessor::ColDawExportProcessor()
     // Load saved project path mappings
     loadProjectMapping();
     
-    // Start file watcher
+    uploadEngine = std::make_unique<ColDawUploadEngine>(*this);
+    sampleSync = std::make_unique<ColDawSampleSync>(*this);
+    
+    // Opt-in recording of what plays through the plugin, sent as a preview with each export
+    audioCapture = std::make_unique<ColDawAudioCapture>(statusLog, juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+                                                                       .getChildFile("ColDaw").getChildFile("captures"));
+    
+    // Catch up on sets saved while the plugin wasn't running; unchanged ones aren't read
+    projectMetadata = std::make_unique<ColDawProjectMetadata>(*this, juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+                                                                  .getChildFile("ColDaw").getChildFile("project_metadata.json"));
+    for (auto& pair : filePathMapping)
+        projectMetadata->update(juce::File(pair.first));
+    
+    downloader = std::make_unique<ColDawDownloader>(*this, getUpdateDownloadDirectory().getChildFile("partial"));
+    changePreview = std::make_unique<ColDawChangePreview>(*this);
+    
+    // Saves under the Ableton folder are reported as they happen, rather
+    // than found by rescanning the whole folder tree
+    projectWatcher = std::make_unique<ColDawProjectWatcher>(*this, projectIndex);
+    saveDetector = std::make_unique<ColDawSaveDetector>(*this);
+    projectWatcher->watch(juce::File::getSpecialLocation(juce::File::userMusicDirectory).getChildFile("Ableton"), true);
+    
+    // Open the connection to the server now, so the first real request
+    // doesn't pay for DNS, TCP and TLS setup
+    httpClient->warmUp(juce::URL(serverUrl + "/api/health"));
+    
+    // Web updates are pushed over a long-poll request rather than polled for
+    pushChannel = std::make_unique<ColDawPushChannel>(*this);
+    backgroundRequests = std::make_unique<ColDawBackgroundRequests>();
+    
+    // Keeps the push subscription in step with login and project, plus a
+    // cheap check of the selected file in case a save is ever missed
     startTimer(2000); // Check every 2 seconds
     
-    // Immediately detect the most recently modified .als file on startup
-    detectCurrentProject();
+    // The most recently modified .als file is detected once the watcher has
+    // brought the project index up to date (projectsIndexed)
+    editorState = makeEditorState();
 }
 
 //==============================================================================
 void ColDawExportProcessor::login(const juce::String& user, const juce::String& password)
 {
+    stateChanged();
+    
     if (user.isEmpty() || password.isEmpty())
     {
-        statusMessage = "Error: Username and password required";
+        statusLog.post(Severity::error, Operation::login, "Error: Username and password required");
         return;
     }
     
-    statusMessage = "Logging in...";
+    statusLog.post(Severity::progress, Operation::login, "Logging in...");
     
     // Prepare login request
     juce::URL url(serverUrl + "/api/auth/login");
@@ -63,112 +109,109 @@ void ColDawExportProcessor::login(const juce::String& user, const juce::String&
     
     juce::String jsonString = juce::JSON::toString(jsonBody);
     
-    // Create input stream with headers
-    juce::StringPairArray responseHeaders;
-    int statusCode = 0;
-    
     // IMPORTANT: For JSON POST, we need to properly set Content-Type
-    // Create URL with POST data
-    juce::URL postUrl = url.withPOSTData(jsonString);
-    
-    // Use InputStreamOptions to set proper headers
-    juce::URL::InputStreamOptions options = juce::URL::InputStreamOptions(juce::URL::ParameterHandling::inAddress)
-        .withConnectionTimeoutMs(10000)
-        .withResponseHeaders(&responseHeaders)
-        .withStatusCode(&statusCode)
-        .withExtraHeaders("Content-Type: application/json\r\nContent-Length: " + juce::String(jsonString.length()))
-        .withHttpRequestCmd("POST");
-    
-    std::unique_ptr<juce::InputStream> stream(
-        postUrl.createInputStream(options)
-    );
-    
-    if (stream != nullptr)
+    ColDawHttpClient::Request request;
+    request.url = url;
+    request.method = "POST";
+    request.headers = "Content-Type: application/json";
+    request.connectionTimeoutMs = 10000;
+    
+    const double started = juce::Time::getMillisecondCounterHiRes();
+    
+    // Sent in the background; the answer comes back on the message thread
+    backgroundRequests->perform(request, jsonString, [this, user, started](const ColDawHttpClient::Response& result)
     {
-        juce::String response = stream->readEntireStreamAsString();
+        stateChanged();
         
-        if (statusCode >= 200 && statusCode < 300)
+        auto elapsed = [started] { return (juce::Time::getMillisecondCounterHiRes() - started) / 1000.0; };
+        
+        int statusCode = result.statusCode;
+        
+        if (result.connected)
         {
-            // Success - parse token
-            auto json = juce::JSON::parse(response);
-            if (auto* obj = json.getDynamicObject())
+            juce::String response = result.getBodyAsString();
+        
+            if (statusCode >= 200 && statusCode < 300)
             {
-                if (obj->hasProperty("token") && obj->hasProperty("userId"))
+                // Success - parse token
+                auto json = juce::JSON::parse(response);
+                if (auto* obj = json.getDynamicObject())
                 {
-                    authToken = obj->getProperty("token").toString();
-                    currentUserId = obj->getProperty("userId").toString();
-                    username = user;
+                    if (obj->hasProperty("token") && obj->hasProperty("userId"))
+                    {
+                        authToken = obj->getProperty("token").toString();
+                        currentUserId = obj->getProperty("userId").toString();
+                        username = user;
                     
-                    statusMessage = "Logged in as: " + username;
-                }
-                else if (obj->hasProperty("error"))
-                {
-                    statusMessage = "Login failed: " + obj->getProperty("error").toString();
-                }
-                else
-                {
-                    statusMessage = "Login failed: Invalid response";
+                        statusLog.post(Severity::success, Operation::login, "Logged in as: " + username, elapsed());
+                    }
+                    else if (obj->hasProperty("error"))
+                    {
+                        statusLog.post(Severity::error, Operation::login, "Login failed: " + obj->getProperty("error").toString(), elapsed());
+                    }
+                    else
+                    {
+                        statusLog.post(Severity::error, Operation::login, "Login failed: Invalid response", elapsed());
+                    }
                 }
             }
-        }
-        else if (statusCode == 401)
-        {
-            // Authentication failed - parse error message
-            auto json = juce::JSON::parse(response);
-            if (auto* obj = json.getDynamicObject())
+            else if (statusCode == 401)
             {
-                if (obj->hasProperty("error"))
+                // Authentication failed - parse error message
+                auto json = juce::JSON::parse(response);
+                if (auto* obj = json.getDynamicObject())
                 {
-                    statusMessage = "Login failed: " + obj->getProperty("error").toString();
+                    if (obj->hasProperty("error"))
+                    {
+                        statusLog.post(Severity::error, Operation::login, "Login failed: " + obj->getProperty("error").toString(), elapsed());
+                    }
+                    else
+                    {
+                        statusLog.post(Severity::error, Operation::login, "Login failed: Invalid email or password", elapsed());
+                    }
                 }
                 else
                 {
-                    statusMessage = "Login failed: Invalid email or password";
+                    statusLog.post(Severity::error, Operation::login, "Login failed: Invalid email or password", elapsed());
                 }
             }
             else
             {
-                statusMessage = "Login failed: Invalid email or password";
+                // Other error
+                statusLog.post(Severity::error, Operation::login, "Login failed: Server error (Status: " + juce::String(statusCode) + ")", elapsed());
             }
         }
         else
         {
-            // Other error
-            statusMessage = "Login failed: Server error (Status: " + juce::String(statusCode) + ")";
+            statusLog.post(Severity::error, Operation::login, "Login failed: Could not connect to server", elapsed());
         }
-    }
-    else
-    {
-        statusMessage = "Login failed: Could not connect to server";
-    }
+    });
 }
 
 void ColDawExportProcessor::logout()
 {
+    stateChanged();
+    
     username = "";
     authToken = "";
     currentUserId = "";
-    statusMessage = "Logged out. Please login to continue";
+    statusLog.post(Severity::info, Operation::login, "Logged out. Please login to continue");
 }
 
 void ColDawExportProcessor::exportToColDaw()
 {
-    if (!isLoggedIn())
-    {
-        statusMessage = "Error: Please login first";
-        return;
-    }
+    stateChanged();
     
-    if (exporting)
+    if (!isLoggedIn())
     {
-        statusMessage = "Export already in progress...";
+        statusLog.post(Severity::error, Operation::upload, "Error: Please login first");
         return;
     }
     
     // First, try to use the manually selected file
     if (currentProjectFile.existsAsFile())
     {
-        statusMessage = "Exporting selected project to ColDaw...";
+        statusLog.post(Severity::progress, Operation::upload, "Exporting selected project to ColDaw...");
         uploadProjectFile(currentProjectFile);
         return;
     }
@@ -179,32 +222,39 @@ void ColDawExportProcessor::exportToColDaw()
     
     if (!abletonProjectsDir.exists())
     {
-        statusMessage = "Error: Ableton folder not found. Please select a file manually.";
+        statusLog.post(Severity::error, Operation::project, "Error: Ableton folder not found. Please select a file manually.");
         return;
     }
     
-    // Find the most recently modified .als file (within last 5 minutes)
+    // Find the most recently modified .als file (within last 5 minutes),
+    // looked up in the project index if the watcher hasn't seen a save
     juce::File mostRecentFile;
     juce::Time mostRecentTime;
     juce::Time fiveMinutesAgo = juce::Time::getCurrentTime() - juce::RelativeTime::minutes(5);
     
-    findMostRecentALSFile(abletonProjectsDir, mostRecentFile, mostRecentTime, fiveMinutesAgo);
+    if (lastWrittenProjectFile.existsAsFile() && lastWrittenProjectFile.getLastModificationTime() > fiveMinutesAgo)
+        mostRecentFile = lastWrittenProjectFile;
+    else
+        findMostRecentALSFile(mostRecentFile, mostRecentTime, fiveMinutesAgo);
     
     if (mostRecentFile.existsAsFile())
     {
-        statusMessage = "Detected recent file: " + mostRecentFile.getFileName();
+        statusLog.post(Severity::info, Operation::project, "Detected recent file: " + mostRecentFile.getFileName());
         currentProjectFile = mostRecentFile;
+        exportedModificationTime = mostRecentFile.getLastModificationTime();
+        projectWatcher->setSelectedFile(mostRecentFile);
         uploadProjectFile(mostRecentFile);
     }
     else
     {
-        statusMessage = "No recently saved project found. Please select a file manually.";
+        statusLog.post(Severity::warning, Operation::project, "No recently saved project found. Please select a file manually.");
     }
 }
 
 ColDawExportProcessor::~ColDawExportProcessor()
 {
     stopTimer();
+    cancelPendingUpdate();
 }
 
 //==============================================================================
@@ -271,6 +321,7 @@ void ColDawExportProcessor::changeProgramName (int index, const juce::String& ne
 //==============================================================================
 void ColDawExportProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
+    audioCapture->prepare (sampleRate, juce::jmax (1, getTotalNumInputChannels()));
 }
 
 void ColDawExportProcessor::releaseResources()
@@ -300,6 +351,7 @@ bool ColDawExportProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
 
 void ColDawExportProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
+    const ColDawRealtimeSection realtime;  // Nothing below may allocate or lock
     juce::ScopedNoDenormals noDenormals;
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
@@ -313,6 +365,8 @@ void ColDawExportProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce
         auto* channelData = buffer.getWritePointer (channel);
         // Plugin doesn't process audio, just passes it through
     }
+    
+    audioCapture->process (buffer);
 }
 
 //==============================================================================
@@ -336,6 +390,13 @@ void ColDawExportProcessor::getStateInformation (juce::MemoryBlock& destData)
     xml->setAttribute ("userId", userId);
     xml->setAttribute ("author", author);
     xml->setAttribute ("autoExport", autoExport);
+    xml->setAttribute ("minimumExportInterval", getMinimumExportInterval());
+    xml->setAttribute ("deltaUploads", deltaUploads);
+    xml->setAttribute ("semanticUploads", semanticUploads);
+    xml->setAttribute ("zstdTransport", zstdTransport);
+    xml->setAttribute ("sampleUploads", sampleUploads);
+    xml->setAttribute ("audioCapture", getAudioCapture());
+    xml->setAttribute ("skipRules", projectIndex.getSkipRules().joinIntoString ("\n"));
     xml->setAttribute ("username", username);
     xml->setAttribute ("authToken", authToken);
     xml->setAttribute ("currentUserId", currentUserId);
@@ -345,6 +406,8 @@ void ColDawExportProcessor::getStateInformation (juce::MemoryBlock& destData)
 
 void ColDawExportProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
+    stateChanged();
+    
     // Load settings
     std::unique_ptr<juce::XmlElement> xmlState (getXmlFromBinary (data, sizeInBytes));
     
@@ -352,10 +415,25 @@ void ColDawExportProcessor::setStateInformation (const void* data, int sizeInByt
     {
         if (xmlState->hasTagName ("ColDawExportSettings"))
         {
-            serverUrl = xmlState->getStringAttribute ("serverUrl", serverUrl);
+            auto savedServerUrl = xmlState->getStringAttribute ("serverUrl", serverUrl);
+            if (savedServerUrl != serverUrl)
+            {
+                serverUrl = savedServerUrl;
+                httpClient->warmUp (juce::URL (serverUrl + "/api/health"));
+            }
+            
             userId = xmlState->getStringAttribute ("userId", userId);
             author = xmlState->getStringAttribute ("author", author);
             autoExport = xmlState->getBoolAttribute ("autoExport", autoExport);
+            setMinimumExportInterval (xmlState->getIntAttribute ("minimumExportInterval", getMinimumExportInterval()));
+            deltaUploads = xmlState->getBoolAttribute ("deltaUploads", deltaUploads);
+            semanticUploads = xmlState->getBoolAttribute ("semanticUploads", semanticUploads);
+            zstdTransport = xmlState->getBoolAttribute ("zstdTransport", zstdTransport);
+            sampleUploads = xmlState->getBoolAttribute ("sampleUploads", sampleUploads);
+            setAudioCapture (xmlState->getBoolAttribute ("audioCapture", getAudioCapture()));
+            
+            if (xmlState->hasAttribute ("skipRules"))
+                setProjectSkipRules (juce::StringArray::fromLines (xmlState->getStringAttribute ("skipRules")));
             username = xmlState->getStringAttribute ("username", username);
             authToken = xmlState->getStringAttribute ("authToken", authToken);
             currentUserId = xmlState->getStringAttribute ("currentUserId", currentUserId);
@@ -364,178 +442,251 @@ void ColDawExportProcessor::setStateInformation (const void* data, int sizeInByt
 }
 
 //==============================================================================
-// Helper function to recursively find most recent .als file
-void ColDawExportProcessor::findMostRecentALSFile(const juce::File& directory, 
-                                                    juce::File& mostRecentFile, 
+// Helper function to find the most recent .als file under the Ableton folder
+void ColDawExportProcessor::findMostRecentALSFile(juce::File& mostRecentFile, 
                                                     juce::Time& mostRecentTime,
                                                     const juce::Time& minimumTime)
 {
-    juce::Array<juce::File> alsFiles;
-    directory.findChildFiles(alsFiles, juce::File::findFiles, true, "*.als");
+    // The watcher keeps the index up to date on its own thread; saves since
+    // then are covered by lastWrittenProjectFile
     
-    for (auto& file : alsFiles)
-    {
-        auto modTime = file.getLastModificationTime();
-        
-        // Only consider files modified after minimumTime
-        if (modTime > minimumTime && modTime > mostRecentTime)
-        {
-            mostRecentFile = file;
-            mostRecentTime = modTime;
-        }
-    }
+    // Only consider files modified after minimumTime
+    juce::File file = projectIndex.findMostRecent(juce::jmax(minimumTime, mostRecentTime), mostRecentTime);
+    if (file != juce::File())
+        mostRecentFile = file;
 }
 
 void ColDawExportProcessor::uploadProjectFile(const juce::File& alsFile)
 {
     if (!alsFile.existsAsFile())
     {
-        statusMessage = "Error: File does not exist";
-        exporting = false;
+        statusLog.post(Severity::error, Operation::upload, "Error: File does not exist");
+        exporting = uploadEngine->isBusy();
         return;
     }
     
-    // Read file data
-    juce::MemoryBlock fileData;
-    if (!alsFile.loadFileAsData(fileData))
+    // Other projects go straight into the pipeline, but a second upload of
+    // this one has to wait: it is sent against the version the first creates
+    if (uploadEngine->isUploading(alsFile))
     {
-        statusMessage = "Error: Could not read file";
-        exporting = false;
+        exportQueued = true;
+        statusLog.post(Severity::progress, Operation::upload, "Export queued until the current upload of this project finishes");
         return;
     }
     
-    // Create multipart form data with proper binary handling
-    juce::String boundary = "----WebKitFormBoundary" + juce::String::toHexString(juce::Random::getSystemRandom().nextInt64());
-    
-    juce::MemoryOutputStream postData;
-    
-    // Add form fields
-    auto addFormField = [&](const juce::String& name, const juce::String& value)
+    // Hand the upload to the background engine - read, hash, compress, send and
+    // response parsing all happen off the message thread
+    ColDawUploadEngine::Request request;
+    request.file = alsFile;
+    request.endpoint = juce::URL(serverUrl + "/api/projects/smart-import");
+    request.authToken = authToken;
+    request.formFields.set("projectName", alsFile.getFileNameWithoutExtension());
+    request.formFields.set("author", username.isNotEmpty() ? username : author);
+    request.formFields.set("message", "Update from VST plugin - " + juce::Time::getCurrentTime().toString(true, true));
+    
+    // Big sets go in resumable chunks, so a dropped connection doesn't start them over
+    request.sessionEndpoint = juce::URL(serverUrl + "/api/projects/upload-sessions");
+    request.zstdTransport = zstdTransport;
+    
+    // Skip the upload if the bytes are the same as last time, and let the
+    // server reject it up front if someone else has pushed since our base
+    juce::String fileKey = alsFile.getFullPathName();
+    if (uploadedHashMapping.find(fileKey) != uploadedHashMapping.end())
+        request.previousContentHash = uploadedHashMapping[fileKey];
+    
+    juce::String projectId = getProjectIdFromPath(filePathMapping[fileKey]);
+    if (projectId.isNotEmpty() && baseVersionMapping.find(fileKey) != baseVersionMapping.end())
     {
-        postData << "--" << boundary << "\r\n";
-        postData << "Content-Disposition: form-data; name=\"" << name << "\"\r\n\r\n";
-        postData << value << "\r\n";
-    };
-    
-    addFormField("projectName", alsFile.getFileNameWithoutExtension());
-    addFormField("author", username.isNotEmpty() ? username : author);
-    addFormField("message", "Update from VST plugin - " + juce::Time::getCurrentTime().toString(true, true));
-    
-    // Add file data
-    postData << "--" << boundary << "\r\n";
-    postData << "Content-Disposition: form-data; name=\"alsFile\"; filename=\"" << alsFile.getFileName() << "\"\r\n";
-    postData << "Content-Type: application/octet-stream\r\n\r\n";
-    
-    // Write binary file data
-    postData.write(fileData.getData(), fileData.getSize());
-    
-    // End of file part
-    postData << "\r\n";
+        juce::String baseVersion = baseVersionMapping[fileKey];
+        juce::String projectUrl = serverUrl + "/api/projects/" + projectId;
+        
+        request.headers.set("X-ColDaw-Project-Id", projectId);
+        request.headers.set("X-ColDaw-Base-Version", baseVersion);
+        
+        // The server can rebuild the file from the blocks it already has
+        if (deltaUploads)
+        {
+            request.signatureUrl = juce::URL(projectUrl + "/signature/" + baseVersion);
+            request.deltaEndpoint = juce::URL(projectUrl + "/delta-import");
+        }
+        
+        // ...or from the XML subtrees it already has
+        if (semanticUploads)
+        {
+            request.semanticEndpoint = juce::URL(projectUrl + "/semantic-import");
+            request.semanticBaseUrl = juce::URL(serverUrl + "/api/versions/" + projectId + "/download/" + baseVersion);
+            request.semanticBaseFile = getBaseCacheDirectory().getChildFile(baseVersion + ".als");
+        }
+    }
     
-    // Final boundary
-    postData << "--" << boundary << "--\r\n";
+    exporting = true;
+    uploadEngine->enqueue(std::move(request));
+}
+
+void ColDawExportProcessor::uploadFinished(const ColDawUploadEngine::Result& result)
+{
+    stateChanged();
     
-    // Get the complete multipart data
-    juce::MemoryBlock completePostData = postData.getMemoryBlock();
+    exporting = uploadEngine->isBusy();
+    handleUploadResult(result);
     
-    // Prepare headers with authentication
-    juce::String contentType = "multipart/form-data; boundary=" + boundary;
-    juce::String extraHeaders = "Content-Type: " + contentType;
-    if (authToken.isNotEmpty())
+    // Saves that completed during the upload go out as one follow-up export
+    if (exportQueued && !uploadEngine->isUploading(currentProjectFile))
     {
-        extraHeaders += "\r\nAuthorization: Bearer " + authToken;
+        exportQueued = false;
+        exportToColDaw();
     }
+}
+
+void ColDawExportProcessor::handleUploadResult(const ColDawUploadEngine::Result& result)
+{
     
-    // Create URL for POST request - use smart-import endpoint
-    juce::URL uploadUrl(serverUrl + "/api/projects/smart-import");
-    
-    // Create URL with POST data
-    juce::URL postUrl = uploadUrl.withPOSTData(completePostData);
-    
-    // Create input stream with headers
-    juce::StringPairArray responseHeaders;
-    int statusCode = 0;
+    if (result.unchanged)
+    {
+        statusLog.post(Severity::info, Operation::upload, "No changes since last export - upload skipped", result.elapsedSeconds);
+        return;
+    }
     
-    // Use InputStreamOptions for proper headers
-    juce::URL::InputStreamOptions options = juce::URL::InputStreamOptions(juce::URL::ParameterHandling::inAddress)
-        .withConnectionTimeoutMs(30000)
-        .withResponseHeaders(&responseHeaders)
-        .withStatusCode(&statusCode)
-        .withExtraHeaders(extraHeaders)
-        .withHttpRequestCmd("POST");
+    if (!result.connected)
+    {
+        statusLog.post(Severity::error, Operation::upload, "Error: " + result.errorMessage, result.elapsedSeconds);
+        return;
+    }
     
-    std::unique_ptr<juce::InputStream> stream(
-        postUrl.createInputStream(options)
-    );
+    const int statusCode = result.statusCode;
     
-    if (stream != nullptr)
+    if (statusCode >= 200 && statusCode < 300)
     {
-        juce::String response = stream->readEntireStreamAsString();
-        
-        if (statusCode >= 200 && statusCode < 300)
+        // Parse JSON response
+        if (auto* obj = result.response.getDynamicObject())
         {
-            // Parse JSON response
-            auto json = juce::JSON::parse(response);
-            if (auto* obj = json.getDynamicObject())
+            if (obj->hasProperty("projectId"))
             {
-                if (obj->hasProperty("projectId"))
+                juce::String projectId = obj->getProperty("projectId").toString();
+                bool isNewProject = obj->hasProperty("isNewProject") && 
+                                   obj->getProperty("isNewProject").toString() == "true";
+                bool hasPendingChanges = obj->hasProperty("hasPendingChanges") &&
+                                        obj->getProperty("hasPendingChanges");
+                
+                // Automatically set project path for this file. Uploads overlap and
+                // the user may have switched files since, so the open project only
+                // follows results for the file that is open
+                juce::String uploadedProjectPath = "/project/" + projectId;
+                if (result.file == currentProjectFile)
+                    projectPath = uploadedProjectPath;
+                
+                if (result.file.existsAsFile())
                 {
-                    juce::String projectId = obj->getProperty("projectId").toString();
-                    bool isNewProject = obj->hasProperty("isNewProject") && 
-                                       obj->getProperty("isNewProject").toString() == "true";
-                    bool hasPendingChanges = obj->hasProperty("hasPendingChanges") &&
-                                            obj->getProperty("hasPendingChanges");
+                    juce::String fileKey = result.file.getFullPathName();
+                    filePathMapping[fileKey] = uploadedProjectPath;
+                    uploadedHashMapping[fileKey] = result.contentHash;
                     
-                    // Automatically set project path for this file
-                    projectPath = "/project/" + projectId;
-                    if (alsFile.existsAsFile())
-                    {
-                        juce::String fileKey = alsFile.getFullPathName();
-                        filePathMapping[fileKey] = projectPath;
-                        saveProjectMapping();
-                    }
+                    // Remember which server version this upload was based on
+                    juce::String baseVersionId = obj->getProperty(isNewProject ? "versionId" : "baseVersionId").toString();
+                    if (baseVersionId.isNotEmpty())
+                        baseVersionMapping[fileKey] = baseVersionId;
                     
-                    if (isNewProject)
-                    {
-                        statusMessage = "New project created! Project ID: " + projectId;
-                    }
-                    else if (hasPendingChanges)
-                    {
-                        statusMessage = "Project updated! Pending changes ready to push.";
-                    }
-                    else
-                    {
-                        statusMessage = "New version added to existing project! ID: " + projectId;
-                    }
+                    saveProjectMapping();
                     
-                    // Open in browser with VST import flag
-                    openProjectInBrowser(projectId, hasPendingChanges);
+                    // Collaborators need the audio too; only what the server lacks is sent
+                    if (sampleUploads)
+                        sampleSync->sync(result.file, serverUrl, projectId, authToken);
                 }
-                else if (obj->hasProperty("error"))
+                
+                // The preview is named after the version, or the pending import it will become
+                if (getAudioCapture())
                 {
-                    statusMessage = "Error: " + obj->getProperty("error").toString();
+                    juce::String previewKey = obj->getProperty(isNewProject ? "versionId" : "tempFileName").toString();
+                    if (previewKey.isNotEmpty())
+                        audioCapture->attach(juce::URL(serverUrl + "/api/projects/" + projectId + "/previews/" + previewKey), authToken);
+                }
+                
+                juce::String message;
+                
+                if (isNewProject)
+                {
+                    message = "New project created! Project ID: " + projectId;
+                }
+                else if (hasPendingChanges)
+                {
+                    message = "Project updated! Pending changes ready to push.";
                 }
                 else
                 {
-                    statusMessage = "Error: Invalid server response";
+                    message = "New version added to existing project! ID: " + projectId;
                 }
+                
+                if (result.sentAsDelta)
+                    message += " (sent " + juce::File::descriptionOfSizeInBytes(result.bytesSent) + " as delta)";
+                else if (result.sentWithZstd)
+                    message += " (sent " + juce::File::descriptionOfSizeInBytes(result.bytesSent) + " with zstd)";
+                
+                statusLog.post(Severity::success, Operation::upload, message, result.elapsedSeconds);
+                
+                // Open in browser with VST import flag
+                openProjectInBrowser(projectId, hasPendingChanges);
+            }
+            else if (obj->hasProperty("error"))
+            {
+                statusLog.post(Severity::error, Operation::upload, "Error: " + obj->getProperty("error").toString(), result.elapsedSeconds);
+            }
+            else
+            {
+                statusLog.post(Severity::error, Operation::upload, "Error: Invalid server response", result.elapsedSeconds);
             }
-        }
-        else if (statusCode == 401)
-        {
-            statusMessage = "Error: Authentication failed. Please login again.";
         }
         else
         {
-            statusMessage = "Error: Upload failed (Status: " + juce::String(statusCode) + ")";
+            statusLog.post(Severity::error, Operation::upload, "Error: Invalid server response", result.elapsedSeconds);
         }
     }
+    else if (statusCode == 401)
+    {
+        statusLog.post(Severity::error, Operation::upload, "Error: Authentication failed. Please login again.", result.elapsedSeconds);
+    }
+    else if (statusCode == 409)
+    {
+        statusLog.post(Severity::error, Operation::upload, "Error: Project has newer changes on the server. Please fetch updates first.", result.elapsedSeconds);
+    }
     else
     {
-        statusMessage = "Error: Could not connect to server";
+        statusLog.post(Severity::error, Operation::upload, "Error: Upload failed (Status: " + juce::String(statusCode) + ")", result.elapsedSeconds);
     }
+}
+
+void ColDawExportProcessor::samplesSynced(const ColDawSampleSync::Result& result)
+{
+    stateChanged();
     
-    exporting = false;
+    if (result.errorMessage.isNotEmpty())
+    {
+        statusLog.post(Severity::error, Operation::samples, "Error: Could not sync samples - " + result.errorMessage);
+        return;
+    }
+    
+    if (result.uploaded == 0 && result.failed == 0 && result.missingLocally == 0)
+        return;
+    
+    juce::String message = "Samples: " + juce::String(result.uploaded) + " uploaded ("
+                         + juce::File::descriptionOfSizeInBytes(result.bytesUploaded) + ")";
+    
+    if (result.failed > 0)
+        message += ", " + juce::String(result.failed) + " failed";
+    
+    if (result.missingLocally > 0)
+        message += ", " + juce::String(result.missingLocally) + " missing on this computer";
+    
+    statusLog.post(result.failed > 0 || result.missingLocally > 0 ? Severity::warning : Severity::success,
+                   Operation::samples, message);
+}
+
+juce::String ColDawExportProcessor::getProjectIdFromPath(const juce::String& path)
+{
+    // Project paths look like /project/PROJECT_ID, possibly with a trailing path
+    if (!path.startsWith("/project/"))
+        return {};
+    
+    return path.substring(9).upToFirstOccurrenceOf("/", false, false);
 }
 
 void ColDawExportProcessor::openProjectInBrowser(const juce::String& projectId, bool fromVST)
@@ -564,57 +715,85 @@ void ColDawExportProcessor::openProjectInBrowser(const juce::String& projectId,
 
 void ColDawExportProcessor::timerCallback()
 {
-    // Check for web updates if logged in
-    if (isLoggedIn() && currentProjectFile.existsAsFile())
-    {
-        checkForWebUpdates();
-    }
+    // Also notices the selected file being moved or deleted behind our back;
+    // the editor only hears about it if that changed what it shows
+    stateChanged();
+    
+    updatePushSubscription();
     
-    if (!autoExport || exporting)
+    if (!autoExport)
+        return;
+    
+    exportIfProjectSaved();
+}
+
+void ColDawExportProcessor::projectFileWritten(const juce::File& file)
+{
+    stateChanged();
+    
+    lastWrittenProjectFile = file;
+    
+    // Saves of projects we know are followed to completion for their metadata, export or not
+    if (file == currentProjectFile || filePathMapping.find(file.getFullPathName()) != filePathMapping.end())
+        saveDetector->fileChanged(file);
+    
+    if (!autoExport)
         return;
     
     // Auto-detect if no file is manually selected
     if (!currentProjectFile.existsAsFile())
     {
-        juce::File abletonProjectsDir = juce::File::getSpecialLocation(
-            juce::File::userMusicDirectory).getChildFile("Ableton");
-        
-        if (abletonProjectsDir.exists())
-        {
-            juce::File mostRecentFile;
-            juce::Time mostRecentTime;
-            juce::Time fiveMinutesAgo = juce::Time::getCurrentTime() - juce::RelativeTime::minutes(5);
-            
-            findMostRecentALSFile(abletonProjectsDir, mostRecentFile, mostRecentTime, fiveMinutesAgo);
-            
-            if (mostRecentFile.existsAsFile())
-            {
-                currentProjectFile = mostRecentFile;
-                lastModificationTime = mostRecentTime;
-            }
-        }
+        currentProjectFile = file;
+        lastModificationTime = file.getLastModificationTime();
+        exportedModificationTime = lastModificationTime;
+        projectWatcher->setSelectedFile(file);
+        return;
     }
     
+    if (file == currentProjectFile)
+        exportIfProjectSaved();
+}
+
+void ColDawExportProcessor::exportIfProjectSaved()
+{
     if (currentProjectFile.existsAsFile())
     {
         auto currentModTime = currentProjectFile.getLastModificationTime();
         
         if (currentModTime > lastModificationTime)
         {
-            // File has been modified, auto-export
+            // File has been modified - export once Live has finished writing it
             lastModificationTime = currentModTime;
-            statusMessage = "Detected project save, auto-exporting...";
-            
-            // Wait a bit to ensure file is fully saved
-            juce::Thread::sleep(500);
-            
-            exportToColDaw();
+            statusLog.post(Severity::progress, Operation::project, "Detected project save, waiting for it to finish...");
+            saveDetector->fileChanged(currentProjectFile);
         }
     }
 }
 
+void ColDawExportProcessor::saveCompleted(const juce::File& file)
+{
+    stateChanged();
+    
+    projectMetadata->update(file);
+    
+    if (!autoExport || file != currentProjectFile)
+        return;
+    
+    // Not a save: our own write of an applied web update, or one already exported
+    auto modified = file.getLastModificationTime();
+    if (modified <= exportedModificationTime)
+        return;
+    
+    exportedModificationTime = modified;
+    
+    statusLog.post(Severity::progress, Operation::upload, "Detected project save, auto-exporting...");
+    exportToColDaw();
+}
+
 void ColDawExportProcessor::detectCurrentProject()
 {
+    stateChanged();
+    
     juce::File abletonProjectsDir = juce::File::getSpecialLocation(
         juce::File::userMusicDirectory).getChildFile("Ableton");
     
@@ -626,21 +805,29 @@ void ColDawExportProcessor::detectCurrentProject()
     juce::Time mostRecentTime;
     juce::Time thirtyMinutesAgo = juce::Time::getCurrentTime() - juce::RelativeTime::minutes(30);
     
-    findMostRecentALSFile(abletonProjectsDir, mostRecentFile, mostRecentTime, thirtyMinutesAgo);
+    findMostRecentALSFile(mostRecentFile, mostRecentTime, thirtyMinutesAgo);
     
     if (mostRecentFile.existsAsFile())
     {
         detectedProjectFile = mostRecentFile;
-        statusMessage = "Detected: " + mostRecentFile.getFileNameWithoutExtension() + " (click to use)";
+        statusLog.post(Severity::info, Operation::project, "Detected: " + mostRecentFile.getFileNameWithoutExtension() + " (click to use)");
     }
 }
 
+void ColDawExportProcessor::projectsIndexed(const juce::File&)
+{
+    // Startup detection needs the index, which the watcher refreshes on its thread
+    detectCurrentProject();
+}
+
 void ColDawExportProcessor::useDetectedFile()
 {
+    stateChanged();
+    
     if (detectedProjectFile.existsAsFile())
     {
         setCurrentProjectFile(detectedProjectFile);
-        statusMessage = "Using: " + detectedProjectFile.getFileNameWithoutExtension();
+        statusLog.post(Severity::info, Operation::project, "Using: " + detectedProjectFile.getFileNameWithoutExtension());
     }
 }
 
@@ -679,6 +866,29 @@ void ColDawExportProcessor::loadProjectMapping()
             }
         }
     }
+    
+    // Per-file upload state lives next to the mappings
+    juce::File uploadStateFile = mappingFile.getSiblingFile("upload_state.json");
+    
+    if (uploadStateFile.existsAsFile())
+    {
+        juce::var jsonData = juce::JSON::parse(uploadStateFile.loadFileAsString());
+        
+        if (auto* obj = jsonData.getDynamicObject())
+        {
+            for (auto& prop : obj->getProperties())
+            {
+                juce::String fileKey = prop.name.toString();
+                juce::String hash = prop.value.getProperty("hash", "").toString();
+                juce::String baseVersion = prop.value.getProperty("baseVersion", "").toString();
+                
+                if (hash.isNotEmpty())
+                    uploadedHashMapping[fileKey] = hash;
+                if (baseVersion.isNotEmpty())
+                    baseVersionMapping[fileKey] = baseVersion;
+            }
+        }
+    }
 }
 
 void ColDawExportProcessor::saveProjectMapping()
@@ -701,10 +911,42 @@ void ColDawExportProcessor::saveProjectMapping()
     
     juce::String jsonText = juce::JSON::toString(jsonData, true);
     mappingFile.replaceWithText(jsonText);
+    
+    // Save per-file upload state (content hash and base version)
+    juce::var uploadState = new juce::DynamicObject();
+    
+    auto getEntry = [&uploadState](const juce::String& fileKey) -> juce::DynamicObject*
+    {
+        auto* states = uploadState.getDynamicObject();
+        if (!states->hasProperty(fileKey))
+            states->setProperty(fileKey, new juce::DynamicObject());
+        return states->getProperty(fileKey).getDynamicObject();
+    };
+    
+    for (auto& pair : uploadedHashMapping)
+        getEntry(pair.first)->setProperty("hash", pair.second);
+    
+    for (auto& pair : baseVersionMapping)
+        getEntry(pair.first)->setProperty("baseVersion", pair.second);
+    
+    mappingFile.getSiblingFile("upload_state.json").replaceWithText(juce::JSON::toString(uploadState, true));
+    
+    // Cached base versions are only useful while some file is still based on them
+    for (auto& cached : getBaseCacheDirectory().findChildFiles(juce::File::findFiles, false, "*.als"))
+    {
+        bool stillUsed = false;
+        for (auto& pair : baseVersionMapping)
+            stillUsed = stillUsed || pair.second == cached.getFileNameWithoutExtension();
+        
+        if (!stillUsed)
+            cached.deleteFile();
+    }
 }
 
 void ColDawExportProcessor::setCurrentProjectFile(const juce::File& file)
 {
+    stateChanged();
+    
     if (file.existsAsFile() && file.hasFileExtension(".als"))
     {
         // Generate a unique key for this file (using file path hash)
@@ -721,251 +963,258 @@ void ColDawExportProcessor::setCurrentProjectFile(const juce::File& file)
         }
         currentProjectFile = file;
         lastModificationTime = file.getLastModificationTime();
-        statusMessage = "File selected: " + file.getFileNameWithoutExtension();
+        exportedModificationTime = lastModificationTime;
+        statusLog.post(Severity::info, Operation::project, "File selected: " + file.getFileNameWithoutExtension());
+        
+        // Covers projects kept outside the Ableton folder
+        projectWatcher->watch(file.getParentDirectory(), false);
+        projectWatcher->setSelectedFile(file);
+        projectMetadata->update(file);
     }
 }
 
+//==============================================================================
+// Editor state
+//==============================================================================
+
+void ColDawExportProcessor::stateChanged()
+{
+    // Called on the way into anything that may change what the editor shows;
+    // the snapshot is taken once the message thread is done with it, so a
+    // burst of changes is compared and published once
+    triggerAsyncUpdate();
+}
+
+void ColDawExportProcessor::handleAsyncUpdate()
+{
+    auto state = makeEditorState();
+    
+    if (state.hasSameContent(editorState))
+        return;
+    
+    state.version = editorState.version + 1;
+    editorState = state;
+    sendSynchronousChangeMessage();
+}
+
+ColDawExportProcessor::EditorState ColDawExportProcessor::makeEditorState() const
+{
+    EditorState state;
+    state.statusMessage = statusLog.getLatest().message;
+    state.statusSeverity = statusLog.getLatest().severity;
+    state.statusEventId = statusLog.getLatest().id;
+    state.loggedIn = isLoggedIn();
+    state.username = username;
+    state.projectName = getCurrentProjectName();
+    state.projectSummary = getCurrentProjectMetadata().describe();
+    state.projectPath = projectPath;
+    state.hasDetectedFile = detectedProjectFile.existsAsFile();
+    state.canFetchUpdates = canFetchUpdates();
+    state.previewedUpdate = updatePreviewed;
+    state.updatePreview = updatePreview;
+    return state;
+}
+
+bool ColDawExportProcessor::EditorState::hasSameContent(const EditorState& other) const
+{
+    return statusEventId == other.statusEventId
+        && loggedIn == other.loggedIn
+        && username == other.username
+        && projectName == other.projectName
+        && projectSummary == other.projectSummary
+        && projectPath == other.projectPath
+        && hasDetectedFile == other.hasDetectedFile
+        && canFetchUpdates == other.canFetchUpdates
+        && previewedUpdate == other.previewedUpdate
+        && updatePreview == other.updatePreview;
+}
+
+void ColDawExportProcessor::statusLogChanged()
+{
+    stateChanged();
+}
+
+void ColDawExportProcessor::projectIndexed(const juce::File& alsFile)
+{
+    // The editor shows the summary of the current project only
+    if (alsFile == currentProjectFile)
+        stateChanged();
+}
+
 //==============================================================================
 // VST Bridge - Web to DAW updates
 //==============================================================================
 
+void ColDawExportProcessor::updatePushSubscription()
+{
+    // Only hands the channel a new subscription when the project, user or token changes
+    juce::String projectId = getProjectIdFromPath(projectPath);
+    
+    if (isLoggedIn() && currentProjectFile.existsAsFile() && !currentUserId.isEmpty() && !projectId.isEmpty())
+        pushChannel->subscribe(serverUrl, projectId, currentUserId, authToken);
+    else
+        pushChannel->unsubscribe();
+}
+
+void ColDawExportProcessor::webNotificationReceived(const juce::var& response)
+{
+    stateChanged();
+    
+    bool hasUpdate = response.getProperty("hasUpdate", false);
+    
+    if (hasUpdate && !hasPendingWebUpdate)
+    {
+        // New update available from web push!
+        auto* notification = response.getProperty("notification", {}).getDynamicObject();
+        if (notification)
+        {
+            webUpdateProjectId = notification->getProperty("projectId").toString();
+            webUpdateVersionId = notification->getProperty("versionId").toString();
+            hasPendingWebUpdate = true;
+            
+            // Automatically fetch and preview when notification is from web
+            statusLog.post(Severity::info, Operation::update, "New update pushed from web! Fetching...");
+            fetchWebUpdate();
+        }
+    }
+}
+
 void ColDawExportProcessor::checkForWebUpdates()
 {
     if (!isLoggedIn() || projectPath.isEmpty() || currentUserId.isEmpty())
         return;
     
     // Extract project ID from project path (format: /project/PROJECT_ID)
-    juce::String projectId;
-    if (projectPath.startsWith("/project/"))
-    {
-        projectId = projectPath.substring(9);  // Skip "/project/"
-        
-        // Remove any trailing path
-        int slashPos = projectId.indexOf("/");
-        if (slashPos > 0)
-            projectId = projectId.substring(0, slashPos);
-    }
-    else
-    {
+    juce::String projectId = getProjectIdFromPath(projectPath);
+    if (projectId.isEmpty())
         return;  // Not a valid project path
-    }
     
     // Check for notification
-    juce::URL url(serverUrl + "/api/projects/" + projectId + "/check-vst-notification/" + currentUserId);
-    
-    juce::StringPairArray responseHeaders;
-    int statusCode = 0;
-    
-    juce::URL::InputStreamOptions options = juce::URL::InputStreamOptions(juce::URL::ParameterHandling::inAddress)
-        .withConnectionTimeoutMs(5000)
-        .withResponseHeaders(&responseHeaders)
-        .withStatusCode(&statusCode)
-        .withHttpRequestCmd("GET");
-    
-    std::unique_ptr<juce::InputStream> stream(url.createInputStream(options));
+    ColDawHttpClient::Request request;
+    request.url = juce::URL(serverUrl + "/api/projects/" + projectId + "/check-vst-notification/" + currentUserId);
+    request.connectionTimeoutMs = 5000;
     
-    if (stream != nullptr && statusCode == 200)
+    backgroundRequests->perform(request, {}, [this](const ColDawHttpClient::Response& result)
     {
-        juce::String response = stream->readEntireStreamAsString();
-        auto json = juce::JSON::parse(response);
-        
-        if (auto* obj = json.getDynamicObject())
-        {
-            bool hasUpdate = obj->getProperty("hasUpdate");
-            
-            if (hasUpdate && !hasPendingWebUpdate)
-            {
-                // New update available from web push!
-                auto* notification = obj->getProperty("notification").getDynamicObject();
-                if (notification)
-                {
-                    webUpdateProjectId = notification->getProperty("projectId").toString();
-                    webUpdateVersionId = notification->getProperty("versionId").toString();
-                    hasPendingWebUpdate = true;
-                    
-                    // Automatically fetch and preview when notification is from web
-                    statusMessage = "New update pushed from web! Fetching...";
-                    fetchWebUpdate();
-                }
-            }
-        }
-    }
+        if (result.statusCode == 200)
+            webNotificationReceived(result.getJson());
+    });
 }
 
 void ColDawExportProcessor::fetchWebUpdate()
 {
+    stateChanged();
+    
+    if (isDownloadingUpdate())
+    {
+        statusLog.post(Severity::warning, Operation::update, "Update download already in progress...");
+        return;
+    }
+    
     // If no pending notification, fetch latest version from web
     if (!hasPendingWebUpdate || webUpdateProjectId.isEmpty() || webUpdateVersionId.isEmpty())
     {
         if (!isLoggedIn() || projectPath.isEmpty() || currentUserId.isEmpty())
         {
-            statusMessage = "Please login and select a project first";
+            statusLog.post(Severity::warning, Operation::update, "Please login and select a project first");
             return;
         }
         
         // Extract project ID from project path
-        juce::String projectId;
-        if (projectPath.startsWith("/project/"))
-        {
-            projectId = projectPath.substring(9);
-            int slashPos = projectId.indexOf("/");
-            if (slashPos > 0)
-                projectId = projectId.substring(0, slashPos);
-        }
-        else
+        juce::String projectId = getProjectIdFromPath(projectPath);
+        if (projectId.isEmpty())
         {
-            statusMessage = "Invalid project path";
+            statusLog.post(Severity::error, Operation::update, "Invalid project path");
             return;
         }
         
-        statusMessage = "Checking for latest version...";
+        statusLog.post(Severity::progress, Operation::update, "Checking for latest version...");
         
         // Get latest version info from server
-        juce::URL infoUrl(serverUrl + "/api/projects/" + projectId);
-        juce::StringPairArray infoHeaders;
-        int infoStatusCode = 0;
-        
-        juce::URL::InputStreamOptions infoOptions = juce::URL::InputStreamOptions(juce::URL::ParameterHandling::inAddress)
-            .withConnectionTimeoutMs(10000)
-            .withResponseHeaders(&infoHeaders)
-            .withStatusCode(&infoStatusCode)
-            .withHttpRequestCmd("GET");
+        ColDawHttpClient::Request infoRequest;
+        infoRequest.url = juce::URL(serverUrl + "/api/projects/" + projectId);
+        infoRequest.connectionTimeoutMs = 10000;
         
-        std::unique_ptr<juce::InputStream> infoStream(infoUrl.createInputStream(infoOptions));
-        
-        if (infoStream != nullptr && infoStatusCode == 200)
+        // Looked up in the background; with a version to fetch, this starts over
+        backgroundRequests->perform(infoRequest, {}, [this, projectId](const ColDawHttpClient::Response& infoResult)
         {
-            juce::String response = infoStream->readEntireStreamAsString();
-            auto json = juce::JSON::parse(response);
-            
-            if (auto* obj = json.getDynamicObject())
+            if (infoResult.statusCode == 200 && !hasPendingWebUpdate)
             {
-                if (auto* versionsArray = obj->getProperty("versions").getArray())
+                auto json = infoResult.getJson();
+                
+                if (auto* obj = json.getDynamicObject())
                 {
-                    if (versionsArray->size() > 0)
+                    if (auto* versionsArray = obj->getProperty("versions").getArray())
                     {
-                        // Get the latest version (first in array)
-                        auto* latestVersion = (*versionsArray)[0].getDynamicObject();
-                        if (latestVersion)
+                        if (versionsArray->size() > 0)
                         {
-                            webUpdateProjectId = projectId;
-                            webUpdateVersionId = latestVersion->getProperty("id").toString();
-                            hasPendingWebUpdate = true;
+                            // Get the latest version (first in array)
+                            auto* latestVersion = (*versionsArray)[0].getDynamicObject();
+                            if (latestVersion)
+                            {
+                                webUpdateProjectId = projectId;
+                                webUpdateVersionId = latestVersion->getProperty("id").toString();
+                                hasPendingWebUpdate = true;
+                            }
                         }
                     }
                 }
             }
-        }
-        
-        if (!hasPendingWebUpdate)
-        {
-            statusMessage = "No versions available on server";
-            return;
-        }
+            
+            if (!hasPendingWebUpdate)
+            {
+                stateChanged();
+                statusLog.post(Severity::warning, Operation::update, "No versions available on server");
+                return;
+            }
+            
+            fetchWebUpdate();
+        });
+        return;
     }
     
-    statusMessage = "Fetching update preview...";
+    statusLog.post(Severity::progress, Operation::update, "Fetching update preview...");
     
-    // Download the update file to a temporary location
-    juce::URL url(serverUrl + "/api/versions/" + webUpdateProjectId + "/download/" + webUpdateVersionId);
+    // Downloaded in the background; what an earlier attempt got (even before
+    // a host restart) is kept and only the rest is fetched
+    downloadedUpdateFile = getUpdateDownloadDirectory().getChildFile("coldaw_preview_" + webUpdateVersionId + ".als");
+    downloadedUpdateFile.getParentDirectory().createDirectory();
     
-    juce::StringPairArray responseHeaders;
-    int statusCode = 0;
-    
-    juce::URL::InputStreamOptions options = juce::URL::InputStreamOptions(juce::URL::ParameterHandling::inAddress)
-        .withConnectionTimeoutMs(30000)
-        .withResponseHeaders(&responseHeaders)
-        .withStatusCode(&statusCode)
-        .withHttpRequestCmd("GET");
-    
-    std::unique_ptr<juce::InputStream> stream(url.createInputStream(options));
-    
-    if (stream != nullptr && statusCode == 200)
-    {
-        // Save to temporary preview file
-        juce::File tempDir = juce::File::getSpecialLocation(juce::File::tempDirectory);
-        downloadedUpdateFile = tempDir.getChildFile("coldaw_preview_" + webUpdateVersionId + ".als");
-        
-        juce::FileOutputStream output(downloadedUpdateFile);
-        if (output.openedOk())
-        {
-            output.writeFromInputStream(*stream, -1);
-            output.flush();
-            
-            // Generate preview info
-            juce::int64 fileSize = downloadedUpdateFile.getSize();
-            juce::String sizeStr = juce::String(fileSize / 1024) + " KB";
-            
-            updatePreview = "Update Preview:\n";
-            updatePreview += "Version ID: " + webUpdateVersionId.substring(0, 8) + "...\n";
-            updatePreview += "File Size: " + sizeStr + "\n";
-            updatePreview += "Downloaded: " + juce::Time::getCurrentTime().toString(true, true) + "\n\n";
-            updatePreview += "Click 'Confirm Updates' to apply this version to your project.";
-            
-            updatePreviewed = true;
-            statusMessage = "Update fetched! Review and click 'Confirm Updates' to apply.";
-            webUpdateInfo = "Update ready to apply";
-        }
-        else
-        {
-            statusMessage = "Error: Failed to save preview file";
-        }
-    }
-    else
-    {
-        statusMessage = "Error: Failed to fetch update (Status: " + juce::String(statusCode) + ")";
-    }
+    updateDownloadStarted = juce::Time::getMillisecondCounterHiRes();
+    previewDownloadId = downloader->start(makeUpdateRequest(downloadedUpdateFile));
 }
 
 void ColDawExportProcessor::confirmWebUpdate()
 {
+    stateChanged();
+    
+    if (isDownloadingUpdate())
+    {
+        statusLog.post(Severity::warning, Operation::update, "Update download already in progress...");
+        return;
+    }
+    
     // If we already have a previewed update, use that file
     if (updatePreviewed && downloadedUpdateFile.existsAsFile())
     {
-        statusMessage = "Applying previewed update...";
+        statusLog.post(Severity::progress, Operation::update, "Applying previewed update...");
         
-        // Create temporary file for the update
-        juce::File updateFile = currentProjectFile.getSiblingFile(
-            currentProjectFile.getFileNameWithoutExtension() + "_web_update.als"
-        );
+        // Copy the previewed file next to the project, then swap it in
+        juce::File updateFile = getWebUpdateFile();
         
-        // Copy the previewed file to the update location
         if (downloadedUpdateFile.copyFileTo(updateFile))
         {
-            // Replace current file with update
-            if (currentProjectFile.deleteFile())
-            {
-                if (updateFile.moveFileTo(currentProjectFile))
-                {
-                    statusMessage = "Web update applied successfully! Reopen your project in DAW.";
-                    
-                    // Update last modification time to prevent auto-export
-                    lastModificationTime = currentProjectFile.getLastModificationTime();
-                    
-                    // Clean up preview file
-                    downloadedUpdateFile.deleteFile();
-                    
-                    // Reset all update states
-                    hasPendingWebUpdate = false;
-                    webUpdateInfo = "";
-                    webUpdateProjectId = "";
-                    webUpdateVersionId = "";
-                    updatePreviewed = false;
-                    updatePreview = "";
-                }
-                else
-                {
-                    statusMessage = "Error: Failed to replace project file";
-                }
-            }
-            else
+            if (replaceProjectFile(updateFile, downloadedUpdateHash))
             {
-                statusMessage = "Error: Failed to delete old project file";
+                // Clean up preview file
+                downloadedUpdateFile.deleteFile();
+                updatePreviewed = false;
+                updatePreview = "";
             }
         }
         else
         {
-            statusMessage = "Error: Failed to copy preview file";
+            statusLog.post(Severity::error, Operation::update, "Error: Failed to copy preview file");
         }
         
         return;
@@ -974,73 +1223,214 @@ void ColDawExportProcessor::confirmWebUpdate()
     // If no preview exists, download directly
     if (!hasPendingWebUpdate || webUpdateProjectId.isEmpty() || webUpdateVersionId.isEmpty())
     {
-        statusMessage = "No web update available";
+        statusLog.post(Severity::warning, Operation::update, "No web update available");
         return;
     }
     
-    statusMessage = "Downloading web update...";
+    statusLog.post(Severity::progress, Operation::update, "Downloading web update...");
     
-    // Request the update and download the file
-    juce::URL url(serverUrl + "/api/projects/" + webUpdateProjectId + "/confirm-vst-update/" + currentUserId);
+    // Download next to the project in the background; the notification is
+    // cleared once the file has arrived intact
+    updateDownloadStarted = juce::Time::getMillisecondCounterHiRes();
+    applyDownloadId = downloader->start(makeUpdateRequest(getWebUpdateFile()));
+}
+
+void ColDawExportProcessor::downloadProgress(const ColDawDownloader::Progress& progress)
+{
+    stateChanged();
     
-    juce::StringPairArray responseHeaders;
-    int statusCode = 0;
+    juce::String message = (progress.downloadId == previewDownloadId ? "Fetching update preview... "
+                                                                     : "Downloading web update... ")
+                         + juce::File::descriptionOfSizeInBytes(progress.received);
     
-    juce::URL::InputStreamOptions options = juce::URL::InputStreamOptions(juce::URL::ParameterHandling::inAddress)
-        .withConnectionTimeoutMs(30000)
-        .withResponseHeaders(&responseHeaders)
-        .withStatusCode(&statusCode)
-        .withHttpRequestCmd("POST");
+    if (progress.total > 0)
+        message += " of " + juce::File::descriptionOfSizeInBytes(progress.total)
+                 + " (" + juce::String(progress.received * 100 / progress.total) + "%)";
     
-    std::unique_ptr<juce::InputStream> stream(url.createInputStream(options));
+    statusLog.post(Severity::progress, Operation::update, message);
+}
+
+void ColDawExportProcessor::downloadFinished(const ColDawDownloader::Result& result)
+{
+    stateChanged();
+    
+    const double seconds = (juce::Time::getMillisecondCounterHiRes() - updateDownloadStarted) / 1000.0;
     
-    if (stream != nullptr && statusCode == 200)
+    if (result.downloadId == previewDownloadId)
     {
-        // Save the downloaded file
-        juce::File updateFile = currentProjectFile.getSiblingFile(
-            currentProjectFile.getFileNameWithoutExtension() + "_web_update.als"
-        );
+        previewDownloadId = 0;
         
-        juce::FileOutputStream output(updateFile);
-        if (output.openedOk())
+        if (!result.succeeded())
         {
-            output.writeFromInputStream(*stream, -1);
-            output.flush();
-            
-            // Replace current file with update
-            if (currentProjectFile.deleteFile())
-            {
-                if (updateFile.moveFileTo(currentProjectFile))
-                {
-                    statusMessage = "Web update applied successfully! Reopen your project in DAW.";
-                    
-                    // Update last modification time to prevent auto-export
-                    lastModificationTime = currentProjectFile.getLastModificationTime();
-                    
-                    hasPendingWebUpdate = false;
-                    webUpdateInfo = "";
-                    webUpdateProjectId = "";
-                    webUpdateVersionId = "";
-                }
-                else
-                {
-                    statusMessage = "Error: Failed to replace project file";
-                }
-            }
-            else
-            {
-                statusMessage = "Error: Failed to delete old project file";
-            }
+            statusLog.post(Severity::error, Operation::update, "Error: Failed to fetch update - " + result.errorMessage, seconds);
+            return;
+        }
+        
+        // Generate preview info
+        juce::String sizeStr = juce::String(result.size / 1024) + " KB";
+        
+        updatePreviewHeader = "Update Preview:\n";
+        updatePreviewHeader += "Version ID: " + webUpdateVersionId.substring(0, 8) + "...\n";
+        updatePreviewHeader += "File Size: " + sizeStr + (result.verified ? " (checksum verified)" : "") + "\n";
+        
+        if (result.patched)
+            updatePreviewHeader += "Transfer: changes only (patched from your version)\n";
+        
+        updatePreviewHeader += "Downloaded: " + juce::Time::getCurrentTime().toString(true, true) + "\n";
+        
+        // What the update changes compared to the local set is worked out in the background
+        if (currentProjectFile.existsAsFile())
+        {
+            setUpdatePreviewChanges("Comparing with your version...");
+            changePreview->preview(currentProjectFile, result.target, webUpdateVersionId);
         }
         else
         {
-            statusMessage = "Error: Failed to save update file";
+            setUpdatePreviewChanges({});
         }
+        
+        downloadedUpdateHash = result.sha256;
+        updatePreviewed = true;
+        statusLog.post(Severity::success, Operation::update, "Update fetched! Review and click 'Confirm Updates' to apply.", seconds);
+        webUpdateInfo = "Update ready to apply";
     }
+    else if (result.downloadId == applyDownloadId)
+    {
+        applyDownloadId = 0;
+        
+        if (!result.succeeded())
+        {
+            statusLog.post(Severity::error, Operation::update, "Error: Failed to download update - " + result.errorMessage, seconds);
+            return;
+        }
+        
+        // We have the file, so the server can drop the notification
+        ColDawHttpClient::Request request;
+        request.url = juce::URL(serverUrl + "/api/projects/" + webUpdateProjectId + "/confirm-vst-update/" + currentUserId)
+                          .withParameter("download", "false");
+        request.method = "POST";
+        request.connectionTimeoutMs = 10000;
+        backgroundRequests->perform(request, {}, nullptr);
+        
+        replaceProjectFile(result.target, result.sha256);
+    }
+}
+
+ColDawDownloader::Request ColDawExportProcessor::makeUpdateRequest(const juce::File& target)
+{
+    ColDawDownloader::Request request;
+    request.url = juce::URL(serverUrl + "/api/versions/" + webUpdateProjectId + "/download/" + webUpdateVersionId);
+    request.authToken = authToken;
+    request.target = target;
+    
+    // These are the version's exact bytes, so semantic uploads needn't download it
+    if (semanticUploads)
+        request.cacheCopy = getBaseCacheDirectory().getChildFile(webUpdateVersionId + ".als");
+    
+    // If we have the version this file is based on, the server only needs to
+    // send what changed since; it refuses if our copy isn't that version
+    auto base = baseVersionMapping.find(currentProjectFile.getFullPathName());
+    
+    if (base != baseVersionMapping.end() && base->second != webUpdateVersionId)
+    {
+        juce::File cachedBase = getBaseCacheDirectory().getChildFile(base->second + ".als");
+        
+        request.patchBase = cachedBase.existsAsFile() ? cachedBase : currentProjectFile;
+        request.patchUrl = juce::URL(serverUrl + "/api/versions/" + webUpdateProjectId + "/patch/" + webUpdateVersionId)
+                               .withParameter("base", base->second);
+    }
+    
+    return request;
+}
+
+void ColDawExportProcessor::changePreviewReady(const ColDawChangePreview::Result& result)
+{
+    stateChanged();
+    
+    // Only the update still on offer is of interest
+    if (!updatePreviewed || result.versionId != webUpdateVersionId)
+        return;
+    
+    if (!result.succeeded)
+        setUpdatePreviewChanges("Changes: could not compare with your version");
+    else if (result.changes.isEmpty())
+        setUpdatePreviewChanges("Changes: no track, clip, device or tempo changes");
     else
+        setUpdatePreviewChanges("Changes:\n" + result.changes.joinIntoString("\n"));
+}
+
+void ColDawExportProcessor::setUpdatePreviewChanges(const juce::String& changes)
+{
+    updatePreview = updatePreviewHeader;
+    
+    if (changes.isNotEmpty())
+        updatePreview += "\n" + changes + "\n";
+    
+    updatePreview += "\nClick 'Confirm Updates' to apply this version to your project.";
+}
+
+juce::File ColDawExportProcessor::getWebUpdateFile() const
+{
+    return currentProjectFile.getSiblingFile(currentProjectFile.getFileNameWithoutExtension() + "_web_update.als");
+}
+
+bool ColDawExportProcessor::replaceProjectFile(const juce::File& updateFile, const juce::String& sha256)
+{
+    if (!currentProjectFile.deleteFile())
     {
-        statusMessage = "Error: Failed to download update (Status: " + juce::String(statusCode) + ")";
+        statusLog.post(Severity::error, Operation::update, "Error: Failed to delete old project file");
+        return false;
     }
+    
+    if (!updateFile.moveFileTo(currentProjectFile))
+    {
+        statusLog.post(Severity::error, Operation::update, "Error: Failed to replace project file");
+        return false;
+    }
+    
+    statusLog.post(Severity::success, Operation::update, "Web update applied successfully! Reopen your project in DAW.");
+    
+    // The watcher reports the replacement as a write; this keeps it from being auto-exported
+    lastModificationTime = currentProjectFile.getLastModificationTime();
+    exportedModificationTime = lastModificationTime;
+    rememberAppliedVersion(webUpdateVersionId, sha256);
+    
+    // Reset all update states
+    hasPendingWebUpdate = false;
+    webUpdateInfo = "";
+    webUpdateProjectId = "";
+    webUpdateVersionId = "";
+    return true;
+}
+
+void ColDawExportProcessor::rememberAppliedVersion(const juce::String& versionId, const juce::String& sha256)
+{
+    // The local file now matches this server version, so it becomes the base
+    // for the next upload, and exporting it unchanged would send nothing new.
+    // The downloader hashed the file as it saved it.
+    juce::String fileKey = currentProjectFile.getFullPathName();
+    baseVersionMapping[fileKey] = versionId;
+    
+    if (sha256.isNotEmpty())
+        uploadedHashMapping[fileKey] = sha256;
+    else
+        uploadedHashMapping.erase(fileKey);
+    
+    saveProjectMapping();
+}
+
+juce::File ColDawExportProcessor::getBaseCacheDirectory()
+{
+    return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+        .getChildFile("ColDaw")
+        .getChildFile("base_cache");
+}
+
+juce::File ColDawExportProcessor::getUpdateDownloadDirectory()
+{
+    return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+        .getChildFile("ColDaw")
+        .getChildFile("downloads");
 }
 
 //==============================================================================
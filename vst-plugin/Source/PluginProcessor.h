@@ -2,6 +2,19 @@
 
 #include <juce_audio_processors/juce_audio_processors.h>
 #include <map>
+#include "UploadEngine.h"
+#include "ProjectWatcher.h"
+#include "ProjectIndex.h"
+#include "ProjectMetadata.h"
+#include "SaveDetector.h"
+#include "PushChannel.h"
+#include "BackgroundRequests.h"
+#include "SampleSync.h"
+#include "Downloader.h"
+#include "ChangePreview.h"
+#include "HttpClient.h"
+#include "StatusLog.h"
+#include "AudioCapture.h"
 
 //==============================================================================
 /**
@@ -12,7 +25,18 @@
  * to the ColDaw server.
  */
 class ColDawExportProcessor : public juce::AudioProcessor,
-                                public juce::Timer
+                                public juce::Timer,
+                                public juce::ChangeBroadcaster,
+                                private juce::AsyncUpdater,
+                                private ColDawUploadEngine::Listener,
+                                private ColDawProjectWatcher::Listener,
+                                private ColDawSaveDetector::Listener,
+                                private ColDawPushChannel::Listener,
+                                private ColDawSampleSync::Listener,
+                                private ColDawProjectMetadata::Listener,
+                                private ColDawStatusLog::Listener,
+                                private ColDawDownloader::Listener,
+                                private ColDawChangePreview::Listener
 {
 public:
     //==============================================================================
@@ -61,7 +85,8 @@ public:
     void setCurrentProjectFile(const juce::File& file);
     void detectCurrentProject();
     
-    juce::String getStatusMessage() const { return statusMessage; }
+    juce::String getStatusMessage() const { return statusLog.getLatest().message; }
+    const ColDawStatusLog& getStatusLog() const { return statusLog; }  // Message thread only
     juce::String getCurrentProjectName() const { 
         return currentProjectFile.existsAsFile() ? 
                currentProjectFile.getFileNameWithoutExtension() : 
@@ -80,47 +105,126 @@ public:
     void setUserId(const juce::String& id) { userId = id; }
     void setAuthor(const juce::String& name) { author = name; }
     void setAutoExport(bool enable) { autoExport = enable; }
+    void setMinimumExportInterval(int seconds) { saveDetector->setMinimumInterval(juce::RelativeTime::seconds(seconds)); }
+    void setDeltaUploads(bool enable) { deltaUploads = enable; }
+    void setSemanticUploads(bool enable) { semanticUploads = enable; }
+    void setZstdTransport(bool enable) { zstdTransport = enable; }
+    void setSampleUploads(bool enable) { sampleUploads = enable; }
+    void setAudioCapture(bool enable) { audioCapture->setEnabled(enable); }
+    void setProjectSkipRules(juce::StringArray rules) { rules.removeEmptyStrings(); projectIndex.setSkipRules(rules); }
     
     juce::String getUserId() const { return userId; }
     juce::String getAuthor() const { return author; }
     bool getAutoExport() const { return autoExport; }
+    int getMinimumExportInterval() const { return (int) saveDetector->getMinimumInterval().inSeconds(); }
+    bool getDeltaUploads() const { return deltaUploads; }
+    bool getSemanticUploads() const { return semanticUploads; }
+    bool getZstdTransport() const { return zstdTransport; }
+    bool getSampleUploads() const { return sampleUploads; }
+    bool getAudioCapture() const { return audioCapture->isEnabled(); }
+    bool canUseZstdTransport() const { return ColDawTransportCodec::isAvailable(); }
+    juce::StringArray getProjectSkipRules() const { return projectIndex.getSkipRules(); }
     
     juce::File getDetectedFile() const { return detectedProjectFile; }
     void useDetectedFile();
     
     juce::String getProjectPath() const { return projectPath; }
-    void setProjectPath(const juce::String& path) { projectPath = path; saveProjectMapping(); }
+    void setProjectPath(const juce::String& path) { projectPath = path; saveProjectMapping(); stateChanged(); }
     void loadProjectMapping();
     void saveProjectMapping();
     
-    // VST Bridge - check for updates from web
-    void checkForWebUpdates();
+    // VST Bridge - updates pushed from web
+    void checkForWebUpdates();  // One-off check; pushes normally arrive through pushChannel
     void fetchWebUpdate();  // Manually fetch and preview update
     void confirmWebUpdate();
     bool hasWebUpdate() const { return hasPendingWebUpdate; }
     bool hasPreviewedUpdate() const { return updatePreviewed; }
+    bool isDownloadingUpdate() const { return previewDownloadId != 0 || applyDownloadId != 0; }
     bool canFetchUpdates() const { return isLoggedIn() && !projectPath.isEmpty(); }
     juce::String getWebUpdateInfo() const { return webUpdateInfo; }
     juce::String getUpdatePreview() const { return updatePreview; }
+    juce::String getNetworkTimingSummary() const { return httpClient->getTimingSummary(); }
+    
+    // Project metadata - answered from the local index, without reading the set
+    ColDawProjectMetadata::Project getProjectMetadata(const juce::File& alsFile) const { return projectMetadata->getProject(alsFile); }
+    ColDawProjectMetadata::Project getCurrentProjectMetadata() const { return projectMetadata->getProject(currentProjectFile); }
+    juce::Array<juce::File> getIndexedProjects() const { return projectMetadata->getProjects(); }
+    juce::Array<juce::File> findProjectsUsingDevice(const juce::String& name) const { return projectMetadata->findProjectsUsingDevice(name); }
+    juce::Array<juce::File> findProjectsUsingSample(const juce::File& sample) const { return projectMetadata->findProjectsUsingSample(sample); }
+    
+    // Editor state - a snapshot of everything the editor shows. Change listeners
+    // are told (on the message thread) only when some of it actually changed.
+    struct EditorState
+    {
+        juce::uint32 version = 0;  // Goes up by one with every change
+        
+        juce::String statusMessage;  // Latest status event
+        ColDawStatusLog::Severity statusSeverity = ColDawStatusLog::Severity::info;
+        juce::uint32 statusEventId = 0;  // Changes with every event added to the status history
+        bool loggedIn = false;
+        juce::String username;
+        juce::String projectName;  // "None" without a project
+        juce::String projectSummary;  // From the metadata index
+        juce::String projectPath;
+        bool hasDetectedFile = false;
+        bool canFetchUpdates = false;
+        bool previewedUpdate = false;
+        juce::String updatePreview;
+        
+        bool hasSameContent(const EditorState& other) const;
+    };
+    
+    const EditorState& getEditorState() const { return editorState; }
 
 private:
     //==============================================================================
     void uploadProjectFile(const juce::File& alsFile);
+    void uploadFinished(const ColDawUploadEngine::Result& result) override;
+    void handleUploadResult(const ColDawUploadEngine::Result& result);
+    void samplesSynced(const ColDawSampleSync::Result& result) override;
+    void projectFileWritten(const juce::File& file) override;
+    void projectsIndexed(const juce::File& root) override;
+    void exportIfProjectSaved();
+    void saveCompleted(const juce::File& file) override;
     void openProjectInBrowser(const juce::String& projectId, bool fromVST = false);
+    static juce::String getProjectIdFromPath(const juce::String& path);
+    void rememberAppliedVersion(const juce::String& versionId, const juce::String& sha256);
+    static juce::File getBaseCacheDirectory();
+    static juce::File getUpdateDownloadDirectory();
+    ColDawDownloader::Request makeUpdateRequest(const juce::File& target);
+    juce::File getWebUpdateFile() const;
+    bool replaceProjectFile(const juce::File& updateFile, const juce::String& sha256);
+    void downloadProgress(const ColDawDownloader::Progress& progress) override;
+    void downloadFinished(const ColDawDownloader::Result& result) override;
+    void changePreviewReady(const ColDawChangePreview::Result& result) override;
+    void setUpdatePreviewChanges(const juce::String& changes);
+    void updatePushSubscription();
+    void webNotificationReceived(const juce::var& response) override;
+    void projectIndexed(const juce::File& alsFile) override;
+    void statusLogChanged() override;
+    void stateChanged();
+    void handleAsyncUpdate() override;
+    EditorState makeEditorState() const;
     
-    // Helper function for finding recent .als files
-    void findMostRecentALSFile(const juce::File& directory, 
-                               juce::File& mostRecentFile, 
+    // Helper function for finding recent .als files (via projectIndex)
+    void findMostRecentALSFile(juce::File& mostRecentFile, 
                                juce::Time& mostRecentTime,
                                const juce::Time& minimumTime);
     
     // State
-    juce::String statusMessage;
+    ColDawStatusLog statusLog { *this };  // Status events from any thread, with recent history
     juce::File detectedProjectFile;  // Auto-detected file
     juce::String projectPath;  // User-entered project path
     std::map<juce::String, juce::String> filePathMapping;  // Maps ALS file hash to project path
+    std::map<juce::String, juce::String> uploadedHashMapping;  // Maps ALS file path to SHA-256 of the bytes the server last had from us
+    std::map<juce::String, juce::String> baseVersionMapping;  // Maps ALS file path to the server version it is based on
     bool exporting;
+    bool exportQueued;  // A save completed while an upload was still running
     bool autoExport;
+    bool deltaUploads;  // Send only the changed blocks when the server has our base version
+    bool semanticUploads;  // Send an XML edit script against our base version instead
+    bool zstdTransport;  // Send full uploads zstd-compressed with the shipped dictionary
+    bool sampleUploads;  // After an upload, send the referenced samples the server doesn't have
     
     // Authentication
     juce::String username;
@@ -129,13 +233,18 @@ private:
     
     // Settings
     juce::String serverUrl;
+    juce::SharedResourcePointer<ColDawHttpClient> httpClient;  // Shared by all plugin instances
     juce::String userId;
     juce::String author;
     
     // File watching
     juce::File currentProjectFile;
-    juce::Time lastModificationTime;
+    juce::Time lastModificationTime;  // Latest mtime of the current file handed to the save detector
+    juce::Time exportedModificationTime;  // Saves of the current file up to this mtime are exported, applied or were there on selection
     bool fileWatcherActive;
+    juce::File lastWrittenProjectFile;  // Most recent .als save reported by the watcher
+    ColDawProjectIndex projectIndex { juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+                                          .getChildFile("ColDaw").getChildFile("project_index.json") };
     
     // VST Bridge - web to DAW updates
     bool hasPendingWebUpdate;
@@ -144,10 +253,26 @@ private:
     juce::String webUpdateProjectId;
     juce::String webUpdateVersionId;
     juce::String updatePreview;  // Preview information about the update
+    juce::String updatePreviewHeader;  // Version, size and download details at the top of the preview
     juce::File downloadedUpdateFile;  // Temporary file with downloaded update
+    juce::String downloadedUpdateHash;  // SHA-256 of downloadedUpdateFile
+    int previewDownloadId = 0;  // Download in progress for fetchWebUpdate, if any
+    int applyDownloadId = 0;  // Download in progress for confirmWebUpdate, if any
+    double updateDownloadStarted = 0.0;  // Millisecond counter when the current download started
+    
+    EditorState editorState;  // Last published
     
-    // HTTP
-    std::unique_ptr<juce::URL::DownloadTask> currentUpload;
+    // Background workers - declared last so they stop before the state they report into
+    std::unique_ptr<ColDawProjectWatcher> projectWatcher;
+    std::unique_ptr<ColDawSaveDetector> saveDetector;
+    std::unique_ptr<ColDawUploadEngine> uploadEngine;
+    std::unique_ptr<ColDawSampleSync> sampleSync;
+    std::unique_ptr<ColDawProjectMetadata> projectMetadata;
+    std::unique_ptr<ColDawDownloader> downloader;
+    std::unique_ptr<ColDawChangePreview> changePreview;
+    std::unique_ptr<ColDawPushChannel> pushChannel;
+    std::unique_ptr<ColDawBackgroundRequests> backgroundRequests;
+    std::unique_ptr<ColDawAudioCapture> audioCapture;
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ColDawExportProcessor)
 };
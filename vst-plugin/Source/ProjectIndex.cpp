@@ -0,0 +1,293 @@
+#include "ProjectIndex.h"
+#include <utility>
+
+namespace
+{
+    constexpr int formatVersion = 1;
+}
+
+//==============================================================================
+ColDawProjectIndex::ColDawProjectIndex (const juce::File& file)
+    : indexFile (file),
+      skipRules (getDefaultSkipRules())
+{
+    load();
+}
+
+juce::StringArray ColDawProjectIndex::getDefaultSkipRules()
+{
+    // Live's per-save copies, sample folders (recordings, freezes, the User
+    // Library's sample collection) and the per-project icon folder
+    return { "Backup", "Samples", "Ableton Project Info", ".*" };
+}
+
+void ColDawProjectIndex::setSkipRules (const juce::StringArray& rules)
+{
+    {
+        const juce::ScopedLock sl (lock);
+
+        if (rules == skipRules)
+            return;
+
+        // Cleared by the next refresh, which may be running right now
+        skipRules = rules;
+        listedWithOtherRules = true;
+    }
+
+    save();
+}
+
+juce::StringArray ColDawProjectIndex::getSkipRules() const
+{
+    const juce::ScopedLock sl (lock);
+    return skipRules;
+}
+
+//==============================================================================
+void ColDawProjectIndex::refresh (const juce::File& root, bool recursive, juce::Array<juce::File>* written)
+{
+    const juce::ScopedLock refreshing (refreshLock);
+    bool changed = false;
+
+    {
+        const juce::ScopedLock sl (lock);
+
+        if (std::exchange (listedWithOtherRules, false))
+        {
+            directories.clear();
+            changed = true;
+        }
+    }
+
+    std::set<juce::String> visited;
+    changed = (root.isDirectory() && update (root, root, recursive, visited, written)) || changed;
+
+    // Forget directories below this root that were removed or are now skipped
+    if (recursive)
+    {
+        const auto rootPath = root.getFullPathName();
+        const auto below = rootPath + juce::File::getSeparatorString();
+        const juce::ScopedLock sl (lock);
+
+        for (auto it = directories.begin(); it != directories.end();)
+        {
+            if (visited.count (it->first) == 0 && (it->first == rootPath || it->first.startsWith (below)))
+            {
+                it = directories.erase (it);
+                changed = true;
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    if (changed)
+        save();
+}
+
+bool ColDawProjectIndex::update (const juce::File& directory, const juce::File& root, bool recursive,
+                                 std::set<juce::String>& visited, juce::Array<juce::File>* written)
+{
+    const auto path = directory.getFullPathName();
+    const auto modified = directory.getLastModificationTime().toMilliseconds();
+
+    visited.insert (path);
+
+    auto known = directories.find (path);
+    bool changed = false;
+
+    if (known == directories.end() || known->second.modified != modified)
+    {
+        // Entries were added, removed or renamed - list this directory again
+        Directory listing;
+        listing.modified = modified;
+
+        for (const auto& entry : juce::RangedDirectoryIterator (directory, false, "*", juce::File::findFilesAndDirectories))
+        {
+            const auto file = entry.getFile();
+
+            if (entry.isDirectory())
+            {
+                if (! isSkipped (file, root))
+                    listing.subdirectories.add (file.getFileName());
+            }
+            else if (file.hasFileExtension (".als"))
+            {
+                const auto projectModified = entry.getModificationTime().toMilliseconds();
+                listing.projects[file.getFileName()] = projectModified;
+
+                if (written != nullptr)
+                {
+                    const auto* before = known != directories.end() ? &known->second.projects : nullptr;
+
+                    if (before == nullptr || before->count (file.getFileName()) == 0 || before->at (file.getFileName()) != projectModified)
+                        written->add (file);
+                }
+            }
+        }
+
+        const juce::ScopedLock sl (lock);
+        known = directories.insert_or_assign (path, std::move (listing)).first;
+        changed = true;
+    }
+    else
+    {
+        // Saving over an existing .als doesn't touch the directory's mtime
+        for (auto& project : known->second.projects)
+        {
+            const auto projectModified = directory.getChildFile (project.first).getLastModificationTime().toMilliseconds();
+
+            if (projectModified != project.second)
+            {
+                const juce::ScopedLock sl (lock);
+                project.second = projectModified;
+                changed = true;
+
+                if (written != nullptr)
+                    written->add (directory.getChildFile (project.first));
+            }
+        }
+    }
+
+    if (! recursive)
+        return changed;
+
+    // Entries stay put while children are added, so the reference is safe
+    for (auto& name : known->second.subdirectories)
+        changed = update (directory.getChildFile (name), root, true, visited, written) || changed;
+
+    return changed;
+}
+
+bool ColDawProjectIndex::isSkipped (const juce::File& directory, const juce::File& root) const
+{
+    if (directory.isSymbolicLink())
+        return true;
+
+    const auto name = directory.getFileName();
+    const auto relativePath = directory.getRelativePathFrom (root).replaceCharacter ('\\', '/');
+    const juce::ScopedLock sl (lock);
+
+    for (auto& rule : skipRules)
+    {
+        const bool matches = rule.containsChar ('/')
+            ? relativePath.matchesWildcard (rule, true) || relativePath.matchesWildcard ("*/" + rule, true)
+            : name.matchesWildcard (rule, true);
+
+        if (matches)
+            return true;
+    }
+
+    return false;
+}
+
+juce::File ColDawProjectIndex::findMostRecent (const juce::Time& minimumTime, juce::Time& modificationTime) const
+{
+    juce::File mostRecent;
+    auto mostRecentTime = minimumTime.toMilliseconds();
+    const juce::ScopedLock sl (lock);
+
+    for (auto& directory : directories)
+    {
+        for (auto& project : directory.second.projects)
+        {
+            if (project.second > mostRecentTime)
+            {
+                mostRecent = juce::File (directory.first).getChildFile (project.first);
+                mostRecentTime = project.second;
+            }
+        }
+    }
+
+    if (mostRecent != juce::File())
+        modificationTime = juce::Time (mostRecentTime);
+
+    return mostRecent;
+}
+
+//==============================================================================
+void ColDawProjectIndex::load()
+{
+    if (! indexFile.existsAsFile())
+        return;
+
+    auto json = juce::JSON::parse (indexFile);
+
+    if ((int) json.getProperty ("version", 0) != formatVersion)
+        return;
+
+    if (auto* rules = json.getProperty ("skipRules", {}).getArray())
+    {
+        skipRules.clear();
+
+        for (auto& rule : *rules)
+            skipRules.add (rule.toString());
+    }
+
+    if (auto* entries = json.getProperty ("directories", {}).getDynamicObject())
+    {
+        for (auto& entry : entries->getProperties())
+        {
+            Directory directory;
+            directory.modified = (juce::int64) entry.value.getProperty ("modified", 0);
+
+            if (auto* projects = entry.value.getProperty ("projects", {}).getDynamicObject())
+                for (auto& project : projects->getProperties())
+                    directory.projects[project.name.toString()] = (juce::int64) project.value;
+
+            if (auto* subdirectories = entry.value.getProperty ("subdirectories", {}).getArray())
+                for (auto& name : *subdirectories)
+                    directory.subdirectories.add (name.toString());
+
+            directories[entry.name.toString()] = std::move (directory);
+        }
+    }
+}
+
+void ColDawProjectIndex::save() const
+{
+    if (indexFile == juce::File())
+        return;
+
+    auto* entries = new juce::DynamicObject();
+    juce::var entriesVar (entries);
+    auto* index = new juce::DynamicObject();
+    juce::var indexVar (index);
+
+    {
+        const juce::ScopedLock sl (lock);
+
+        index->setProperty ("skipRules", skipRules);
+
+        // Listings made under other rules aren't kept
+        if (! listedWithOtherRules)
+        {
+            for (auto& directory : directories)
+            {
+                auto* projects = new juce::DynamicObject();
+
+                for (auto& project : directory.second.projects)
+                    projects->setProperty (project.first, project.second);
+
+                auto* entry = new juce::DynamicObject();
+                entry->setProperty ("modified", directory.second.modified);
+                entry->setProperty ("projects", juce::var (projects));
+                entry->setProperty ("subdirectories", directory.second.subdirectories);
+                entries->setProperty (directory.first, juce::var (entry));
+            }
+        }
+    }
+
+    index->setProperty ("version", formatVersion);
+    index->setProperty ("directories", entriesVar);
+
+    // Written next to the index and renamed over it, so another plugin instance
+    // never reads a half-written file and the last one to save wins
+    indexFile.getParentDirectory().createDirectory();
+    juce::TemporaryFile temporary (indexFile);
+
+    if (temporary.getFile().replaceWithText (juce::JSON::toString (indexVar, true)))
+        temporary.overwriteTargetFileWithTemporary();
+}
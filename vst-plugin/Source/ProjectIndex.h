@@ -0,0 +1,82 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <map>
+#include <set>
+
+//==============================================================================
+/**
+ * ColDaw Export Plugin - persistent .als index
+ *
+ * Remembers every directory under its roots with its modification time,
+ * the subdirectories worth descending into and the .als files it holds, and
+ * keeps that on disk between sessions. A refresh only lists directories
+ * whose mtime changed (files were added, removed or renamed); everywhere
+ * else it just re-stats the known .als files, which Live may rewrite in
+ * place.
+ *
+ * Directories matching a skip rule are never entered. A rule without a '/'
+ * is a wildcard for the directory name ("Backup"); one with a '/' is
+ * matched against the end of the path below the root ("Samples/Recorded").
+ * Changing the rules drops the saved index, since directories listed under
+ * the old rules may be missing subdirectories. The project watcher uses the
+ * same rules, so it never watches what the index skips.
+ *
+ * Refreshes run on the project watcher's thread, one at a time; the other
+ * methods may be called from any thread and never wait for a refresh to
+ * finish. The index file is replaced atomically, since every plugin
+ * instance keeps it up to date.
+ */
+class ColDawProjectIndex
+{
+public:
+    //==============================================================================
+    /** Without an index file, the index is only kept in memory. */
+    explicit ColDawProjectIndex (const juce::File& indexFile = {});
+
+    /** Brings the index up to date for this root and saves it if anything changed.
+        Without recursive, only the root directory itself is looked at. The .als
+        files that appeared or were modified since the last refresh are added to
+        written, if given.
+    */
+    void refresh (const juce::File& root, bool recursive = true, juce::Array<juce::File>* written = nullptr);
+
+    /** The most recently modified .als seen by the last refresh that is newer
+        than minimumTime, or a default File if there is none.
+    */
+    juce::File findMostRecent (const juce::Time& minimumTime, juce::Time& modificationTime) const;
+
+    /** True if a directory below root is never looked at. */
+    bool isSkipped (const juce::File& directory, const juce::File& root) const;
+
+    /** Takes effect for the next refresh. */
+    void setSkipRules (const juce::StringArray& rules);
+    juce::StringArray getSkipRules() const;
+
+    static juce::StringArray getDefaultSkipRules();
+
+private:
+    //==============================================================================
+    struct Directory
+    {
+        juce::int64 modified = 0;
+        std::map<juce::String, juce::int64> projects;  // .als file name -> modification time
+        juce::StringArray subdirectories;
+    };
+
+    void load();
+    void save() const;
+    bool update (const juce::File& directory, const juce::File& root, bool recursive,
+                 std::set<juce::String>& visited, juce::Array<juce::File>* written);
+
+    juce::File indexFile;
+
+    // Only a refresh changes directories, and it reads them without the lock
+    juce::CriticalSection refreshLock;
+    juce::CriticalSection lock;
+    juce::StringArray skipRules;
+    bool listedWithOtherRules = false;
+    std::map<juce::String, Directory> directories;  // Keyed by full path
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ColDawProjectIndex)
+};
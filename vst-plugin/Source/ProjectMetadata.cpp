@@ -0,0 +1,352 @@
+#include "ProjectMetadata.h"
+#include "AlsReader.h"
+#include "ChangePreview.h"
+#include "SampleSync.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    constexpr int formatVersion = 1;
+
+    juce::String getKey (const juce::File& file)    { return file.getFullPathName(); }
+}
+
+//==============================================================================
+juce::StringArray ColDawProjectMetadata::Project::getDeviceNames() const
+{
+    juce::StringArray names;
+
+    for (auto& track : tracks)
+        for (auto& device : track.devices)
+            names.addIfNotAlreadyThere (device, true);
+
+    names.sortNatural();
+    return names;
+}
+
+juce::String ColDawProjectMetadata::Project::describe() const
+{
+    if (! isValid())
+        return {};
+
+    const auto missing = std::count_if (samples.begin(), samples.end(), [] (const Sample& s) { return s.missing; });
+
+    juce::StringArray parts;
+    parts.add (juce::String ((int) tracks.size()) + (tracks.size() == 1 ? " track" : " tracks"));
+
+    if (tempo > 0.0)
+        parts.add ((tempo == std::floor (tempo) ? juce::String (juce::roundToInt (tempo)) : juce::String (tempo, 2)) + " BPM");
+
+    if (timeSignatureNumerator > 0)
+        parts.add (juce::String (timeSignatureNumerator) + "/" + juce::String (timeSignatureDenominator));
+
+    if (! samples.empty())
+        parts.add (juce::String ((int) samples.size()) + (samples.size() == 1 ? " sample" : " samples")
+                   + (missing > 0 ? " (" + juce::String ((int) missing) + " missing)" : juce::String()));
+
+    return parts.joinIntoString (", ");
+}
+
+//==============================================================================
+ColDawProjectMetadata::ColDawProjectMetadata (Listener& l, const juce::File& file)
+    : juce::Thread ("ColDaw Project Metadata"),
+      listener (l),
+      indexFile (file)
+{
+    load();
+    startThread (juce::Thread::Priority::background);
+}
+
+ColDawProjectMetadata::~ColDawProjectMetadata()
+{
+    stopThread (10000);
+    cancelPendingUpdate();
+}
+
+void ColDawProjectMetadata::update (const juce::File& alsFile)
+{
+    {
+        const juce::ScopedLock sl (lock);
+
+        if (std::find (pendingFiles.begin(), pendingFiles.end(), alsFile) == pendingFiles.end())
+            pendingFiles.push_back (alsFile);
+    }
+
+    notify();
+}
+
+//==============================================================================
+ColDawProjectMetadata::Project ColDawProjectMetadata::getProject (const juce::File& alsFile) const
+{
+    const juce::ScopedLock sl (lock);
+    auto project = projects.find (getKey (alsFile));
+    return project != projects.end() ? project->second : Project();
+}
+
+juce::Array<juce::File> ColDawProjectMetadata::getProjects() const
+{
+    const juce::ScopedLock sl (lock);
+    juce::Array<juce::File> files;
+
+    for (auto& project : projects)
+        files.add (project.second.file);
+
+    return files;
+}
+
+juce::Array<juce::File> ColDawProjectMetadata::findProjectsUsingDevice (const juce::String& deviceName) const
+{
+    const juce::ScopedLock sl (lock);
+    juce::Array<juce::File> files;
+
+    for (auto& project : projects)
+    {
+        for (auto& track : project.second.tracks)
+        {
+            if (track.devices.contains (deviceName, true))
+            {
+                files.add (project.second.file);
+                break;
+            }
+        }
+    }
+
+    return files;
+}
+
+juce::Array<juce::File> ColDawProjectMetadata::findProjectsUsingSample (const juce::File& sample) const
+{
+    const juce::ScopedLock sl (lock);
+    juce::Array<juce::File> files;
+
+    // Samples that weren't found are kept as stored, which may be a relative path
+    auto refersToSample = [&] (const Sample& s) { return juce::File::isAbsolutePath (s.path) && juce::File (s.path) == sample; };
+
+    for (auto& project : projects)
+        if (std::any_of (project.second.samples.begin(), project.second.samples.end(), refersToSample))
+            files.add (project.second.file);
+
+    return files;
+}
+
+//==============================================================================
+void ColDawProjectMetadata::run()
+{
+    while (! threadShouldExit())
+    {
+        juce::File alsFile;
+
+        {
+            const juce::ScopedLock sl (lock);
+
+            if (! pendingFiles.empty())
+            {
+                alsFile = pendingFiles.front();
+                pendingFiles.pop_front();
+            }
+        }
+
+        if (alsFile == juce::File())
+        {
+            wait (-1);
+            continue;
+        }
+
+        Project project;
+
+        if (isIndexed (alsFile) || ! readProject (alsFile, project))
+            continue;
+
+        {
+            const juce::ScopedLock sl (lock);
+            projects[getKey (alsFile)] = std::move (project);
+            indexedFiles.addIfNotAlreadyThere (alsFile);
+            save();
+        }
+
+        triggerAsyncUpdate();
+    }
+}
+
+void ColDawProjectMetadata::handleAsyncUpdate()
+{
+    juce::Array<juce::File> files;
+
+    {
+        const juce::ScopedLock sl (lock);
+        files.swapWith (indexedFiles);
+    }
+
+    for (auto& file : files)
+        listener.projectIndexed (file);
+}
+
+bool ColDawProjectMetadata::isIndexed (const juce::File& alsFile) const
+{
+    const juce::ScopedLock sl (lock);
+    auto project = projects.find (getKey (alsFile));
+
+    return project != projects.end()
+        && project->second.size == alsFile.getSize()
+        && project->second.modified == alsFile.getLastModificationTime().toMilliseconds();
+}
+
+bool ColDawProjectMetadata::readProject (const juce::File& alsFile, Project& project)
+{
+    juce::FileInputStream input (alsFile);
+
+    if (! input.openedOk())
+        return false;
+
+    project.file = alsFile;
+    project.size = alsFile.getSize();
+    project.modified = alsFile.getLastModificationTime().toMilliseconds();
+
+    // One pass feeds both readers
+    ColDawChangePreview::Summary summary;
+    std::vector<ColDawSampleSync::SampleReference> references;
+    auto summaryReader = ColDawChangePreview::createSummaryReader (summary);
+    auto referenceCollector = ColDawSampleSync::createReferenceCollector (alsFile.getParentDirectory(), references);
+    ColDawAlsReader::HandlerList handlers { summaryReader.get(), referenceCollector.get() };
+
+    if (! ColDawAlsReader::read (input, handlers, [this] { return threadShouldExit(); }))
+        return false;
+
+    project.indexed = juce::Time::getCurrentTime();
+    project.tempo = summary.tempo;
+    project.timeSignatureNumerator = summary.timeSignatureNumerator;
+    project.timeSignatureDenominator = summary.timeSignatureDenominator;
+
+    for (auto& track : summary.tracks)
+    {
+        Track entry { track.type, track.name, {} };
+
+        for (auto& device : track.devices)
+            entry.devices.add (device.name);
+
+        project.tracks.push_back (std::move (entry));
+    }
+
+    for (auto& reference : references)
+    {
+        const bool found = reference.file.existsAsFile();
+        project.samples.push_back ({ found ? reference.file.getFullPathName()
+                                           : reference.path.isNotEmpty() ? reference.path : reference.relativePath,
+                                     ! found });
+    }
+
+    return true;
+}
+
+//==============================================================================
+void ColDawProjectMetadata::load()
+{
+    if (! indexFile.existsAsFile())
+        return;
+
+    auto json = juce::JSON::parse (indexFile);
+
+    if ((int) json.getProperty ("version", 0) != formatVersion)
+        return;
+
+    auto* entries = json.getProperty ("projects", {}).getDynamicObject();
+
+    if (entries == nullptr)
+        return;
+
+    for (auto& entry : entries->getProperties())
+    {
+        // Sets that are gone are dropped on load rather than kept forever
+        const juce::File file (entry.name.toString());
+
+        if (! file.existsAsFile())
+            continue;
+
+        const auto& value = entry.value;
+        Project project;
+        project.file = file;
+        project.size = (juce::int64) value.getProperty ("size", -1);
+        project.modified = (juce::int64) value.getProperty ("modified", 0);
+        project.indexed = juce::Time ((juce::int64) value.getProperty ("indexed", 0));
+        project.tempo = (double) value.getProperty ("tempo", 0.0);
+
+        const auto timeSignature = value.getProperty ("timeSignature", "").toString();
+        project.timeSignatureNumerator = timeSignature.upToFirstOccurrenceOf ("/", false, false).getIntValue();
+        project.timeSignatureDenominator = timeSignature.fromFirstOccurrenceOf ("/", false, false).getIntValue();
+
+        if (auto* tracks = value.getProperty ("tracks", {}).getArray())
+        {
+            for (auto& track : *tracks)
+            {
+                Track t { track.getProperty ("type", "").toString(), track.getProperty ("name", "").toString(), {} };
+
+                if (auto* devices = track.getProperty ("devices", {}).getArray())
+                    for (auto& device : *devices)
+                        t.devices.add (device.toString());
+
+                project.tracks.push_back (std::move (t));
+            }
+        }
+
+        if (auto* samples = value.getProperty ("samples", {}).getArray())
+            for (auto& sample : *samples)
+                project.samples.push_back ({ sample.getProperty ("path", "").toString(), (bool) sample.getProperty ("missing", false) });
+
+        if (project.isValid())
+            projects[getKey (file)] = std::move (project);
+    }
+}
+
+void ColDawProjectMetadata::save()
+{
+    const juce::ScopedLock sl (lock);
+
+    auto* entries = new juce::DynamicObject();
+    juce::var entriesVar (entries);
+
+    for (auto& project : projects)
+    {
+        const auto& p = project.second;
+        juce::Array<juce::var> tracks, samples;
+
+        for (auto& track : p.tracks)
+        {
+            auto* t = new juce::DynamicObject();
+            t->setProperty ("type", track.type);
+            t->setProperty ("name", track.name);
+            t->setProperty ("devices", track.devices);
+            tracks.add (juce::var (t));
+        }
+
+        for (auto& sample : p.samples)
+        {
+            auto* s = new juce::DynamicObject();
+            s->setProperty ("path", sample.path);
+
+            if (sample.missing)
+                s->setProperty ("missing", true);
+
+            samples.add (juce::var (s));
+        }
+
+        auto* entry = new juce::DynamicObject();
+        entry->setProperty ("size", p.size);
+        entry->setProperty ("modified", p.modified);
+        entry->setProperty ("indexed", p.indexed.toMilliseconds());
+        entry->setProperty ("tempo", p.tempo);
+        entry->setProperty ("timeSignature", juce::String (p.timeSignatureNumerator) + "/" + juce::String (p.timeSignatureDenominator));
+        entry->setProperty ("tracks", tracks);
+        entry->setProperty ("samples", samples);
+        entries->setProperty (project.first, juce::var (entry));
+    }
+
+    auto* index = new juce::DynamicObject();
+    juce::var indexVar (index);
+
+    index->setProperty ("version", formatVersion);
+    index->setProperty ("projects", entriesVar);
+
+    indexFile.getParentDirectory().createDirectory();
+    indexFile.replaceWithText (juce::JSON::toString (indexVar, true));
+}
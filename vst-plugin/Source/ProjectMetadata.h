@@ -0,0 +1,110 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_events/juce_events.h>
+#include <deque>
+#include <map>
+#include <vector>
+
+//==============================================================================
+/**
+ * ColDaw Export Plugin - local project metadata index
+ *
+ * Keeps the facts other parts of the plugin ask about a set - its tracks and
+ * their devices, tempo, time signature and the samples it refers to - for
+ * every project the plugin watches, and keeps that on disk between sessions
+ * next to project_mappings.json.
+ *
+ * A set is read again only when it has changed since it was indexed (by size
+ * and modification time), once per completed save, on a background thread,
+ * in a single streaming pass that fills the change preview summary and the
+ * sample references together. Queries are answered from memory and never
+ * touch the .als.
+ */
+class ColDawProjectMetadata : private juce::Thread,
+                              private juce::AsyncUpdater
+{
+public:
+    //==============================================================================
+    class Listener
+    {
+    public:
+        virtual ~Listener() = default;
+
+        /** Called on the message thread after a set has been (re-)indexed. */
+        virtual void projectIndexed (const juce::File& alsFile) = 0;
+    };
+
+    struct Track
+    {
+        juce::String type, name;    // type is the element name ("AudioTrack", "MidiTrack", ...)
+        juce::StringArray devices;  // Top-level devices in chain order; plug-ins by plug-in name
+    };
+
+    struct Sample
+    {
+        juce::String path;          // Where the file is on this machine, or the path stored in the set
+        bool missing = false;       // Not found on this machine
+    };
+
+    struct Project
+    {
+        juce::File file;
+        juce::int64 size = -1;      // Of the .als when it was indexed
+        juce::int64 modified = 0;   // Milliseconds
+        juce::Time indexed;
+
+        double tempo = 0.0;
+        int timeSignatureNumerator = 0, timeSignatureDenominator = 0;
+        std::vector<Track> tracks;
+        std::vector<Sample> samples;
+
+        /** False for a project that hasn't been indexed (yet). */
+        bool isValid() const noexcept { return size >= 0; }
+
+        /** Every distinct device and plug-in name, sorted. */
+        juce::StringArray getDeviceNames() const;
+
+        /** A one-line summary, e.g. "12 tracks, 128 BPM, 4/4, 30 samples (2 missing)". */
+        juce::String describe() const;
+    };
+
+    //==============================================================================
+    ColDawProjectMetadata (Listener& listener, const juce::File& indexFile);
+    ~ColDawProjectMetadata() override;
+
+    /** Queues a re-read of this set; nothing is read if it hasn't changed since it was indexed. */
+    void update (const juce::File& alsFile);
+
+    /** The indexed metadata of this set, or an invalid Project if there is none yet. */
+    Project getProject (const juce::File& alsFile) const;
+
+    /** Every indexed set. */
+    juce::Array<juce::File> getProjects() const;
+
+    /** Sets with a device or plug-in of this name (case-insensitive). */
+    juce::Array<juce::File> findProjectsUsingDevice (const juce::String& deviceName) const;
+
+    /** Sets that refer to this sample file. */
+    juce::Array<juce::File> findProjectsUsingSample (const juce::File& sample) const;
+
+private:
+    //==============================================================================
+    void run() override;
+    void handleAsyncUpdate() override;
+    bool isIndexed (const juce::File& alsFile) const;  // Indexed and unchanged since
+    bool readProject (const juce::File& alsFile, Project& project);
+
+    void load();
+    void save();
+
+    Listener& listener;
+    juce::File indexFile;
+
+    juce::CriticalSection lock;
+    std::map<juce::String, Project> projects;  // Keyed by full path
+    std::deque<juce::File> pendingFiles;
+    juce::Array<juce::File> indexedFiles;      // Not yet reported to the listener
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ColDawProjectMetadata)
+};
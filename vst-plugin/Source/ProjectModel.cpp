@@ -0,0 +1,416 @@
+#include "ProjectModel.h"
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+namespace
+{
+    using Tag = ColDawAlsReader::Tag;
+    using Hash = ColDawProjectModel::Hash;
+
+    constexpr size_t arenaBlockSize = 1 << 18;
+
+    //==============================================================================
+    constexpr juce::uint64 rotateLeft (juce::uint64 x, int bits) noexcept   { return (x << bits) | (x >> (64 - bits)); }
+
+    /** Final avalanche from MurmurHash3, so every input bit reaches every output bit. */
+    constexpr juce::uint64 mixBits (juce::uint64 x) noexcept
+    {
+        x = (x ^ (x >> 33)) * 0xff51afd7ed558ccdull;
+        x = (x ^ (x >> 33)) * 0xc4ceb9fe1a85ec53ull;
+        return x ^ (x >> 33);
+    }
+
+    /** Two independent 64-bit lanes over the bytes. */
+    Hash hashString (std::string_view text) noexcept
+    {
+        juce::uint64 high = 14695981039346656037ull, low = 0x27d4eb2f165667c5ull ^ text.size();
+
+        for (auto c : text)
+        {
+            high = (high ^ (juce::uint8) c) * 1099511628211ull;
+            low = rotateLeft (low ^ (juce::uint8) c, 5) * 0x9e3779b97f4a7c15ull;
+        }
+
+        return { mixBits (high), mixBits (low) };
+    }
+
+    /** Running hash of one element: its canonical start tag, then its children's hashes in order. */
+    struct HashState
+    {
+        Hash value { 0x736f6d6570736575ull, 0x646f72616e646f6dull };
+
+        void add (const Hash& x) noexcept
+        {
+            value.high = rotateLeft (value.high ^ x.high, 23) * 0x9e3779b97f4a7c15ull;
+            value.low = rotateLeft (value.low ^ x.low, 41) * 0xc2b2ae3d27d4eb4full + value.high;
+        }
+
+        Hash finish (size_t numChildren) const noexcept
+        {
+            return { mixBits (value.high ^ numChildren), mixBits (value.low + numChildren) };
+        }
+    };
+
+    /** Elements whose Value Live rewrites on every save without any real change. */
+    bool isVolatile (Tag tag) noexcept
+    {
+        return tag == Tag::LomId || tag == Tag::LomIdView || tag == Tag::OverwriteProtectionNumber;
+    }
+
+    bool isTrack (Tag tag) noexcept
+    {
+        return tag == Tag::AudioTrack || tag == Tag::MidiTrack || tag == Tag::GroupTrack || tag == Tag::ReturnTrack
+            || tag == Tag::MainTrack || tag == Tag::MasterTrack || tag == Tag::PreHearTrack;
+    }
+
+    /** Numbers as Live writes them; locale-independent. */
+    double parseNumber (std::string_view text) noexcept
+    {
+        char buffer[64];
+        const auto length = juce::jmin (text.size(), sizeof (buffer) - 1);
+        std::memcpy (buffer, text.data(), length);
+        buffer[length] = 0;
+
+        if (text == "true")     return 1.0;
+        if (text == "false")    return 0.0;
+
+        return juce::CharacterFunctions::getDoubleValue (juce::CharPointer_ASCII (buffer));
+    }
+}
+
+//==============================================================================
+/** Fills a model from the element stream. */
+class ColDawProjectModel::Builder : public ColDawAlsReader::Handler
+{
+public:
+    explicit Builder (ColDawProjectModel& m) : model (m)
+    {
+        model.firstAttributes.push_back (0);
+    }
+
+    void startElement (Tag tag, std::string_view name, const ColDawAlsReader::Attributes& attributes) override
+    {
+        const auto element = (Index) model.tags.size();
+
+        model.tags.push_back (tag);
+        model.names.push_back (intern (name));
+        model.parents.push_back (open.empty() ? noElement : open.back().element);
+        model.ends.push_back (noElement);
+        model.hashes.emplace_back();
+
+        // Canonical start tag: name, then attributes sorted by name, without volatile Values
+        OpenElement entry { element, {}, 0 };
+        entry.state.add (model.stringHashes[model.names.back()]);
+        canonicalAttributes.clear();
+
+        for (auto& attribute : attributes)
+        {
+            model.attributeNames.push_back (intern (attribute.first));
+            model.attributeValues.push_back (internValue (attribute.second));
+
+            if (! (isVolatile (tag) && attribute.first == "Value"))
+                canonicalAttributes.push_back ({ model.attributeNames.back(), model.attributeValues.back() });
+        }
+
+        model.firstAttributes.push_back ((juce::uint32) model.attributeNames.size());
+
+        std::sort (canonicalAttributes.begin(), canonicalAttributes.end(), [this] (const auto& a, const auto& b)
+        {
+            return model.strings[a.first] < model.strings[b.first];
+        });
+
+        for (auto& attribute : canonicalAttributes)
+        {
+            entry.state.add (model.stringHashes[attribute.first]);
+            entry.state.add (model.stringHashes[attribute.second]);
+        }
+
+        entry.state.add ({ canonicalAttributes.size(), 0 });
+        open.push_back (entry);
+
+        addRows (tag, element, attributes);
+    }
+
+    void endElement (Tag tag, std::string_view) override
+    {
+        const auto closed = open.back();
+        open.pop_back();
+
+        model.ends[closed.element] = (Index) model.tags.size();
+        model.hashes[closed.element] = closed.state.finish (closed.numChildren);
+
+        if (! open.empty())
+        {
+            open.back().state.add (model.hashes[closed.element]);
+            ++open.back().numChildren;
+        }
+
+        endRows (tag, closed.element);
+    }
+
+    /** Releases what only building needed, and the arrays' spare capacity. */
+    void finish()
+    {
+        internSlots = {};
+
+        model.strings.shrink_to_fit();
+        model.stringHashes.shrink_to_fit();
+        model.tags.shrink_to_fit();
+        model.names.shrink_to_fit();
+        model.parents.shrink_to_fit();
+        model.ends.shrink_to_fit();
+        model.firstAttributes.shrink_to_fit();
+        model.hashes.shrink_to_fit();
+        model.attributeNames.shrink_to_fit();
+        model.attributeValues.shrink_to_fit();
+    }
+
+private:
+    //==============================================================================
+    struct OpenElement
+    {
+        Index element;
+        HashState state;
+        size_t numChildren;
+    };
+
+    StringId intern (std::string_view text)
+    {
+        const auto key = std::hash<std::string_view>() (text);
+
+        // Open addressing, at most half full; slots hold id + 1, 0 when empty
+        for (auto slot = key & (internSlots.size() - 1);; slot = (slot + 1) & (internSlots.size() - 1))
+        {
+            if (internSlots[slot].id == 0)
+            {
+                const auto id = addString (text);
+                internSlots[slot] = { key, id + 1 };
+
+                if (model.strings.size() * 2 > internSlots.size())
+                    growInternTable();
+
+                return id;
+            }
+
+            if (internSlots[slot].key == key && model.strings[internSlots[slot].id - 1] == text)
+                return internSlots[slot].id - 1;
+        }
+    }
+
+    StringId addString (std::string_view text)
+    {
+        if (model.arenaBlocks.empty() || arenaUsed + text.size() > arenaCapacity)
+        {
+            // Strings longer than a block get a block of their own
+            arenaCapacity = juce::jmax (arenaBlockSize, text.size());
+            model.arenaBlocks.emplace_back (arenaCapacity);
+            model.arenaSize += arenaCapacity;
+            arenaUsed = 0;
+        }
+
+        auto* copy = model.arenaBlocks.back().get() + arenaUsed;
+        std::memcpy (copy, text.data(), text.size());
+        arenaUsed += text.size();
+
+        model.strings.emplace_back (copy, text.size());
+        model.stringHashes.push_back (hashString (text));
+        return (StringId) model.strings.size() - 1;
+    }
+
+    void growInternTable()
+    {
+        std::vector<InternSlot> grown (internSlots.size() * 2);
+
+        for (auto& entry : internSlots)
+        {
+            if (entry.id == 0)
+                continue;
+
+            auto slot = entry.key & (grown.size() - 1);
+
+            while (grown[slot].id != 0)
+                slot = (slot + 1) & (grown.size() - 1);
+
+            grown[slot] = entry;
+        }
+
+        internSlots = std::move (grown);
+    }
+
+    StringId internValue (std::string_view raw)
+    {
+        if (raw.find ('&') == std::string_view::npos)
+            return intern (raw);
+
+        const auto decoded = ColDawAlsReader::toString (raw).toStdString();
+        return intern (decoded);
+    }
+
+    //==============================================================================
+    void addRows (Tag tag, Index element, const ColDawAlsReader::Attributes& attributes)
+    {
+        const auto parentTag = open.size() > 1 ? model.tags[open[open.size() - 2].element] : Tag::unknown;
+
+        if (isTrack (tag))
+        {
+            track = element;
+        }
+        else if (tag == Tag::AudioClip || tag == Tag::MidiClip)
+        {
+            clip = (juce::uint32) model.clips.size();
+            clipElement = element;
+            model.clips.element.push_back (element);
+            model.clips.track.push_back (track);
+            model.clips.time.push_back (parseNumber (attributes.get ("Time")));
+            model.clips.start.push_back (0.0);
+            model.clips.end.push_back (0.0);
+        }
+        else if ((tag == Tag::CurrentStart || tag == Tag::CurrentEnd) && clipElement != noElement
+                  && model.parents[element] == clipElement)
+        {
+            (tag == Tag::CurrentStart ? model.clips.start : model.clips.end).back() = parseNumber (attributes.get ("Value"));
+        }
+        else if (tag == Tag::KeyTrack)
+        {
+            keyTrackFirstNote = model.notes.size();
+            keyTrackKey = 0;
+        }
+        else if (tag == Tag::MidiKey && parentTag == Tag::KeyTrack)
+        {
+            keyTrackKey = (juce::uint8) juce::jlimit (0, 127, (int) parseNumber (attributes.get ("Value")));
+        }
+        else if (tag == Tag::MidiNoteEvent && clipElement != noElement)
+        {
+            model.notes.clip.push_back (clip);
+            model.notes.time.push_back ((float) parseNumber (attributes.get ("Time")));
+            model.notes.duration.push_back ((float) parseNumber (attributes.get ("Duration")));
+            model.notes.velocity.push_back ((float) parseNumber (attributes.get ("Velocity")));
+            model.notes.key.push_back (keyTrackKey);
+        }
+        else if (tag == Tag::AutomationEnvelope || tag == Tag::ClipEnvelope)
+        {
+            envelope = element;
+        }
+        else if ((tag == Tag::FloatEvent || tag == Tag::BoolEvent || tag == Tag::EnumEvent)
+                  && envelope != noElement && parentTag == Tag::Events)
+        {
+            model.automationPoints.envelope.push_back (envelope);
+            model.automationPoints.time.push_back (parseNumber (attributes.get ("Time")));
+            model.automationPoints.value.push_back ((float) parseNumber (attributes.get ("Value")));
+        }
+    }
+
+    void endRows (Tag tag, Index element)
+    {
+        if (element == track)
+        {
+            track = noElement;
+        }
+        else if (element == clipElement)
+        {
+            clipElement = noElement;
+        }
+        else if (element == envelope)
+        {
+            envelope = noElement;
+        }
+        else if (tag == Tag::KeyTrack)
+        {
+            // MidiKey follows the notes it applies to
+            std::fill (model.notes.key.begin() + (std::ptrdiff_t) keyTrackFirstNote, model.notes.key.end(), keyTrackKey);
+        }
+    }
+
+    //==============================================================================
+    ColDawProjectModel& model;
+    std::vector<OpenElement> open;
+    std::vector<std::pair<StringId, StringId>> canonicalAttributes;
+
+    struct InternSlot
+    {
+        size_t key = 0;
+        StringId id = 0;
+    };
+
+    std::vector<InternSlot> internSlots = std::vector<InternSlot> (1024);
+    size_t arenaUsed = 0, arenaCapacity = 0;
+
+    Index track = noElement, clipElement = noElement, envelope = noElement;
+    juce::uint32 clip = 0;
+    size_t keyTrackFirstNote = 0;
+    juce::uint8 keyTrackKey = 0;
+};
+
+//==============================================================================
+ColDawProjectModel::ColDawProjectModel() = default;
+ColDawProjectModel::~ColDawProjectModel() = default;
+
+std::unique_ptr<ColDawProjectModel> ColDawProjectModel::load (juce::InputStream& input, const std::function<bool()>& shouldAbort)
+{
+    std::unique_ptr<ColDawProjectModel> model (new ColDawProjectModel());
+    Builder builder (*model);
+
+    if (! ColDawAlsReader::read (input, builder, shouldAbort))
+        return nullptr;
+
+    builder.finish();
+    return model;
+}
+
+//==============================================================================
+ColDawProjectModel::Index ColDawProjectModel::getNextSibling (Index element) const noexcept
+{
+    const auto parent = parents[element];
+
+    if (parent == noElement || ends[element] >= ends[parent])
+        return noElement;
+
+    return ends[element];
+}
+
+std::vector<ColDawProjectModel::Index> ColDawProjectModel::getChildren (Index element) const
+{
+    std::vector<Index> children;
+
+    for (auto child = getFirstChild (element); child != noElement; child = getNextSibling (child))
+        children.push_back (child);
+
+    return children;
+}
+
+ColDawProjectModel::Attribute ColDawProjectModel::getAttribute (Index element, int index) const noexcept
+{
+    const auto i = firstAttributes[element] + (juce::uint32) index;
+    return { strings[attributeNames[i]], strings[attributeValues[i]] };
+}
+
+std::string_view ColDawProjectModel::getAttributeValue (Index element, std::string_view name) const noexcept
+{
+    for (auto i = firstAttributes[element]; i < firstAttributes[element + 1]; ++i)
+        if (strings[attributeNames[i]] == name)
+            return strings[attributeValues[i]];
+
+    return {};
+}
+
+bool ColDawProjectModel::hasAttribute (Index element, std::string_view name) const noexcept
+{
+    for (auto i = firstAttributes[element]; i < firstAttributes[element + 1]; ++i)
+        if (strings[attributeNames[i]] == name)
+            return true;
+
+    return false;
+}
+
+size_t ColDawProjectModel::getMemoryUsage() const noexcept
+{
+    auto bytes = [] (const auto& v) { return v.capacity() * sizeof (v[0]); };
+
+    return arenaSize + bytes (arenaBlocks) + bytes (strings) + bytes (stringHashes)
+         + bytes (tags) + bytes (names) + bytes (parents) + bytes (ends) + bytes (firstAttributes) + bytes (hashes)
+         + bytes (attributeNames) + bytes (attributeValues)
+         + bytes (clips.element) + bytes (clips.track) + bytes (clips.time) + bytes (clips.start) + bytes (clips.end)
+         + bytes (notes.clip) + bytes (notes.time) + bytes (notes.duration) + bytes (notes.velocity) + bytes (notes.key)
+         + bytes (automationPoints.envelope) + bytes (automationPoints.time) + bytes (automationPoints.value);
+}
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <vector>
+#include "AlsReader.h"
+
+//==============================================================================
+/**
+ * ColDaw Export Plugin - compact in-memory project model
+ *
+ * Holds a whole set as flat arrays instead of a DOM. Element i (in document
+ * order, so the root is 0 and a subtree is a contiguous range) has its tag,
+ * name, parent, extent and attribute range in parallel arrays. Every name
+ * and value is interned once into an arena owned by the model. Building a
+ * model takes a few large allocations rather than several per element, and
+ * walking it touches contiguous memory.
+ *
+ * Each element also gets a 128-bit hash of its subtree in the canonical form
+ * described in SemanticDelta.h, computed bottom-up in the same pass that
+ * reads the set. Unchanged subtrees of two versions can be matched by
+ * comparing hashes, without looking at their contents.
+ *
+ * Clips, MIDI notes and automation points are pulled out into
+ * struct-of-arrays tables as well, for code that works on them in bulk.
+ *
+ * Text content isn't kept; Live doesn't write any.
+ */
+class ColDawProjectModel
+{
+public:
+    //==============================================================================
+    using Tag = ColDawAlsReader::Tag;
+    using Index = juce::uint32;
+    static constexpr Index noElement = ~(Index) 0;
+
+    struct Hash
+    {
+        juce::uint64 high = 0, low = 0;
+
+        bool operator== (const Hash& other) const noexcept   { return high == other.high && low == other.low; }
+        bool operator!= (const Hash& other) const noexcept   { return ! operator== (other); }
+    };
+
+    struct Attribute
+    {
+        std::string_view name, value;  // value with entities decoded
+    };
+
+    /** One row per AudioClip or MidiClip. */
+    struct Clips
+    {
+        std::vector<Index> element;
+        std::vector<Index> track;           // Enclosing track element, or noElement
+        std::vector<double> time;           // Arrangement position in beats; 0 in a session slot
+        std::vector<double> start, end;     // CurrentStart and CurrentEnd
+
+        size_t size() const noexcept        { return element.size(); }
+    };
+
+    /** One row per MidiNoteEvent. */
+    struct Notes
+    {
+        std::vector<juce::uint32> clip;     // Row in Clips
+        std::vector<float> time, duration, velocity;
+        std::vector<juce::uint8> key;
+
+        size_t size() const noexcept        { return clip.size(); }
+    };
+
+    /** One row per Float, Bool or EnumEvent of an automation or clip envelope. */
+    struct AutomationPoints
+    {
+        std::vector<Index> envelope;        // Enclosing AutomationEnvelope (or ClipEnvelope) element
+        std::vector<double> time;
+        std::vector<float> value;
+
+        size_t size() const noexcept        { return envelope.size(); }
+    };
+
+    //==============================================================================
+    /** Reads a set (gzipped or plain XML); nullptr if it isn't a complete document or shouldAbort said so. */
+    static std::unique_ptr<ColDawProjectModel> load (juce::InputStream& input, const std::function<bool()>& shouldAbort = nullptr);
+
+    ~ColDawProjectModel();
+
+    //==============================================================================
+    Index getNumElements() const noexcept                   { return (Index) tags.size(); }
+
+    Tag getTag (Index element) const noexcept               { return tags[element]; }
+    std::string_view getName (Index element) const noexcept { return strings[names[element]]; }
+    Index getParent (Index element) const noexcept          { return parents[element]; }
+
+    /** One past the last element of the subtree. */
+    Index getEnd (Index element) const noexcept             { return ends[element]; }
+
+    /** Children are walked with getFirstChild and getNextSibling, both noElement past the end. */
+    Index getFirstChild (Index element) const noexcept      { return element + 1 < ends[element] ? element + 1 : noElement; }
+    Index getNextSibling (Index element) const noexcept;
+    std::vector<Index> getChildren (Index element) const;
+
+    int getNumAttributes (Index element) const noexcept     { return (int) (firstAttributes[element + 1] - firstAttributes[element]); }
+    Attribute getAttribute (Index element, int index) const noexcept;
+
+    /** The attribute's value, or empty if the element doesn't have it. */
+    std::string_view getAttributeValue (Index element, std::string_view name) const noexcept;
+    bool hasAttribute (Index element, std::string_view name) const noexcept;
+
+    /** Hash of the subtree's canonical form; equal subtrees in any two models hash the same. */
+    const Hash& getHash (Index element) const noexcept      { return hashes[element]; }
+
+    //==============================================================================
+    const Clips& getClips() const noexcept                  { return clips; }
+    const Notes& getNotes() const noexcept                  { return notes; }
+    const AutomationPoints& getAutomationPoints() const noexcept { return automationPoints; }
+
+    /** Bytes held by the model, arena included. */
+    size_t getMemoryUsage() const noexcept;
+
+private:
+    //==============================================================================
+    using StringId = juce::uint32;
+    class Builder;
+
+    ColDawProjectModel();
+
+    // Strings, interned into arena blocks; stringHashes[i] is the hash of strings[i]
+    std::vector<juce::HeapBlock<char>> arenaBlocks;
+    size_t arenaSize = 0;
+    std::vector<std::string_view> strings;
+    std::vector<Hash> stringHashes;
+
+    // Elements
+    std::vector<Tag> tags;
+    std::vector<StringId> names;
+    std::vector<Index> parents, ends;
+    std::vector<juce::uint32> firstAttributes;  // Element i owns [firstAttributes[i], firstAttributes[i + 1])
+    std::vector<Hash> hashes;
+
+    // Attributes
+    std::vector<StringId> attributeNames, attributeValues;
+
+    Clips clips;
+    Notes notes;
+    AutomationPoints automationPoints;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ColDawProjectModel)
+};
@@ -0,0 +1,309 @@
+#include "ProjectWatcher.h"
+#include <functional>
+#include <map>
+
+#if JUCE_LINUX
+ #include <sys/inotify.h>
+ #include <poll.h>
+ #include <unistd.h>
+#endif
+
+namespace
+{
+    constexpr int pollIntervalMs = 2000;
+}
+
+//==============================================================================
+ColDawProjectWatcher::ColDawProjectWatcher (Listener& l, ColDawProjectIndex& projectIndex)
+    : juce::Thread ("ColDaw Project Watcher"),
+      listener (l),
+      index (projectIndex)
+{
+    startThread (juce::Thread::Priority::background);
+}
+
+ColDawProjectWatcher::~ColDawProjectWatcher()
+{
+    stopThread (4000);
+    cancelPendingUpdate();
+}
+
+void ColDawProjectWatcher::watch (const juce::File& directory, bool recursive)
+{
+    if (! directory.isDirectory())
+        return;
+
+    {
+        const juce::ScopedLock sl (lock);
+
+        // Already covered by a recursive root
+        for (auto& root : roots)
+            if (root.recursive ? directory == root.directory || directory.isAChildOf (root.directory)
+                               : directory == root.directory && ! recursive)
+                return;
+
+        roots.push_back ({ directory, recursive, juce::Time::getCurrentTime() });
+    }
+
+    notify();
+}
+
+void ColDawProjectWatcher::setSelectedFile (const juce::File& file)
+{
+    {
+        const juce::ScopedLock sl (lock);
+
+        if (file == selectedFile)
+            return;
+
+        selectedFile = file;
+    }
+
+    notify();
+}
+
+juce::File ColDawProjectWatcher::getSelectedFile() const
+{
+    const juce::ScopedLock sl (lock);
+    return selectedFile;
+}
+
+std::vector<ColDawProjectWatcher::Root> ColDawProjectWatcher::getRootsFrom (size_t firstIndex) const
+{
+    const juce::ScopedLock sl (lock);
+
+    if (firstIndex >= roots.size())
+        return {};
+
+    return { roots.begin() + (std::ptrdiff_t) firstIndex, roots.end() };
+}
+
+//==============================================================================
+void ColDawProjectWatcher::run()
+{
+   #if JUCE_LINUX
+    if (runInotify())
+        return;
+   #endif
+
+    usingNativeEvents = false;
+    runPolling();
+}
+
+#if JUCE_LINUX
+bool ColDawProjectWatcher::runInotify()
+{
+    const int fd = inotify_init1 (IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0)
+        return false;
+
+    usingNativeEvents = true;
+
+    struct WatchedDirectory
+    {
+        juce::File directory;
+        juce::File root;  // For the skip rules below recursive roots
+        bool recursive = false;
+    };
+
+    std::map<int, WatchedDirectory> watches;  // inotify watch descriptor -> directory
+
+    // Directories are watched individually, so new subdirectories get their
+    // own watch as they appear. Fails once the user's watch limit is reached.
+    std::function<bool (const juce::File&, const juce::File&, bool)> addWatch
+        = [&] (const juce::File& directory, const juce::File& root, bool recursive)
+    {
+        const int wd = inotify_add_watch (fd, directory.getFullPathName().toRawUTF8(),
+                                          IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_ONLYDIR);
+        if (wd < 0)
+            return false;
+
+        auto& watched = watches[wd];
+        watched.directory = directory;
+
+        if (recursive)
+        {
+            if (! watched.recursive)
+                watched.root = root;
+
+            watched.recursive = true;
+
+            for (const auto& entry : juce::RangedDirectoryIterator (directory, false, "*", juce::File::findDirectories))
+                if (! index.isSkipped (entry.getFile(), root) && ! addWatch (entry.getFile(), root, true))
+                    return false;
+        }
+
+        return true;
+    };
+
+    size_t numRootsWatched = 0;
+    auto skipRules = index.getSkipRules();
+    alignas (inotify_event) char buffer[16384];
+
+    while (! threadShouldExit())
+    {
+        if (index.getSkipRules() != skipRules)
+        {
+            // Watch again under the new rules
+            for (auto& watched : watches)
+                inotify_rm_watch (fd, watched.first);
+
+            watches.clear();
+            numRootsWatched = 0;
+            skipRules = index.getSkipRules();
+        }
+
+        for (auto& root : getRootsFrom (numRootsWatched))
+        {
+            if (! addWatch (root.directory, root.directory, root.recursive))
+            {
+                close (fd);
+                return false;
+            }
+
+            ++numRootsWatched;
+        }
+
+        indexNewRoots();
+
+        pollfd descriptor { fd, POLLIN, 0 };
+
+        // The timeout only bounds how long new roots and shutdown wait
+        if (poll (&descriptor, 1, 500) <= 0)
+            continue;
+
+        for (;;)
+        {
+            const auto length = read (fd, buffer, sizeof (buffer));
+            if (length <= 0)
+                break;
+
+            for (char* ptr = buffer; ptr < buffer + length;)
+            {
+                const auto* event = reinterpret_cast<const inotify_event*> (ptr);
+                ptr += sizeof (inotify_event) + event->len;
+
+                if ((event->mask & IN_IGNORED) != 0)
+                {
+                    watches.erase (event->wd);
+                    continue;
+                }
+
+                auto watched = watches.find (event->wd);
+                if (watched == watches.end() || event->len == 0)
+                    continue;
+
+                const auto file = watched->second.directory.getChildFile (juce::String::fromUTF8 (event->name));
+
+                if ((event->mask & IN_ISDIR) != 0)
+                {
+                    const auto& root = watched->second.root;
+
+                    if (watched->second.recursive && ! index.isSkipped (file, root) && ! addWatch (file, root, true))
+                    {
+                        close (fd);
+                        return false;
+                    }
+                }
+                else if ((event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) != 0 && file.hasFileExtension (".als"))
+                {
+                    fileWritten (file);
+                }
+            }
+        }
+    }
+
+    close (fd);
+    return true;
+}
+#endif
+
+void ColDawProjectWatcher::runPolling()
+{
+    juce::File polledFile;
+    juce::Time polledModified;
+
+    while (! threadShouldExit())
+    {
+        indexNewRoots();
+
+        const auto selected = getSelectedFile();
+
+        if (selected != juce::File())
+        {
+            // A single stat per poll while the user works on one project
+            const auto modified = selected.getLastModificationTime();
+
+            if (selected == polledFile && modified > polledModified)
+                fileWritten (selected);
+
+            polledFile = selected;
+            polledModified = modified;
+        }
+        else
+        {
+            polledFile = juce::File();
+
+            for (auto& root : getRootsFrom (0))
+            {
+                juce::Array<juce::File> written;
+                index.refresh (root.directory, root.recursive, &written);
+
+                // Files already there when the root was added aren't news
+                for (auto& file : written)
+                    if (file.getLastModificationTime() >= root.added)
+                        fileWritten (file);
+            }
+        }
+
+        wait (pollIntervalMs);
+    }
+}
+
+//==============================================================================
+void ColDawProjectWatcher::indexNewRoots()
+{
+    for (auto& root : getRootsFrom (numRootsIndexed))
+    {
+        ++numRootsIndexed;
+
+        if (! root.recursive)
+            continue;
+
+        index.refresh (root.directory);
+
+        {
+            const juce::ScopedLock sl (lock);
+            indexedRoots.add (root.directory);
+        }
+
+        triggerAsyncUpdate();
+    }
+}
+
+void ColDawProjectWatcher::fileWritten (const juce::File& file)
+{
+    {
+        const juce::ScopedLock sl (lock);
+        writtenFiles.addIfNotAlreadyThere (file);
+    }
+
+    triggerAsyncUpdate();
+}
+
+void ColDawProjectWatcher::handleAsyncUpdate()
+{
+    juce::Array<juce::File> files, indexed;
+
+    {
+        const juce::ScopedLock sl (lock);
+        files.swapWith (writtenFiles);
+        indexed.swapWith (indexedRoots);
+    }
+
+    for (auto& root : indexed)
+        listener.projectsIndexed (root);
+
+    for (auto& file : files)
+        listener.projectFileWritten (file);
+}
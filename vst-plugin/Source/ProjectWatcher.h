@@ -0,0 +1,91 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_events/juce_events.h>
+#include <vector>
+#include "ProjectIndex.h"
+
+//==============================================================================
+/**
+ * ColDaw Export Plugin - Project Watcher
+ *
+ * Reports .als files as they are written. On Linux this uses inotify, so an
+ * idle watcher costs no CPU or disk I/O; elsewhere, or if inotify runs out of
+ * watches, it falls back to polling on its own thread. While a project file is
+ * selected, polling only stats that file. Otherwise it refreshes the plugin's
+ * ColDawProjectIndex of the watched directories, which only lists directories
+ * whose mtime changed.
+ *
+ * The index is also brought up to date on this thread whenever a recursive
+ * root is added, so finding recent projects never scans on the message thread.
+ * Directories the index's skip rules exclude are never watched either.
+ */
+class ColDawProjectWatcher : private juce::Thread,
+                             private juce::AsyncUpdater
+{
+public:
+    //==============================================================================
+    class Listener
+    {
+    public:
+        virtual ~Listener() = default;
+
+        /** Called on the message thread after an .als file has been written. */
+        virtual void projectFileWritten (const juce::File& file) = 0;
+
+        /** Called on the message thread once the index covers a recursive root. */
+        virtual void projectsIndexed (const juce::File& root) = 0;
+    };
+
+    //==============================================================================
+    ColDawProjectWatcher (Listener& listener, ColDawProjectIndex& index);
+    ~ColDawProjectWatcher() override;
+
+    /** Starts watching a directory, and all its subdirectories if recursive. */
+    void watch (const juce::File& directory, bool recursive);
+
+    /** The project file being worked on, if any. When polling, this is the only
+        file that is checked while it is set.
+    */
+    void setSelectedFile (const juce::File& file);
+
+    /** False once the watcher has had to fall back to polling. */
+    bool isUsingNativeEvents() const noexcept { return usingNativeEvents.load(); }
+
+private:
+    //==============================================================================
+    struct Root
+    {
+        juce::File directory;
+        bool recursive = false;
+        juce::Time added;
+    };
+
+    void run() override;
+    void handleAsyncUpdate() override;
+
+   #if JUCE_LINUX
+    bool runInotify();
+   #endif
+    void runPolling();
+
+    std::vector<Root> getRootsFrom (size_t firstIndex) const;
+    juce::File getSelectedFile() const;
+    void indexNewRoots();
+    void fileWritten (const juce::File& file);
+
+    Listener& listener;
+    ColDawProjectIndex& index;
+
+    juce::CriticalSection lock;
+    std::vector<Root> roots;
+    juce::File selectedFile;
+    juce::Array<juce::File> writtenFiles;
+    juce::Array<juce::File> indexedRoots;
+
+    size_t numRootsIndexed = 0;  // The watcher thread's own
+
+    std::atomic<bool> usingNativeEvents { false };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ColDawProjectWatcher)
+};
@@ -0,0 +1,170 @@
+#include "PushChannel.h"
+
+namespace
+{
+    constexpr int waitSeconds = 25;              // How long the server may hold a request
+    constexpr int connectionTimeoutMs = 40000;   // Comfortably above waitSeconds
+    constexpr int minimumRequestIntervalMs = 1000;
+    constexpr int initialBackoffMs = 1000;
+    constexpr int maximumBackoffMs = 60000;
+}
+
+//==============================================================================
+ColDawPushChannel::ColDawPushChannel (Listener& l)
+    : juce::Thread ("ColDaw Push Channel"),
+      listener (l)
+{
+    startThread (juce::Thread::Priority::background);
+}
+
+ColDawPushChannel::~ColDawPushChannel()
+{
+    stopThread (4000);
+    cancelPendingUpdate();
+}
+
+void ColDawPushChannel::subscribe (const juce::String& serverUrl, const juce::String& projectId,
+                                   const juce::String& userId, const juce::String& authToken)
+{
+    {
+        const juce::ScopedLock sl (lock);
+        Subscription newSubscription { serverUrl, projectId, userId, authToken };
+
+        if (newSubscription == subscription)
+            return;
+
+        // A new token for the same project keeps what we've already seen
+        if (projectId != subscription.projectId || userId != subscription.userId)
+            lastVersionId = {};
+
+        subscription = newSubscription;
+        ++generation;
+    }
+
+    notify();
+}
+
+void ColDawPushChannel::unsubscribe()
+{
+    subscribe ({}, {}, {}, {});
+}
+
+//==============================================================================
+void ColDawPushChannel::run()
+{
+    juce::Random random;
+    int backoffMs = 0;
+
+    while (! threadShouldExit())
+    {
+        Subscription current;
+        juce::String since;
+        int currentGeneration;
+
+        {
+            const juce::ScopedLock sl (lock);
+            current = subscription;
+            since = lastVersionId;
+            currentGeneration = generation;
+        }
+
+        if (current.projectId.isEmpty())
+        {
+            connected = false;
+            backoffMs = 0;
+            wait (-1);
+            continue;
+        }
+
+        const auto started = juce::Time::getMillisecondCounter();
+        const auto result = poll (current, since, currentGeneration);
+
+        if (result == PollResult::cancelled)
+        {
+            backoffMs = 0;
+            continue;
+        }
+
+        if (result == PollResult::failed)
+        {
+            connected = false;
+            backoffMs = backoffMs == 0 ? initialBackoffMs : juce::jmin (backoffMs * 2, maximumBackoffMs);
+
+            // Full jitter on the upper half, so a studio's worth of plugins
+            // don't all come back the moment the server does
+            wait (backoffMs / 2 + random.nextInt (backoffMs / 2 + 1));
+            continue;
+        }
+
+        connected = true;
+        backoffMs = 0;
+
+        // A server (or proxy) that answers straight away must not turn this into a busy loop
+        const auto elapsed = (int) (juce::Time::getMillisecondCounter() - started);
+        if (result == PollResult::timedOut && elapsed < minimumRequestIntervalMs)
+            wait (minimumRequestIntervalMs - elapsed);
+    }
+
+    connected = false;
+}
+
+ColDawPushChannel::PollResult ColDawPushChannel::poll (const Subscription& current, const juce::String& since, int currentGeneration)
+{
+    auto url = juce::URL (current.serverUrl + "/api/projects/" + current.projectId
+                              + "/vst-notifications/" + current.userId + "/wait")
+                   .withParameter ("since", since)
+                   .withParameter ("timeout", juce::String (waitSeconds));
+
+    ColDawHttpClient::Request request;
+    request.url = url;
+    request.headers = "Authorization: Bearer " + current.authToken;
+    request.connectionTimeoutMs = connectionTimeoutMs;
+
+    // Dropped as soon as the subscription changes or the channel shuts down
+    request.shouldAbort = [this, currentGeneration]
+    {
+        return threadShouldExit() || generation.load() != currentGeneration;
+    };
+
+    auto response = httpClient->perform (request);
+
+    if (request.shouldAbort())
+        return PollResult::cancelled;
+
+    if (response.statusCode != 200)
+        return PollResult::failed;
+
+    auto json = response.getJson();
+
+    if (! json.isObject())
+        return PollResult::failed;
+
+    if (! (bool) json.getProperty ("hasUpdate", false))
+        return PollResult::timedOut;
+
+    {
+        const juce::ScopedLock sl (lock);
+
+        if (generation != currentGeneration)
+            return PollResult::cancelled;
+
+        lastVersionId = json.getProperty ("notification", {}).getProperty ("versionId", "").toString();
+        receivedNotifications.add (json);
+    }
+
+    triggerAsyncUpdate();
+    return PollResult::received;
+}
+
+void ColDawPushChannel::handleAsyncUpdate()
+{
+    juce::Array<juce::var> notifications;
+
+    {
+        const juce::ScopedLock sl (lock);
+        notifications.swapWith (receivedNotifications);
+    }
+
+    for (auto& notification : notifications)
+        listener.webNotificationReceived (notification);
+}
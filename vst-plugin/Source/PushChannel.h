@@ -0,0 +1,88 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_events/juce_events.h>
+#include "HttpClient.h"
+
+//==============================================================================
+/**
+ * ColDaw Export Plugin - Push Channel
+ *
+ * Keeps one long-poll request open to the server's vst-notifications wait
+ * endpoint for the subscribed project, so web-to-DAW pushes arrive within a
+ * round trip without polling. The request runs on a background thread; the
+ * server holds it until a notification is published or its timeout passes,
+ * and the channel then immediately asks again. Failed requests are retried
+ * with jittered exponential backoff (1 s up to 60 s), reset by the next
+ * request that succeeds.
+ *
+ * Each request passes the last version ID seen, so a notification that is
+ * still pending on the server is only delivered once per subscription.
+ */
+class ColDawPushChannel : private juce::Thread,
+                          private juce::AsyncUpdater
+{
+public:
+    //==============================================================================
+    class Listener
+    {
+    public:
+        virtual ~Listener() = default;
+
+        /** Called on the message thread with the server's response
+            ({ hasUpdate: true, notification: {...} }).
+        */
+        virtual void webNotificationReceived (const juce::var& response) = 0;
+    };
+
+    //==============================================================================
+    explicit ColDawPushChannel (Listener& listener);
+    ~ColDawPushChannel() override;
+
+    /** Starts listening for notifications for this project and user, replacing
+        any previous subscription. Does nothing if nothing has changed.
+    */
+    void subscribe (const juce::String& serverUrl, const juce::String& projectId,
+                    const juce::String& userId, const juce::String& authToken);
+
+    /** Stops listening and drops the open request, if any. */
+    void unsubscribe();
+
+    /** True while the last request reached the server. */
+    bool isConnected() const noexcept { return connected.load(); }
+
+private:
+    //==============================================================================
+    struct Subscription
+    {
+        juce::String serverUrl, projectId, userId, authToken;
+
+        bool operator== (const Subscription& other) const
+        {
+            return serverUrl == other.serverUrl && projectId == other.projectId
+                && userId == other.userId && authToken == other.authToken;
+        }
+
+        bool operator!= (const Subscription& other) const { return ! operator== (other); }
+    };
+
+    enum class PollResult { received, timedOut, failed, cancelled };
+
+    void run() override;
+    void handleAsyncUpdate() override;
+
+    PollResult poll (const Subscription& subscription, const juce::String& since, int generation);
+
+    Listener& listener;
+    juce::SharedResourcePointer<ColDawHttpClient> httpClient;
+
+    juce::CriticalSection lock;
+    Subscription subscription;
+    std::atomic<int> generation { 0 };  // Bumped on every change of subscription; aborts the open request
+    juce::String lastVersionId;         // Last notification seen for this project and user
+    juce::Array<juce::var> receivedNotifications;
+
+    std::atomic<bool> connected { false };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ColDawPushChannel)
+};
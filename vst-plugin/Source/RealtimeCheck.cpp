@@ -0,0 +1,121 @@
+#include "RealtimeCheck.h"
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    thread_local int sectionDepth = 0;
+}
+
+//==============================================================================
+ColDawRealtimeSection::ColDawRealtimeSection() noexcept    { ++sectionDepth; }
+ColDawRealtimeSection::~ColDawRealtimeSection() noexcept   { --sectionDepth; }
+
+bool ColDawRealtimeSection::isActive() noexcept
+{
+    return sectionDepth > 0;
+}
+
+#if COLDAW_REALTIME_CHECKS
+//==============================================================================
+namespace
+{
+    void failIfRealtime (const char* what) noexcept
+    {
+        if (sectionDepth == 0)
+            return;
+
+        // No allocation from here on - this may be the allocation that failed the check
+        sectionDepth = 0;
+        std::fprintf (stderr, "ColDaw: %s on a real-time thread\n", what);
+        std::abort();
+    }
+
+    void* allocate (std::size_t size)
+    {
+        failIfRealtime ("operator new");
+
+        if (auto* p = std::malloc (size == 0 ? 1 : size))
+            return p;
+
+        throw std::bad_alloc();
+    }
+
+    void release (void* p) noexcept
+    {
+        if (p != nullptr)
+            failIfRealtime ("operator delete");
+
+        std::free (p);
+    }
+
+    // Types aligned beyond the default go through these
+    void* allocateAligned (std::size_t size, std::align_val_t alignment)
+    {
+        failIfRealtime ("aligned operator new");
+
+        const auto align = juce::jmax ((std::size_t) alignment, sizeof (void*));
+
+       #if JUCE_WINDOWS
+        if (auto* p = _aligned_malloc (size == 0 ? 1 : size, align))
+            return p;
+       #else
+        void* p = nullptr;
+
+        if (posix_memalign (&p, align, size == 0 ? 1 : size) == 0)
+            return p;
+       #endif
+
+        throw std::bad_alloc();
+    }
+
+    void releaseAligned (void* p) noexcept
+    {
+        if (p != nullptr)
+            failIfRealtime ("aligned operator delete");
+
+       #if JUCE_WINDOWS
+        _aligned_free (p);
+       #else
+        std::free (p);
+       #endif
+    }
+
+    template <typename Allocate>
+    void* allocateNoThrow (Allocate&& allocateOrThrow) noexcept
+    {
+        try
+        {
+            return allocateOrThrow();
+        }
+        catch (...)
+        {
+            return nullptr;
+        }
+    }
+}
+
+// Replaced explicitly rather than relying on the library forwarding them
+void* operator new (std::size_t size)                                                       { return allocate (size); }
+void* operator new[] (std::size_t size)                                                     { return allocate (size); }
+void* operator new (std::size_t size, const std::nothrow_t&) noexcept                       { return allocateNoThrow ([=] { return allocate (size); }); }
+void* operator new[] (std::size_t size, const std::nothrow_t&) noexcept                     { return allocateNoThrow ([=] { return allocate (size); }); }
+void* operator new (std::size_t size, std::align_val_t a)                                   { return allocateAligned (size, a); }
+void* operator new[] (std::size_t size, std::align_val_t a)                                 { return allocateAligned (size, a); }
+void* operator new (std::size_t size, std::align_val_t a, const std::nothrow_t&) noexcept   { return allocateNoThrow ([=] { return allocateAligned (size, a); }); }
+void* operator new[] (std::size_t size, std::align_val_t a, const std::nothrow_t&) noexcept { return allocateNoThrow ([=] { return allocateAligned (size, a); }); }
+
+void operator delete (void* p) noexcept                                                     { release (p); }
+void operator delete[] (void* p) noexcept                                                   { release (p); }
+void operator delete (void* p, std::size_t) noexcept                                        { release (p); }
+void operator delete[] (void* p, std::size_t) noexcept                                      { release (p); }
+void operator delete (void* p, const std::nothrow_t&) noexcept                              { release (p); }
+void operator delete[] (void* p, const std::nothrow_t&) noexcept                            { release (p); }
+void operator delete (void* p, std::align_val_t) noexcept                                   { releaseAligned (p); }
+void operator delete[] (void* p, std::align_val_t) noexcept                                 { releaseAligned (p); }
+void operator delete (void* p, std::size_t, std::align_val_t) noexcept                      { releaseAligned (p); }
+void operator delete[] (void* p, std::size_t, std::align_val_t) noexcept                    { releaseAligned (p); }
+void operator delete (void* p, std::align_val_t, const std::nothrow_t&) noexcept            { releaseAligned (p); }
+void operator delete[] (void* p, std::align_val_t, const std::nothrow_t&) noexcept          { releaseAligned (p); }
+#endif
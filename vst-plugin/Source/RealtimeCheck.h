@@ -0,0 +1,32 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+//==============================================================================
+/**
+ * ColDaw Export Plugin - real-time safety check
+ *
+ * Marks the current thread as running real-time code for the lifetime of
+ * the object; processBlock() opens one for its whole body.
+ *
+ * Builds configured with COLDAW_REALTIME_CHECKS=ON replace the global
+ * operator new and operator delete, and any allocation or deallocation on a
+ * thread inside a section prints what happened and aborts - so running the
+ * plugin (or the Standalone build) with audio playing fails on the first
+ * allocation in the audio path. Otherwise this costs a thread-local
+ * increment and nothing is replaced.
+ *
+ * Only memory that goes through operator new/delete is seen; direct malloc
+ * calls and locks are not.
+ */
+class ColDawRealtimeSection
+{
+public:
+    ColDawRealtimeSection() noexcept;
+    ~ColDawRealtimeSection() noexcept;
+
+    /** True on a thread that is inside a section. */
+    static bool isActive() noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE (ColDawRealtimeSection)
+};
@@ -0,0 +1,390 @@
+#include "SampleSync.h"
+#include <algorithm>
+#include <set>
+
+namespace
+{
+    constexpr int maxUploadsInFlight = 4;
+    constexpr int blobTimeoutMs = 120000;  // Samples can be large; only a stalled transfer should time out
+
+    // RelativePathType for files inside the project folder
+    const juce::String relativeToProject { "3" };
+
+    using Tag = ColDawAlsReader::Tag;
+
+    /**
+     * Collects the FileRef of every SampleRef. Live 11 and later store the
+     * absolute Path and the RelativePath as values. Older sets store the
+     * relative path as one RelativePathElement per folder, with the file
+     * name in Name.
+     */
+    class SampleRefCollector : public ColDawAlsReader::Handler
+    {
+    public:
+        SampleRefCollector (const juce::File& folder, std::vector<ColDawSampleSync::SampleReference>& found)
+            : projectFolder (folder), references (found) {}
+
+        void startElement (Tag tag, std::string_view, const ColDawAlsReader::Attributes& attributes) override
+        {
+            const auto depth = (int) stack.size();
+            const auto parent = depth > 0 ? stack.back() : Tag::unknown;
+            stack.push_back (tag);
+
+            if (tag == Tag::FileRef && parent == Tag::SampleRef && fileRefDepth < 0)
+            {
+                fileRefDepth = depth;
+                fileRef = {};
+            }
+            else if (fileRefDepth >= 0 && depth == fileRefDepth + 1)
+            {
+                const auto value = ColDawAlsReader::toString (attributes.get ("Value"));
+
+                if (tag == Tag::Path)                    fileRef.path = value;
+                else if (tag == Tag::RelativePathType)   fileRef.relativePathType = value;
+                else if (tag == Tag::Name)               fileRef.name = value;
+                else if (tag == Tag::RelativePath && attributes.contains ("Value"))
+                {
+                    fileRef.relativePath = value;
+                    fileRef.hasRelativePathValue = true;
+                }
+            }
+            else if (fileRefDepth >= 0 && depth == fileRefDepth + 2
+                      && tag == Tag::RelativePathElement && parent == Tag::RelativePath)
+            {
+                fileRef.relativePathElements.add (ColDawAlsReader::toString (attributes.get ("Dir")));
+            }
+        }
+
+        void endElement (Tag, std::string_view) override
+        {
+            stack.pop_back();
+
+            if ((int) stack.size() == fileRefDepth)
+            {
+                addReference();
+                fileRefDepth = -1;
+            }
+        }
+
+    private:
+        struct FileRef
+        {
+            juce::String path, relativePathType, relativePath, name;
+            juce::StringArray relativePathElements;
+            bool hasRelativePathValue = false;
+        };
+
+        void addReference()
+        {
+            ColDawSampleSync::SampleReference reference;
+            reference.path = fileRef.path;
+
+            if (fileRef.relativePathType == relativeToProject)
+            {
+                if (fileRef.hasRelativePathValue)
+                {
+                    reference.relativePath = fileRef.relativePath;
+                }
+                else
+                {
+                    auto parts = fileRef.relativePathElements;
+                    parts.add (fileRef.name);
+                    parts.removeEmptyStrings();
+                    reference.relativePath = parts.joinIntoString ("/");
+                }
+            }
+
+            // The copy in the project folder wins: the absolute path is where it
+            // was on the machine that last saved the set
+            if (reference.relativePath.isNotEmpty() && projectFolder.getChildFile (reference.relativePath).existsAsFile())
+                reference.file = projectFolder.getChildFile (reference.relativePath);
+            else if (juce::File::isAbsolutePath (reference.path))
+                reference.file = juce::File (reference.path);
+
+            auto key = reference.file != juce::File() ? reference.file.getFullPathName()
+                                                      : reference.relativePath + "|" + reference.path;
+
+            if (key != "|" && keys.insert (key).second)
+                references.push_back (reference);
+        }
+
+        const juce::File projectFolder;
+        std::vector<ColDawSampleSync::SampleReference>& references;
+        std::set<juce::String> keys;
+        std::vector<Tag> stack;
+        int fileRefDepth = -1;
+        FileRef fileRef;
+    };
+}
+
+//==============================================================================
+ColDawSampleSync::ColDawSampleSync (Listener& l)
+    : juce::Thread ("ColDaw Sample Sync"),
+      listener (l),
+      uploadThreads (maxUploadsInFlight)
+{
+    startThread (juce::Thread::Priority::background);
+}
+
+ColDawSampleSync::~ColDawSampleSync()
+{
+    stopThread (10000);
+    uploadThreads.removeAllJobs (true, 10000);
+    cancelPendingUpdate();
+}
+
+void ColDawSampleSync::sync (const juce::File& alsFile, const juce::String& serverUrl,
+                             const juce::String& projectId, const juce::String& authToken)
+{
+    {
+        const juce::ScopedLock sl (lock);
+
+        pendingTasks.erase (std::remove_if (pendingTasks.begin(), pendingTasks.end(),
+                                            [&] (const Task& t) { return t.projectId == projectId; }),
+                            pendingTasks.end());
+
+        pendingTasks.push_back ({ alsFile, serverUrl, projectId, authToken });
+    }
+
+    notify();
+}
+
+std::vector<ColDawSampleSync::SampleReference> ColDawSampleSync::findSampleReferences (const juce::File& alsFile)
+{
+    std::vector<SampleReference> result;
+    juce::FileInputStream input (alsFile);
+
+    if (! input.openedOk())
+        return result;
+
+    SampleRefCollector collector (alsFile.getParentDirectory(), result);
+
+    if (! ColDawAlsReader::read (input, collector))
+        result.clear();
+
+    return result;
+}
+
+std::unique_ptr<ColDawAlsReader::Handler> ColDawSampleSync::createReferenceCollector (const juce::File& projectFolder,
+                                                                                     std::vector<SampleReference>& references)
+{
+    return std::make_unique<SampleRefCollector> (projectFolder, references);
+}
+
+//==============================================================================
+void ColDawSampleSync::run()
+{
+    while (! threadShouldExit())
+    {
+        Task task;
+
+        {
+            const juce::ScopedLock sl (lock);
+
+            if (! pendingTasks.empty())
+            {
+                task = pendingTasks.front();
+                pendingTasks.pop_front();
+            }
+        }
+
+        if (task.projectId.isEmpty())
+        {
+            wait (-1);
+            continue;
+        }
+
+        auto result = syncProject (task);
+
+        if (threadShouldExit())
+            break;
+
+        {
+            const juce::ScopedLock sl (lock);
+            finishedResults.push_back (std::move (result));
+        }
+
+        triggerAsyncUpdate();
+    }
+}
+
+ColDawSampleSync::Result ColDawSampleSync::syncProject (const Task& task)
+{
+    Result result;
+    result.projectId = task.projectId;
+
+    const auto references = findSampleReferences (task.alsFile);
+    result.referenced = (int) references.size();
+
+    if (references.empty())
+        return result;
+
+    // Hash everything we can find, so the server can tell us what it lacks
+    juce::Array<juce::File> files;
+
+    for (auto& reference : references)
+    {
+        if (reference.file.existsAsFile())
+            files.add (reference.file);
+        else
+            ++result.missingLocally;
+    }
+
+    const auto hashes = hashCache.hashFiles (files, *this);
+
+    if (threadShouldExit())
+        return result;
+
+    std::vector<Sample> samples;
+    juce::Array<juce::var> entries;
+
+    // files holds the references that exist, in the same order
+    int index = 0;
+
+    for (auto& reference : references)
+    {
+        if (index >= files.size() || reference.file != files[index])
+            continue;
+
+        const auto hash = hashes[index++];
+
+        if (hash.isEmpty())
+        {
+            ++result.failed;
+            continue;
+        }
+
+        Sample sample { reference, hash, reference.file.getSize() };
+
+        auto* entry = new juce::DynamicObject();
+        entry->setProperty ("path", reference.path);
+        entry->setProperty ("relativePath", reference.relativePath);
+        entry->setProperty ("sha256", sample.sha256);
+        entry->setProperty ("size", sample.size);
+        entries.add (juce::var (entry));
+
+        samples.push_back (std::move (sample));
+    }
+
+    auto* manifest = new juce::DynamicObject();
+    manifest->setProperty ("samples", entries);
+
+    const auto json = juce::JSON::toString (juce::var (manifest), true);
+    const auto authHeader = "Authorization: Bearer " + task.authToken;
+
+    const auto response = ColDawHttpClient::performWithRetry (*this, [&]
+    {
+        juce::MemoryInputStream body (json.toRawUTF8(), json.getNumBytesAsUTF8(), false);
+
+        ColDawHttpClient::Request request;
+        request.url = juce::URL (task.serverUrl + "/api/projects/" + task.projectId + "/samples");
+        request.method = "POST";
+        request.headers = authHeader + "\r\nContent-Type: application/json";
+        request.body = &body;
+        request.shouldAbort = [this] { return threadShouldExit(); };
+        return httpClient->perform (request);
+    });
+
+    if (! response.isSuccess())
+    {
+        result.errorMessage = response.connected ? "Sample list rejected (Status: " + juce::String (response.statusCode) + ")"
+                                                 : juce::String ("Could not connect to server");
+        return result;
+    }
+
+    // One file per missing hash; the same audio in two places goes up once
+    std::vector<const Sample*> toUpload;
+
+    if (auto* missing = response.getJson().getProperty ("missing", {}).getArray())
+    {
+        for (auto& hash : *missing)
+        {
+            auto sample = std::find_if (samples.begin(), samples.end(),
+                                        [&] (const Sample& s) { return s.sha256 == hash.toString(); });
+
+            if (sample != samples.end())
+                toUpload.push_back (&*sample);
+        }
+    }
+
+    // Up to maxUploadsInFlight workers take the files in order
+    std::atomic<size_t> next { 0 };
+    std::atomic<int> uploaded { 0 }, failed { 0 };
+    std::atomic<juce::int64> bytesUploaded { 0 };
+    std::atomic<int> workersLeft { juce::jmin (maxUploadsInFlight, (int) toUpload.size()) };
+    juce::WaitableEvent allDone;
+
+    if (workersLeft == 0)
+        allDone.signal();
+
+    for (int worker = juce::jmin (maxUploadsInFlight, (int) toUpload.size()); --worker >= 0;)
+    {
+        uploadThreads.addJob ([&]
+        {
+            for (auto i = next++; i < toUpload.size() && ! threadShouldExit(); i = next++)
+            {
+                juce::int64 sent = 0;
+
+                if (uploadBlob (task, *toUpload[i], sent))
+                {
+                    ++uploaded;
+                    bytesUploaded += sent;
+                }
+                else
+                {
+                    ++failed;
+                }
+            }
+
+            if (--workersLeft == 0)
+                allDone.signal();
+        });
+    }
+
+    allDone.wait();
+
+    result.uploaded = uploaded;
+    result.failed = failed;
+    result.bytesUploaded = bytesUploaded;
+    return result;
+}
+
+bool ColDawSampleSync::uploadBlob (const Task& task, const Sample& sample, juce::int64& bytesSent)
+{
+    if (! sample.reference.file.existsAsFile())
+        return false;
+
+    const auto response = ColDawHttpClient::performWithRetry (*this, [&]
+    {
+        juce::FileInputStream body (sample.reference.file);
+
+        ColDawHttpClient::Request request;
+        request.url = juce::URL (task.serverUrl + "/api/projects/blobs/" + sample.sha256);
+        request.method = "PUT";
+        request.headers = "Authorization: Bearer " + task.authToken + "\r\nContent-Type: application/octet-stream";
+        request.body = &body;
+        request.connectionTimeoutMs = blobTimeoutMs;
+        request.shouldAbort = [this] { return threadShouldExit(); };
+        return httpClient->perform (request);
+    });
+
+    // 422 means the file no longer hashes to what we said; the next export sends it
+    if (! response.isSuccess())
+        return false;
+
+    bytesSent = sample.size;
+    return true;
+}
+
+void ColDawSampleSync::handleAsyncUpdate()
+{
+    std::vector<Result> results;
+
+    {
+        const juce::ScopedLock sl (lock);
+        results.swap (finishedResults);
+    }
+
+    for (auto& result : results)
+        listener.samplesSynced (result);
+}
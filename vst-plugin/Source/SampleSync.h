@@ -0,0 +1,114 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_events/juce_events.h>
+#include <deque>
+#include <memory>
+#include <vector>
+#include "AlsReader.h"
+#include "HttpClient.h"
+#include "HashCache.h"
+
+//==============================================================================
+/**
+ * ColDaw Export Plugin - Sample Sync
+ *
+ * Uploads the audio a project refers to, so collaborators who pull a version
+ * get its samples as well as the .als. Samples are stored on the server by
+ * content (their SHA-256), not per project.
+ *
+ * After a project has been uploaded, its SampleRef/FileRef entries are read
+ * and each referenced file that exists on this machine is hashed (through
+ * the persistent hash cache, so unchanged files aren't read again). One request
+ * sends the project's sample list to the server, which records it and answers
+ * with the hashes it doesn't have yet. Only those files are sent, several at
+ * a time, so a sample library shared by many projects is uploaded only once.
+ *
+ * All of this runs on a background thread; each finished project is reported
+ * to the Listener on the message thread.
+ */
+class ColDawSampleSync : private juce::Thread,
+                         private juce::AsyncUpdater
+{
+public:
+    //==============================================================================
+    /** One sample file referenced by a project. */
+    struct SampleReference
+    {
+        juce::String path;          // Absolute path as stored in the set, if any
+        juce::String relativePath;  // Path inside the project folder ("Samples/Recorded/x.wav"), if it is there
+        juce::File file;            // The file on this machine; doesn't exist if the sample is missing
+    };
+
+    /** Outcome of syncing one project's samples, delivered on the message thread. */
+    struct Result
+    {
+        juce::String projectId;
+        int referenced = 0;           // Distinct sample files the project refers to
+        int missingLocally = 0;       // ...of which this many couldn't be found here
+        int uploaded = 0;             // Files the server didn't have and now does
+        int failed = 0;               // Files that couldn't be sent
+        juce::int64 bytesUploaded = 0;
+        juce::String errorMessage;    // Set if the sync stopped before any uploads
+    };
+
+    class Listener
+    {
+    public:
+        virtual ~Listener() = default;
+
+        /** Called on the message thread once a project's samples are synced. */
+        virtual void samplesSynced (const Result& result) = 0;
+    };
+
+    //==============================================================================
+    explicit ColDawSampleSync (Listener& listener);
+    ~ColDawSampleSync() override;
+
+    /** Queues a sync of the samples this set refers to. A sync already queued
+        for the same project is replaced.
+    */
+    void sync (const juce::File& alsFile, const juce::String& serverUrl,
+               const juce::String& projectId, const juce::String& authToken);
+
+    /** Reads the sample files a (gzipped) set refers to, one entry per file. */
+    static std::vector<SampleReference> findSampleReferences (const juce::File& alsFile);
+
+    /** The handler behind findSampleReferences, for reading a set alongside other
+        handlers. Adds each distinct file to references as it is read.
+    */
+    static std::unique_ptr<ColDawAlsReader::Handler> createReferenceCollector (const juce::File& projectFolder,
+                                                                              std::vector<SampleReference>& references);
+
+private:
+    //==============================================================================
+    struct Task
+    {
+        juce::File alsFile;
+        juce::String serverUrl, projectId, authToken;
+    };
+
+    struct Sample
+    {
+        SampleReference reference;
+        juce::String sha256;
+        juce::int64 size = 0;
+    };
+
+    void run() override;
+    Result syncProject (const Task&);
+    bool uploadBlob (const Task&, const Sample&, juce::int64& bytesSent);
+    void handleAsyncUpdate() override;
+
+    Listener& listener;
+    juce::SharedResourcePointer<ColDawHttpClient> httpClient;
+    juce::ThreadPool uploadThreads;
+    ColDawHashCache hashCache { juce::File::getSpecialLocation (juce::File::userApplicationDataDirectory)
+                                    .getChildFile ("ColDaw").getChildFile ("hash_cache.json") };
+
+    juce::CriticalSection lock;
+    std::deque<Task> pendingTasks;
+    std::vector<Result> finishedResults;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ColDawSampleSync)
+};
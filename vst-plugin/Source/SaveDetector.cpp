@@ -0,0 +1,216 @@
+#include "SaveDetector.h"
+#include <array>
+#include <vector>
+
+namespace
+{
+    constexpr int checkIntervalMs = 250;
+    const juce::RelativeTime settleTime = juce::RelativeTime::milliseconds (500);
+    const juce::RelativeTime giveUpTime = juce::RelativeTime::seconds (30.0);
+
+    juce::uint32 updateCrc32 (juce::uint32 crc, const juce::uint8* data, size_t size) noexcept
+    {
+        static const auto table = []
+        {
+            std::array<juce::uint32, 256> entries {};
+
+            for (juce::uint32 i = 0; i < 256; ++i)
+            {
+                auto value = i;
+
+                for (int bit = 0; bit < 8; ++bit)
+                    value = (value & 1) != 0 ? 0xedb88320u ^ (value >> 1) : value >> 1;
+
+                entries[i] = value;
+            }
+
+            return entries;
+        }();
+
+        for (size_t i = 0; i < size; ++i)
+            crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+
+        return crc;
+    }
+}
+
+//==============================================================================
+ColDawSaveDetector::ColDawSaveDetector (Listener& l)
+    : juce::Thread ("ColDaw Save Detector"),
+      listener (l)
+{
+    startThread (juce::Thread::Priority::background);
+}
+
+ColDawSaveDetector::~ColDawSaveDetector()
+{
+    stopThread (4000);
+    cancelPendingUpdate();
+}
+
+void ColDawSaveDetector::fileChanged (const juce::File& file)
+{
+    {
+        const juce::ScopedLock sl (lock);
+        pendingSaves[file] = {};
+    }
+
+    notify();
+}
+
+void ColDawSaveDetector::setMinimumInterval (juce::RelativeTime interval)
+{
+    const juce::ScopedLock sl (lock);
+    minimumInterval = interval;
+}
+
+juce::RelativeTime ColDawSaveDetector::getMinimumInterval() const
+{
+    const juce::ScopedLock sl (lock);
+    return minimumInterval;
+}
+
+//==============================================================================
+void ColDawSaveDetector::run()
+{
+    while (! threadShouldExit())
+    {
+        std::vector<juce::File> files;
+
+        {
+            const juce::ScopedLock sl (lock);
+
+            for (auto& pending : pendingSaves)
+                files.push_back (pending.first);
+        }
+
+        if (files.empty())
+        {
+            wait (-1);
+            continue;
+        }
+
+        bool anyCompleted = false;
+
+        for (auto& file : files)
+        {
+            // File I/O happens outside the lock; fileChanged() may reset an
+            // entry meanwhile, which just means it is measured again
+            const auto size = file.getSize();
+            const auto modified = file.getLastModificationTime();
+            const auto now = juce::Time::getCurrentTime();
+            bool needsCheck = false;
+
+            {
+                const juce::ScopedLock sl (lock);
+                auto pending = pendingSaves.find (file);
+                if (pending == pendingSaves.end())
+                    continue;
+
+                auto& save = pending->second;
+
+                if (size != save.size || modified != save.modified)
+                {
+                    save.size = size;
+                    save.modified = modified;
+                    save.stableSince = now;
+                    save.checked = false;
+                    continue;
+                }
+
+                needsCheck = ! save.checked && now - save.stableSince >= settleTime;
+            }
+
+            const bool complete = needsCheck && isCompleteFile (file);
+
+            const juce::ScopedLock sl (lock);
+            auto pending = pendingSaves.find (file);
+            if (pending == pendingSaves.end())
+                continue;
+
+            auto& save = pending->second;
+
+            if (needsCheck && save.size == size && save.modified == modified)
+            {
+                save.checked = true;
+                save.complete = complete;
+            }
+
+            if (save.checked && save.complete)
+            {
+                // Hold back saves that come too soon after the last one we reported
+                auto reported = lastReported.find (file);
+                if (reported != lastReported.end() && now - reported->second < minimumInterval)
+                    continue;
+
+                lastReported[file] = now;
+                completedSaves.addIfNotAlreadyThere (file);
+                pendingSaves.erase (pending);
+                anyCompleted = true;
+            }
+            else if (save.checked && now - save.stableSince > giveUpTime)
+            {
+                // Stable but still not a valid gzip stream - a damaged file, not a save in progress
+                pendingSaves.erase (pending);
+            }
+        }
+
+        if (anyCompleted)
+            triggerAsyncUpdate();
+
+        wait (checkIntervalMs);
+    }
+}
+
+void ColDawSaveDetector::handleAsyncUpdate()
+{
+    juce::Array<juce::File> files;
+
+    {
+        const juce::ScopedLock sl (lock);
+        files.swapWith (completedSaves);
+    }
+
+    for (auto& file : files)
+        listener.saveCompleted (file);
+}
+
+//==============================================================================
+bool ColDawSaveDetector::isCompleteFile (const juce::File& file)
+{
+    juce::FileInputStream input (file);
+    juce::uint8 magic[2] = {};
+
+    if (! input.openedOk() || input.read (magic, 2) != 2)
+        return false;
+
+    // Plain XML sets have no trailer; stable size and mtime is all we can go on
+    if (magic[0] != 0x1f || magic[1] != 0x8b)
+        return true;
+
+    const auto totalLength = input.getTotalLength();
+    if (totalLength < 18)
+        return false;
+
+    // The trailer holds the CRC-32 and length (mod 2^32) of the inflated data
+    input.setPosition (totalLength - 8);
+    const auto expectedCrc = (juce::uint32) input.readInt();
+    const auto expectedSize = (juce::uint32) input.readInt();
+    input.setPosition (0);
+
+    juce::GZIPDecompressorInputStream inflated (&input, false, juce::GZIPDecompressorInputStream::gzipFormat);
+    juce::HeapBlock<juce::uint8> buffer (65536);
+    juce::uint32 crc = 0xffffffff, size = 0;
+
+    for (;;)
+    {
+        const auto numRead = inflated.read (buffer, 65536);
+        if (numRead <= 0)
+            break;
+
+        crc = updateCrc32 (crc, buffer, (size_t) numRead);
+        size += (juce::uint32) numRead;
+    }
+
+    return (crc ^ 0xffffffff) == expectedCrc && size == expectedSize;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_events/juce_events.h>
+#include <map>
+
+//==============================================================================
+/**
+ * ColDaw Export Plugin - Save Detector
+ *
+ * Decides when Live has finished writing a project. A changed file is watched
+ * on a background thread until its size and mtime have stopped moving and,
+ * for gzipped sets, the gzip trailer (CRC-32 and ISIZE) matches the inflated
+ * data. Repeated saves of the same file are coalesced: a completed save is
+ * held back until the minimum interval since the last one has passed, and
+ * only the latest state is reported.
+ */
+class ColDawSaveDetector : private juce::Thread,
+                           private juce::AsyncUpdater
+{
+public:
+    //==============================================================================
+    class Listener
+    {
+    public:
+        virtual ~Listener() = default;
+
+        /** Called on the message thread once a save has completed. */
+        virtual void saveCompleted (const juce::File& file) = 0;
+    };
+
+    //==============================================================================
+    explicit ColDawSaveDetector (Listener& listener);
+    ~ColDawSaveDetector() override;
+
+    /** Starts (or restarts) waiting for this file's save to complete. */
+    void fileChanged (const juce::File& file);
+
+    /** Minimum time between two reported saves of the same file. */
+    void setMinimumInterval (juce::RelativeTime interval);
+    juce::RelativeTime getMinimumInterval() const;
+
+    /** True if the file is a complete gzip stream, or isn't gzipped at all. */
+    static bool isCompleteFile (const juce::File& file);
+
+private:
+    //==============================================================================
+    struct PendingSave
+    {
+        juce::int64 size = -1;
+        juce::Time modified;
+        juce::Time stableSince;
+        bool checked = false;   // Whether the current size and mtime have been validated
+        bool complete = false;  // Result of that validation
+    };
+
+    void run() override;
+    void handleAsyncUpdate() override;
+
+    Listener& listener;
+
+    juce::CriticalSection lock;
+    std::map<juce::File, PendingSave> pendingSaves;
+    std::map<juce::File, juce::Time> lastReported;
+    juce::Array<juce::File> completedSaves;
+    juce::RelativeTime minimumInterval { juce::RelativeTime::seconds (5.0) };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ColDawSaveDetector)
+};
@@ -0,0 +1,380 @@
+#include "SemanticDelta.h"
+#include "Sha256.h"
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+    constexpr int formatVersion = 1;
+
+    using Model = ColDawProjectModel;
+    using Index = ColDawProjectModel::Index;
+    using Tag = ColDawAlsReader::Tag;
+
+    /** Elements whose Value Live rewrites on every save without any real change. */
+    bool isVolatileAttribute (const Model& model, Index element, std::string_view name)
+    {
+        const auto tag = model.getTag (element);
+
+        return name == "Value"
+            && (tag == Tag::LomId || tag == Tag::LomIdView || tag == Tag::OverwriteProtectionNumber);
+    }
+
+    void appendEscaped (std::string& out, std::string_view text)
+    {
+        size_t plain = 0;
+
+        for (size_t i = 0; i < text.size(); ++i)
+        {
+            const char* replacement = nullptr;
+
+            switch (text[i])
+            {
+                case '&':  replacement = "&amp;";  break;
+                case '<':  replacement = "&lt;";   break;
+                case '>':  replacement = "&gt;";   break;
+                case '"':  replacement = "&quot;"; break;
+                case '\t': replacement = "&#9;";   break;
+                case '\n': replacement = "&#10;";  break;
+                case '\r': replacement = "&#13;";  break;
+                default:   continue;
+            }
+
+            out.append (text.substr (plain, i - plain));
+            out += replacement;
+            plain = i + 1;
+        }
+
+        out.append (text.substr (plain));
+    }
+
+    /** Sorted, non-volatile attributes - all that identifies an element besides its name and children. */
+    void getCanonicalAttributes (const Model& model, Index element, std::vector<Model::Attribute>& attributes)
+    {
+        attributes.clear();
+
+        for (int i = 0; i < model.getNumAttributes (element); ++i)
+        {
+            const auto attribute = model.getAttribute (element, i);
+
+            if (! isVolatileAttribute (model, element, attribute.name))
+                attributes.push_back (attribute);
+        }
+
+        std::sort (attributes.begin(), attributes.end(), [] (const auto& a, const auto& b) { return a.name < b.name; });
+    }
+
+    void appendStartTag (std::string& out, std::string_view name, const std::vector<Model::Attribute>& attributes)
+    {
+        out += '<';
+        out.append (name);
+
+        for (auto& attribute : attributes)
+        {
+            out += ' ';
+            out.append (attribute.name);
+            out += "=\"";
+            appendEscaped (out, attribute.value);
+            out += '"';
+        }
+    }
+
+    /**
+     * Streams the canonical form of a subtree into a SHA-256, a buffer at a
+     * time. A subtree is a contiguous range of elements, so this is a loop
+     * with a stack of open elements rather than a recursion.
+     */
+    juce::String hashCanonical (const Model& model, Index root)
+    {
+        ColDawSha256 hash;
+        std::string buffer;
+        std::vector<Index> open;
+        std::vector<Model::Attribute> attributes;
+
+        auto closeElement = [&]
+        {
+            buffer += "</";
+            buffer.append (model.getName (open.back()));
+            buffer += '>';
+            open.pop_back();
+        };
+
+        for (auto element = root; element < model.getEnd (root); ++element)
+        {
+            while (! open.empty() && element >= model.getEnd (open.back()))
+                closeElement();
+
+            getCanonicalAttributes (model, element, attributes);
+            appendStartTag (buffer, model.getName (element), attributes);
+            buffer += '>';
+            open.push_back (element);
+
+            if (buffer.size() > 1 << 16)
+            {
+                hash.update (buffer.data(), buffer.size());
+                buffer.clear();
+            }
+        }
+
+        while (! open.empty())
+            closeElement();
+
+        hash.update (buffer.data(), buffer.size());
+        return hash.finish();
+    }
+
+    /** A subtree as XML on one line, attributes in their original order. */
+    void appendElement (std::string& out, const Model& model, Index element)
+    {
+        std::vector<Model::Attribute> attributes;
+
+        for (int i = 0; i < model.getNumAttributes (element); ++i)
+            attributes.push_back (model.getAttribute (element, i));
+
+        appendStartTag (out, model.getName (element), attributes);
+
+        if (model.getFirstChild (element) == ColDawProjectModel::noElement)
+        {
+            out += "/>";
+            return;
+        }
+
+        out += '>';
+
+        for (auto child = model.getFirstChild (element); child != ColDawProjectModel::noElement; child = model.getNextSibling (child))
+            appendElement (out, model, child);
+
+        out += "</";
+        out.append (model.getName (element));
+        out += '>';
+    }
+
+    juce::String toString (std::string_view text)
+    {
+        return juce::String::fromUTF8 (text.data(), (int) text.size());
+    }
+
+    //==============================================================================
+    struct HashKey
+    {
+        size_t operator() (const Model::Hash& hash) const noexcept   { return (size_t) hash.low; }
+    };
+
+    bool haveSameAttributes (const Model& baseModel, Index base, const Model& targetModel, Index target)
+    {
+        std::vector<Model::Attribute> a, b;
+        getCanonicalAttributes (baseModel, base, a);
+        getCanonicalAttributes (targetModel, target, b);
+
+        return std::equal (a.begin(), a.end(), b.begin(), b.end(), [] (const auto& x, const auto& y)
+        {
+            return x.name == y.name && x.value == y.value;
+        });
+    }
+
+    /** Pairs an edited element with the base element it most likely came from: tag, and Id if it has one. */
+    using Identity = std::tuple<std::string_view, bool, std::string_view>;
+
+    Identity getIdentity (const Model& model, Index element)
+    {
+        return { model.getName (element), model.hasAttribute (element, "Id"), model.getAttributeValue (element, "Id") };
+    }
+
+    class EditScriptBuilder
+    {
+    public:
+        EditScriptBuilder (const Model& b, const Model& t) : baseModel (b), targetModel (t) {}
+
+        juce::var diffElements (Index base, Index target)
+        {
+            auto* edit = new juce::DynamicObject();
+            juce::var result (edit);
+
+            if (! haveSameAttributes (baseModel, base, targetModel, target))
+            {
+                juce::Array<juce::var> attributes;
+
+                for (int i = 0; i < targetModel.getNumAttributes (target); ++i)
+                {
+                    const auto attribute = targetModel.getAttribute (target, i);
+                    attributes.add (juce::Array<juce::var> { toString (attribute.name), toString (attribute.value) });
+                }
+
+                edit->setProperty ("a", attributes);
+            }
+
+            const auto b = baseModel.getChildren (base);
+            const auto t = targetModel.getChildren (target);
+
+            const auto sameChildren = std::equal (b.begin(), b.end(), t.begin(), t.end(), [this] (Index x, Index y)
+            {
+                return baseModel.getHash (x) == targetModel.getHash (y);
+            });
+
+            if (! sameChildren)
+                edit->setProperty ("c", diffChildren (b, t));
+
+            return result;
+        }
+
+    private:
+        juce::var diffChildren (const std::vector<Index>& b, const std::vector<Index>& t)
+        {
+            const auto m = b.size(), n = t.size();
+            auto baseHash = [&] (size_t i) -> const Model::Hash&   { return baseModel.getHash (b[i]); };
+            auto targetHash = [&] (size_t j) -> const Model::Hash& { return targetModel.getHash (t[j]); };
+
+            std::vector<int> unchangedFrom (n, -1), editedFrom (n, -1);
+            std::vector<bool> used (m, false);
+
+            // Common prefix and suffix are by far the usual case
+            size_t prefix = 0, suffix = 0;
+
+            for (; prefix < m && prefix < n && baseHash (prefix) == targetHash (prefix); ++prefix)
+                unchangedFrom[prefix] = (int) prefix;
+
+            for (; suffix < m - prefix && suffix < n - prefix && baseHash (m - 1 - suffix) == targetHash (n - 1 - suffix); ++suffix)
+                unchangedFrom[n - 1 - suffix] = (int) (m - 1 - suffix);
+
+            // Anything else that is unchanged, including moved subtrees
+            std::unordered_map<Model::Hash, std::deque<int>, HashKey> unusedByHash;
+
+            for (auto i = prefix; i < m - suffix; ++i)
+                unusedByHash[baseHash (i)].push_back ((int) i);
+
+            for (auto j = prefix; j < n - suffix; ++j)
+            {
+                auto found = unusedByHash.find (targetHash (j));
+
+                if (found != unusedByHash.end() && ! found->second.empty())
+                {
+                    unchangedFrom[j] = found->second.front();
+                    used[(size_t) unchangedFrom[j]] = true;
+                    found->second.pop_front();
+                }
+            }
+
+            // Edited elements: same tag and Id if there is one, else just the same tag
+            std::map<Identity, std::deque<int>> unusedByIdentity;
+            std::map<std::string_view, std::deque<int>> unusedByTag;
+
+            for (auto i = prefix; i < m - suffix; ++i)
+            {
+                if (! used[i])
+                {
+                    unusedByIdentity[getIdentity (baseModel, b[i])].push_back ((int) i);
+                    unusedByTag[baseModel.getName (b[i])].push_back ((int) i);
+                }
+            }
+
+            auto takeUnused = [&used] (std::deque<int>& candidates)
+            {
+                while (! candidates.empty())
+                {
+                    const auto index = candidates.front();
+                    candidates.pop_front();
+
+                    if (! used[(size_t) index])
+                    {
+                        used[(size_t) index] = true;
+                        return index;
+                    }
+                }
+
+                return -1;
+            };
+
+            for (auto j = prefix; j < n - suffix; ++j)
+            {
+                if (unchangedFrom[j] >= 0)
+                    continue;
+
+                editedFrom[j] = takeUnused (unusedByIdentity[getIdentity (targetModel, t[j])]);
+
+                if (editedFrom[j] < 0)
+                    editedFrom[j] = takeUnused (unusedByTag[targetModel.getName (t[j])]);
+            }
+
+            // Emit in target order, collapsing unchanged runs into [start, count]
+            juce::Array<juce::var> entries;
+            int runStart = -1, runCount = 0;
+
+            auto flushRun = [&]
+            {
+                if (runCount > 0)
+                    entries.add (juce::Array<juce::var> { runStart, runCount });
+
+                runCount = 0;
+            };
+
+            for (size_t j = 0; j < n; ++j)
+            {
+                if (unchangedFrom[j] >= 0)
+                {
+                    if (runCount > 0 && unchangedFrom[j] == runStart + runCount)
+                    {
+                        ++runCount;
+                    }
+                    else
+                    {
+                        flushRun();
+                        runStart = unchangedFrom[j];
+                        runCount = 1;
+                    }
+
+                    continue;
+                }
+
+                flushRun();
+
+                if (editedFrom[j] >= 0)
+                {
+                    auto edit = diffElements (b[(size_t) editedFrom[j]], t[j]);
+                    edit.getDynamicObject()->setProperty ("i", editedFrom[j]);
+                    entries.add (edit);
+                    continue;
+                }
+
+                std::string xml;
+                appendElement (xml, targetModel, t[j]);
+
+                auto* literal = new juce::DynamicObject();
+                literal->setProperty ("x", toString (xml));
+                entries.add (juce::var (literal));
+            }
+
+            flushRun();
+            return entries;
+        }
+
+        const Model& baseModel;
+        const Model& targetModel;
+    };
+}
+
+//==============================================================================
+juce::String ColDawSemanticDelta::getCanonicalHash (const ColDawProjectModel& model, ColDawProjectModel::Index element)
+{
+    return hashCanonical (model, element);
+}
+
+juce::var ColDawSemanticDelta::createEditScript (const ColDawProjectModel& base, const ColDawProjectModel& target)
+{
+    if (base.getName (0) != target.getName (0))
+        return {};
+
+    auto* script = new juce::DynamicObject();
+    juce::var result (script);
+
+    script->setProperty ("format", formatVersion);
+    script->setProperty ("baseHash", getCanonicalHash (base));
+    script->setProperty ("targetHash", getCanonicalHash (target));
+    script->setProperty ("root", EditScriptBuilder (base, target).diffElements (0, 0));
+
+    return result;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include "ProjectModel.h"
+
+//==============================================================================
+/**
+ * ColDaw Export Plugin - semantic (XML-level) delta
+ *
+ * A .als is gzipped XML, so a one-clip edit changes bytes all over the
+ * compressed file. This works on the inflated document instead: both versions
+ * are read into a ColDawProjectModel, whose subtree hashes of the canonical
+ * form say which subtrees are unchanged, and the result is an edit script
+ * that reuses the base version's subtrees wherever they are.
+ *
+ * Canonical form (mirrored in server/src/utils/alsXml.ts): attributes sorted
+ * by name, the Value of volatile elements (LomId, LomIdView,
+ * OverwriteProtectionNumber) left out, whitespace-only text dropped.
+ *
+ * Edit script (JSON): { format, baseHash, targetHash, root }, where root is an
+ * element edit { a?: [[name, value], ...], c?: [child, ...] } and each child
+ * is one of
+ *   [start, count]          base children start..start+count-1, unchanged
+ *   { i, a?, c? }           base child i, edited
+ *   { x: "<Element .../>" } a new element
+ *   { t: "text" }           a new text node (never sent by the plugin; the
+ *                           model keeps no text)
+ */
+class ColDawSemanticDelta
+{
+public:
+    //==============================================================================
+    /** Hex SHA-256 of the canonical form of the subtree at element (the whole document by default). */
+    static juce::String getCanonicalHash (const ColDawProjectModel& model, ColDawProjectModel::Index element = 0);
+
+    /** Builds the edit script that turns base into target, or a void var if
+        the documents don't share a root element.
+    */
+    static juce::var createEditScript (const ColDawProjectModel& base, const ColDawProjectModel& target);
+
+private:
+    ColDawSemanticDelta() = delete;
+};
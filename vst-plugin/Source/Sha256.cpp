@@ -0,0 +1,162 @@
+#include "Sha256.h"
+
+#ifndef COLDAW_HAS_OPENSSL
+ #define COLDAW_HAS_OPENSSL 0
+#endif
+
+#if COLDAW_HAS_OPENSSL
+ #include <openssl/evp.h>
+#endif
+
+namespace
+{
+    constexpr int readBlockSize = 1 << 20;
+
+    constexpr std::array<juce::uint32, 64> roundConstants {{
+        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+        0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+        0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+        0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+        0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+        0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+        0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+        0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+    }};
+
+    inline juce::uint32 rotateRight (juce::uint32 x, int n) noexcept  { return (x >> n) | (x << (32 - n)); }
+}
+
+//==============================================================================
+#if COLDAW_HAS_OPENSSL
+struct ColDawSha256::OpenSslContext
+{
+    OpenSslContext()   { EVP_DigestInit_ex (context, EVP_sha256(), nullptr); }
+    ~OpenSslContext()  { EVP_MD_CTX_free (context); }
+
+    EVP_MD_CTX* context = EVP_MD_CTX_new();
+};
+#else
+struct ColDawSha256::OpenSslContext {};
+#endif
+
+ColDawSha256::ColDawSha256()
+    : state ({{ 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 }})
+{
+   #if COLDAW_HAS_OPENSSL
+    openSsl = std::make_unique<OpenSslContext>();
+   #endif
+}
+
+ColDawSha256::~ColDawSha256() = default;
+
+//==============================================================================
+void ColDawSha256::update (const void* data, size_t numBytes)
+{
+   #if COLDAW_HAS_OPENSSL
+    EVP_DigestUpdate (openSsl->context, data, numBytes);
+   #else
+    auto* bytes = static_cast<const juce::uint8*> (data);
+    totalBytes += numBytes;
+
+    if (numPending > 0)
+    {
+        const auto numToCopy = juce::jmin (numBytes, pending.size() - numPending);
+        std::memcpy (pending.data() + numPending, bytes, numToCopy);
+        numPending += numToCopy;
+        bytes += numToCopy;
+        numBytes -= numToCopy;
+
+        if (numPending < pending.size())
+            return;
+
+        processBlock (pending.data());
+        numPending = 0;
+    }
+
+    for (; numBytes >= pending.size(); bytes += pending.size(), numBytes -= pending.size())
+        processBlock (bytes);
+
+    std::memcpy (pending.data(), bytes, numBytes);
+    numPending = numBytes;
+   #endif
+}
+
+bool ColDawSha256::update (juce::InputStream& input, const std::function<bool()>& shouldAbort)
+{
+    juce::HeapBlock<char> buffer (readBlockSize);
+
+    for (;;)
+    {
+        if (shouldAbort != nullptr && shouldAbort())
+            return false;
+
+        const auto numRead = input.read (buffer, readBlockSize);
+
+        if (numRead < 0)
+            return false;
+
+        if (numRead == 0)
+            return true;
+
+        update (buffer, (size_t) numRead);
+    }
+}
+
+juce::String ColDawSha256::finish()
+{
+    juce::uint8 digest[32];
+
+   #if COLDAW_HAS_OPENSSL
+    unsigned int digestSize = 0;
+    EVP_DigestFinal_ex (openSsl->context, digest, &digestSize);
+   #else
+    const auto bitLength = totalBytes * 8;
+
+    // 0x80, zeros up to 56 bytes into a block, then the length in bits
+    juce::uint8 padding[72] = { 0x80 };
+    const auto paddingSize = (numPending < 56 ? 56 : 120) - numPending;
+
+    for (int i = 0; i < 8; ++i)
+        padding[paddingSize + (size_t) i] = (juce::uint8) (bitLength >> (56 - 8 * i));
+
+    update (padding, paddingSize + 8);
+
+    for (size_t i = 0; i < state.size(); ++i)
+        for (size_t j = 0; j < 4; ++j)
+            digest[i * 4 + j] = (juce::uint8) (state[i] >> (24 - 8 * j));
+   #endif
+
+    return juce::String::toHexString (digest, 32, 0);
+}
+
+void ColDawSha256::processBlock (const juce::uint8* block) noexcept
+{
+    juce::uint32 w[64];
+
+    for (int i = 0; i < 16; ++i)
+        w[i] = juce::ByteOrder::bigEndianInt (block + 4 * i);
+
+    for (int i = 16; i < 64; ++i)
+    {
+        const auto s0 = rotateRight (w[i - 15], 7) ^ rotateRight (w[i - 15], 18) ^ (w[i - 15] >> 3);
+        const auto s1 = rotateRight (w[i - 2], 17) ^ rotateRight (w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    auto a = state[0], b = state[1], c = state[2], d = state[3];
+    auto e = state[4], f = state[5], g = state[6], h = state[7];
+
+    for (int i = 0; i < 64; ++i)
+    {
+        const auto t1 = h + (rotateRight (e, 6) ^ rotateRight (e, 11) ^ rotateRight (e, 25))
+                          + ((e & f) ^ (~e & g)) + roundConstants[(size_t) i] + w[i];
+        const auto t2 = (rotateRight (a, 2) ^ rotateRight (a, 13) ^ rotateRight (a, 22))
+                          + ((a & b) ^ (a & c) ^ (b & c));
+
+        h = g;  g = f;  f = e;  e = d + t1;
+        d = c;  c = b;  b = a;  a = t1 + t2;
+    }
+
+    state[0] += a;  state[1] += b;  state[2] += c;  state[3] += d;
+    state[4] += e;  state[5] += f;  state[6] += g;  state[7] += h;
+}
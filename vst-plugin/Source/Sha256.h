@@ -0,0 +1,46 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+#include <functional>
+
+//==============================================================================
+/**
+ * ColDaw Export Plugin - incremental SHA-256
+ *
+ * Hashes data fed in pieces, so a file can be hashed as it is read or
+ * downloaded instead of in a second pass. With OpenSSL this uses its SHA-256
+ * kernels (SHA-NI or AVX2 where the CPU has them); otherwise a portable
+ * implementation.
+ */
+class ColDawSha256
+{
+public:
+    //==============================================================================
+    ColDawSha256();
+    ~ColDawSha256();
+
+    /** Adds more data to the hash. */
+    void update (const void* data, size_t numBytes);
+
+    /** Adds everything the stream has left; false if the stream failed or shouldAbort said so. */
+    bool update (juce::InputStream& input, const std::function<bool()>& shouldAbort = nullptr);
+
+    /** Finishes the hash and returns it as lower-case hex. Call once. */
+    juce::String finish();
+
+private:
+    //==============================================================================
+    struct OpenSslContext;
+
+    void processBlock (const juce::uint8* block) noexcept;
+
+    std::unique_ptr<OpenSslContext> openSsl;  // Null without OpenSSL
+
+    std::array<juce::uint32, 8> state;
+    std::array<juce::uint8, 64> pending;
+    size_t numPending = 0;
+    juce::uint64 totalBytes = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ColDawSha256)
+};
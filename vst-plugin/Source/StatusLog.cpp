@@ -0,0 +1,147 @@
+#include "StatusLog.h"
+
+//==============================================================================
+ColDawStatusLog::ColDawStatusLog (Listener& l, int historySize)
+    : listener (l),
+      slots (new Slot[queueSize]),
+      history ((size_t) juce::jmax (1, historySize))
+{
+    static_assert ((queueSize & (queueSize - 1)) == 0, "queueSize must be a power of two");
+
+    for (size_t i = 0; i < queueSize; ++i)
+        slots[i].sequence.store (i, std::memory_order_relaxed);
+}
+
+ColDawStatusLog::~ColDawStatusLog()
+{
+    cancelPendingUpdate();
+}
+
+bool ColDawStatusLog::post (Severity severity, Operation operation, const juce::String& message, double durationSeconds)
+{
+    auto position = enqueuePosition.load (std::memory_order_relaxed);
+    Slot* slot = nullptr;
+
+    for (;;)
+    {
+        slot = &slots[position & (queueSize - 1)];
+        const auto sequence = slot->sequence.load (std::memory_order_acquire);
+        const auto difference = (std::ptrdiff_t) (sequence - position);
+
+        if (difference == 0)
+        {
+            if (enqueuePosition.compare_exchange_weak (position, position + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if (difference < 0)
+        {
+            // Full: the message thread hasn't drained for a whole queue's worth of events
+            droppedEvents.fetch_add (1, std::memory_order_relaxed);
+            triggerAsyncUpdate();
+            return false;
+        }
+        else
+        {
+            position = enqueuePosition.load (std::memory_order_relaxed);
+        }
+    }
+
+    slot->event.time = juce::Time::getCurrentTime();
+    slot->event.severity = severity;
+    slot->event.operation = operation;
+    slot->event.message = message;
+    slot->event.durationSeconds = durationSeconds;
+    slot->sequence.store (position + 1, std::memory_order_release);
+
+    triggerAsyncUpdate();
+    return true;
+}
+
+//==============================================================================
+const ColDawStatusLog::Event& ColDawStatusLog::getEvent (int index) const
+{
+    jassert (juce::isPositiveAndBelow (index, (int) historyCount));
+    return history[(historyStart + (size_t) index) % history.size()];
+}
+
+const ColDawStatusLog::Event& ColDawStatusLog::getLatest() const
+{
+    return historyCount > 0 ? getEvent ((int) historyCount - 1) : noEvent;
+}
+
+juce::String ColDawStatusLog::getName (Operation operation)
+{
+    switch (operation)
+    {
+        case Operation::login:   return "Login";
+        case Operation::project: return "Project";
+        case Operation::upload:  return "Upload";
+        case Operation::samples: return "Samples";
+        case Operation::update:  return "Update";
+        case Operation::audio:   return "Audio";
+    }
+
+    return {};
+}
+
+//==============================================================================
+void ColDawStatusLog::handleAsyncUpdate()
+{
+    bool added = false;
+
+    for (;;)
+    {
+        auto& slot = slots[dequeuePosition & (queueSize - 1)];
+
+        if (slot.sequence.load (std::memory_order_acquire) != dequeuePosition + 1)
+            break;
+
+        addToHistory (std::move (slot.event));
+        slot.event = {};
+        slot.sequence.store (dequeuePosition + queueSize, std::memory_order_release);
+        ++dequeuePosition;
+        added = true;
+    }
+
+    if (const auto dropped = droppedEvents.exchange (0, std::memory_order_relaxed))
+    {
+        Event event;
+        event.time = juce::Time::getCurrentTime();
+        event.severity = Severity::warning;
+        event.operation = getLatest().operation;
+        event.message = juce::String (dropped) + (dropped == 1 ? " status message" : " status messages") + " lost";
+        addToHistory (std::move (event));
+        added = true;
+    }
+
+    if (added)
+        listener.statusLogChanged();
+}
+
+void ColDawStatusLog::addToHistory (Event event)
+{
+    event.id = ++lastId;
+
+    // Progress of one operation is a single line that keeps being updated
+    if (event.severity == Severity::progress && historyCount > 0)
+    {
+        auto& latest = history[(historyStart + historyCount - 1) % history.size()];
+
+        if (latest.severity == Severity::progress && latest.operation == event.operation)
+        {
+            latest = std::move (event);
+            return;
+        }
+    }
+
+    if (historyCount < history.size())
+    {
+        history[(historyStart + historyCount) % history.size()] = std::move (event);
+        ++historyCount;
+    }
+    else
+    {
+        history[historyStart] = std::move (event);
+        historyStart = (historyStart + 1) % history.size();
+    }
+}
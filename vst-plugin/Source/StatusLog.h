@@ -0,0 +1,111 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_events/juce_events.h>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+//==============================================================================
+/**
+ * ColDaw Export Plugin - status log
+ *
+ * Status messages as typed events (severity, operation, time, how long the
+ * operation took) instead of one string that every path overwrites.
+ *
+ * Any thread can post. Posting claims a slot in a fixed-size lock-free
+ * queue and never waits; if the queue is ever full, the event is dropped
+ * and counted. The message thread drains the queue into a fixed-size ring
+ * of the most recent events, which is what the editor's status line and
+ * history list read, and then tells the Listener.
+ */
+class ColDawStatusLog : private juce::AsyncUpdater
+{
+public:
+    //==============================================================================
+    enum class Severity
+    {
+        info,
+        progress,   // Still going; replaces the previous progress event of the same operation in the history
+        success,
+        warning,
+        error
+    };
+
+    enum class Operation
+    {
+        login,
+        project,    // Detecting, selecting and watching the set
+        upload,
+        samples,
+        update,     // Web updates: fetch, preview and apply
+        audio       // Audio capture and previews
+    };
+
+    struct Event
+    {
+        juce::uint32 id = 0;            // Increases by one per event in the history; 0 for none
+        juce::Time time;
+        Severity severity = Severity::info;
+        Operation operation = Operation::project;
+        juce::String message;
+        double durationSeconds = -1.0;  // Negative if the event doesn't end a timed operation
+    };
+
+    class Listener
+    {
+    public:
+        virtual ~Listener() = default;
+
+        /** Called on the message thread after new events were added to the history. */
+        virtual void statusLogChanged() = 0;
+    };
+
+    //==============================================================================
+    explicit ColDawStatusLog (Listener& listener, int historySize = 200);
+    ~ColDawStatusLog() override;
+
+    /** Queues an event. Callable from any thread; never blocks. False if it was dropped. */
+    bool post (Severity severity, Operation operation, const juce::String& message, double durationSeconds = -1.0);
+
+    //==============================================================================
+    // Message thread only
+
+    /** Events in the history, oldest first. */
+    int getNumEvents() const noexcept               { return (int) historyCount; }
+    const Event& getEvent (int index) const;
+
+    /** The most recent event, or an Event with id 0 if there is none. */
+    const Event& getLatest() const;
+
+    static juce::String getName (Operation operation);
+
+private:
+    //==============================================================================
+    struct Slot
+    {
+        std::atomic<size_t> sequence { 0 };
+        Event event;
+    };
+
+    void handleAsyncUpdate() override;
+    void addToHistory (Event event);
+
+    Listener& listener;
+
+    // Bounded multi-producer queue; a slot is free for the producer at position
+    // p when its sequence is p, and holds an event for the consumer when p + 1
+    static constexpr size_t queueSize = 256;
+    std::unique_ptr<Slot[]> slots;
+    std::atomic<size_t> enqueuePosition { 0 };
+    size_t dequeuePosition = 0;
+    std::atomic<int> droppedEvents { 0 };
+
+    // History ring
+    std::vector<Event> history;
+    size_t historyStart = 0, historyCount = 0;
+    juce::uint32 lastId = 0;
+    Event noEvent;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ColDawStatusLog)
+};
@@ -0,0 +1,178 @@
+#include "TransportCodec.h"
+#include <limits>
+
+#ifndef COLDAW_HAS_ZSTD
+ #define COLDAW_HAS_ZSTD 0
+#endif
+
+#if COLDAW_HAS_ZSTD
+ #include <zstd.h>
+ #include "BinaryData.h"
+#endif
+
+//==============================================================================
+ColDawTransportCodec::ColDawTransportCodec()
+    : levels ({{
+          // Single-threaded speed and ratio with the dictionary on a typical
+          // Live set, roughly halved in speed for a loaded laptop
+          { 1,  500.0e6, 29.7 },
+          { 3,  400.0e6, 34.8 },
+          { 6,  120.0e6, 43.5 },
+          { 9,   90.0e6, 51.9 },
+          { 15,   4.0e6, 53.9 },
+          { 19,   2.5e6, 55.6 }
+      }})
+{
+}
+
+bool ColDawTransportCodec::isAvailable()
+{
+   #if COLDAW_HAS_ZSTD
+    static const bool dictionaryValid = ZSTD_getDictID_fromDict (BinaryData::AbletonXml_zdict,
+                                                                 (size_t) BinaryData::AbletonXml_zdictSize) != 0;
+    return dictionaryValid;
+   #else
+    return false;
+   #endif
+}
+
+juce::String ColDawTransportCodec::getEncodingName()
+{
+   #if COLDAW_HAS_ZSTD
+    return "zstd; dict=" + juce::String ((int) ZSTD_getDictID_fromDict (BinaryData::AbletonXml_zdict,
+                                                                       (size_t) BinaryData::AbletonXml_zdictSize));
+   #else
+    return {};
+   #endif
+}
+
+//==============================================================================
+int ColDawTransportCodec::chooseLevel (juce::int64 inflatedSize) const
+{
+    const juce::ScopedLock sl (lock);
+
+    const auto size = (double) juce::jmax ((juce::int64) 1, inflatedSize);
+    auto best = levels.front();
+    auto bestSeconds = std::numeric_limits<double>::max();
+
+    for (auto& stats : levels)
+    {
+        const auto seconds = size / stats.bytesPerSecond + size / stats.ratio / uplinkBytesPerSecond;
+
+        if (seconds < bestSeconds)
+        {
+            best = stats;
+            bestSeconds = seconds;
+        }
+    }
+
+    return best.level;
+}
+
+void ColDawTransportCodec::recordUpload (juce::int64 bytes, double seconds)
+{
+    // Tiny requests are all latency and say nothing about the uplink
+    if (bytes < 64 * 1024 || seconds <= 0.0)
+        return;
+
+    const juce::ScopedLock sl (lock);
+    uplinkBytesPerSecond += smoothing * ((double) bytes / seconds - uplinkBytesPerSecond);
+}
+
+bool ColDawTransportCodec::encode (juce::InputStream& gzipped, juce::OutputStream& output, const juce::Thread& thread, int& level)
+{
+   #if COLDAW_HAS_ZSTD
+    juce::uint8 magic[2] = {};
+    const auto totalLength = gzipped.getTotalLength();
+
+    if (! isAvailable() || totalLength < 18 || gzipped.read (magic, 2) != 2 || magic[0] != 0x1f || magic[1] != 0x8b)
+        return false;
+
+    // The gzip trailer holds the inflated size (mod 2^32), which lets zstd
+    // record the content size in the frame header
+    gzipped.setPosition (totalLength - 4);
+    const auto inflatedSize = (juce::int64) (juce::uint32) gzipped.readInt();
+    gzipped.setPosition (0);
+
+    if (level == 0)
+        level = chooseLevel (inflatedSize);
+
+    std::unique_ptr<ZSTD_CCtx, decltype (&ZSTD_freeCCtx)> context (ZSTD_createCCtx(), &ZSTD_freeCCtx);
+    if (context == nullptr)
+        return false;
+
+    auto* cctx = context.get();
+    ZSTD_CCtx_setParameter (cctx, ZSTD_c_compressionLevel, level);
+    ZSTD_CCtx_setParameter (cctx, ZSTD_c_checksumFlag, 1);
+
+    // Fails harmlessly when libzstd was built without threads. Any worker
+    // count above zero produces the same output, so sessions can resume.
+    ZSTD_CCtx_setParameter (cctx, ZSTD_c_nbWorkers, juce::jmax (0, juce::SystemStats::getNumCpus() / 2 - 1));
+
+    if (ZSTD_isError (ZSTD_CCtx_loadDictionary (cctx, BinaryData::AbletonXml_zdict, (size_t) BinaryData::AbletonXml_zdictSize))
+         || (inflatedSize < 0xffffffffLL && ZSTD_isError (ZSTD_CCtx_setPledgedSrcSize (cctx, (unsigned long long) inflatedSize))))
+        return false;
+
+    juce::GZIPDecompressorInputStream inflated (&gzipped, false, juce::GZIPDecompressorInputStream::gzipFormat);
+
+    const auto inputSize = ZSTD_CStreamInSize();
+    const auto outputSize = ZSTD_CStreamOutSize();
+    juce::HeapBlock<char> inputBuffer (inputSize), outputBuffer (outputSize);
+
+    const auto started = juce::Time::getMillisecondCounterHiRes();
+    juce::int64 bytesIn = 0, bytesOut = 0;
+
+    for (;;)
+    {
+        if (thread.threadShouldExit())
+            return false;
+
+        const auto numRead = inflated.read (inputBuffer, (int) inputSize);
+        if (numRead < 0)
+            return false;
+
+        bytesIn += numRead;
+        const auto mode = numRead == 0 ? ZSTD_e_end : ZSTD_e_continue;
+        ZSTD_inBuffer input { inputBuffer.get(), (size_t) numRead, 0 };
+
+        // Drain until this piece of input is consumed (and, at the end, the frame is closed)
+        for (;;)
+        {
+            ZSTD_outBuffer out { outputBuffer.get(), outputSize, 0 };
+            const auto remaining = ZSTD_compressStream2 (cctx, &out, &input, mode);
+
+            if (ZSTD_isError (remaining) || ! output.write (outputBuffer, out.pos))
+                return false;
+
+            bytesOut += (juce::int64) out.pos;
+
+            if (mode == ZSTD_e_end ? remaining == 0 : input.pos == input.size)
+                break;
+        }
+
+        if (numRead == 0)
+            break;
+    }
+
+    const auto seconds = (juce::Time::getMillisecondCounterHiRes() - started) / 1000.0;
+
+    if (seconds > 0.0 && bytesOut > 0)
+    {
+        const juce::ScopedLock sl (lock);
+
+        for (auto& stats : levels)
+        {
+            if (stats.level == level)
+            {
+                stats.bytesPerSecond += smoothing * ((double) bytesIn / seconds - stats.bytesPerSecond);
+                stats.ratio += smoothing * ((double) bytesIn / (double) bytesOut - stats.ratio);
+            }
+        }
+    }
+
+    return true;
+   #else
+    juce::ignoreUnused (gzipped, output, thread, level);
+    return false;
+   #endif
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+
+//==============================================================================
+/**
+ * ColDaw Export Plugin - zstd transport compression
+ *
+ * Optional encoding for full uploads: the gzipped .als is inflated and
+ * recompressed with zstd, primed with a dictionary trained on Ableton XML
+ * (Resources/AbletonXml.zdict, see train-dictionary.sh). The server holds
+ * the same dictionary and turns the upload back into a gzipped .als.
+ *
+ * The compression level is picked per upload to minimise the estimated
+ * compress time plus send time. The estimate uses the measured uplink
+ * throughput and each level's measured speed and ratio on this machine. A
+ * busy host makes compression slower, which pushes the choice towards
+ * cheaper levels without having to measure CPU load directly. Levels that
+ * haven't been measured yet start from typical figures for Live sets.
+ *
+ * Only available when the plugin is built with libzstd (COLDAW_HAS_ZSTD).
+ */
+class ColDawTransportCodec
+{
+public:
+    //==============================================================================
+    ColDawTransportCodec();
+
+    /** True if the plugin was built with zstd and the dictionary is usable. */
+    static bool isAvailable();
+
+    /** Value for the X-ColDaw-Encoding header, naming the dictionary. */
+    static juce::String getEncodingName();
+
+    /** Inflates a gzipped .als and writes it zstd-compressed. A level of 0 has
+        one chosen; either way, level is set to the one used. The same input at
+        the same level always encodes to the same bytes. Returns false if the
+        input isn't gzip or anything fails.
+    */
+    bool encode (juce::InputStream& gzipped, juce::OutputStream& output, const juce::Thread& thread, int& level);
+
+    /** Tells the level picker how long some bytes took to reach the server. */
+    void recordUpload (juce::int64 bytes, double seconds);
+
+    /** Level the next encode() would use for this much XML. */
+    int chooseLevel (juce::int64 inflatedSize) const;
+
+private:
+    //==============================================================================
+    struct LevelStats
+    {
+        int level;
+        double bytesPerSecond;  // Inflated bytes compressed per second
+        double ratio;           // Inflated size / compressed size
+    };
+
+    static constexpr double smoothing = 0.3;  // Weight of the newest measurement
+
+    juce::CriticalSection lock;
+    std::array<LevelStats, 6> levels;
+    double uplinkBytesPerSecond = 1.0e6;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ColDawTransportCodec)
+};
@@ -0,0 +1,765 @@
+#include "UploadEngine.h"
+#include "MultipartFormStream.h"
+#include "DeltaEncoder.h"
+#include "SemanticDelta.h"
+#include "Sha256.h"
+#include <set>
+
+namespace
+{
+    constexpr int chunkSize = 4 * 1024 * 1024;
+    constexpr int maxChunksInFlight = 4;
+    constexpr int maxSnapshotAttempts = 3;
+}
+
+//==============================================================================
+/**
+ * One pipeline stage: a thread that pulls jobs from its queue, does its part
+ * of the work and hands the job on. Jobs that already failed (or turned out
+ * to be unchanged) skip the work but still travel down the pipe so they get
+ * reported.
+ */
+class ColDawUploadEngine::Stage : public juce::Thread
+{
+public:
+    using Work = std::function<void (Job&, const juce::Thread&)>;
+    using Forward = std::function<void (JobPtr)>;
+
+    Stage (const juce::String& name, Work workToDo, Forward forwardTo)
+        : juce::Thread (name), work (std::move (workToDo)), forward (std::move (forwardTo))
+    {
+        startThread();
+    }
+
+    ~Stage() override
+    {
+        stopThread (10000);
+    }
+
+    void push (JobPtr job)
+    {
+        {
+            const juce::ScopedLock sl (lock);
+            queue.push_back (std::move (job));
+        }
+
+        notify();
+    }
+
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            JobPtr job;
+
+            {
+                const juce::ScopedLock sl (lock);
+
+                if (! queue.empty())
+                {
+                    job = std::move (queue.front());
+                    queue.pop_front();
+                }
+            }
+
+            if (job == nullptr)
+            {
+                wait (-1);
+                continue;
+            }
+
+            if (job->needsWork())
+                work (*job, *this);
+
+            forward (std::move (job));
+        }
+    }
+
+private:
+    Work work;
+    Forward forward;
+
+    juce::CriticalSection lock;
+    std::deque<JobPtr> queue;
+};
+
+//==============================================================================
+ColDawUploadEngine::ColDawUploadEngine (Listener& l)
+    : listener (l),
+      chunkThreads (maxChunksInFlight)
+{
+    // Built back to front so each stage can forward to the next one
+    responseThread = std::make_unique<Stage> ("ColDaw Upload Response",
+                                              [this] (Job& job, const juce::Thread&) { responseStage (job); },
+                                              [this] (JobPtr job) { finishJob (std::move (job)); });
+
+    sendThread = std::make_unique<Stage> ("ColDaw Upload Send",
+                                          [this] (Job& job, const juce::Thread& thread) { sendStage (job, thread); },
+                                          [this] (JobPtr job) { responseThread->push (std::move (job)); });
+
+    compressThread = std::make_unique<Stage> ("ColDaw Upload Compress",
+                                              [this] (Job& job, const juce::Thread&) { compressStage (job); },
+                                              [this] (JobPtr job) { sendThread->push (std::move (job)); });
+
+    hashThread = std::make_unique<Stage> ("ColDaw Upload Hash",
+                                          [this] (Job& job, const juce::Thread&) { hashStage (job); },
+                                          [this] (JobPtr job) { compressThread->push (std::move (job)); });
+
+    readThread = std::make_unique<Stage> ("ColDaw Upload Read",
+                                          [this] (Job& job, const juce::Thread&) { readStage (job); },
+                                          [this] (JobPtr job) { hashThread->push (std::move (job)); });
+}
+
+ColDawUploadEngine::~ColDawUploadEngine()
+{
+    // Stop upstream stages first so nothing is pushed into a stage that has gone
+    readThread.reset();
+    hashThread.reset();
+    compressThread.reset();
+    sendThread.reset();
+    responseThread.reset();
+
+    cancelPendingUpdate();
+}
+
+int ColDawUploadEngine::enqueue (Request request)
+{
+    auto job = std::make_unique<Job>();
+    job->id = nextJobId++;
+    job->request = std::move (request);
+    job->result.jobId = job->id;
+    job->result.file = job->request.file;
+    job->startTime = juce::Time::getMillisecondCounter();
+
+    const auto jobId = job->id;
+    ++jobsInFlight;
+    filesInFlight.add (job->request.file);
+    readThread->push (std::move (job));
+    return jobId;
+}
+
+//==============================================================================
+std::unique_ptr<juce::InputStream> ColDawUploadEngine::Job::createPayloadStream() const
+{
+    if (transportFile != nullptr)
+        return std::make_unique<juce::FileInputStream> (transportFile->getFile());
+
+    if (compressedFile != nullptr)
+        return std::make_unique<juce::FileInputStream> (compressedFile->getFile());
+
+    if (mappedFile != nullptr)
+        return std::make_unique<juce::MemoryInputStream> (mappedFile->getData(), mappedFile->getSize(), false);
+
+    if (snapshotFile != nullptr)
+        return std::make_unique<juce::FileInputStream> (snapshotFile->getFile());
+
+    return nullptr;
+}
+
+//==============================================================================
+void ColDawUploadEngine::readStage (Job& job)
+{
+    const auto& file = job.request.file;
+
+    if (! file.existsAsFile())
+    {
+        job.fail ("File does not exist");
+        return;
+    }
+
+    // The rest of the pipeline works on a private copy, so Live can save over
+    // the project while a long upload is still going (a mapping of the project
+    // itself would block that on Windows, and crash on POSIX if Live rewrote it
+    // in place). A save that lands during the copy shows up as a changed size
+    // or time, and the copy is taken again.
+    for (int attempt = 0;; ++attempt)
+    {
+        const auto modified = file.getLastModificationTime();
+        const auto size = file.getSize();
+
+        job.snapshotFile = std::make_unique<juce::TemporaryFile> (".als");
+
+        if (! file.copyFileTo (job.snapshotFile->getFile()))
+        {
+            job.snapshotFile.reset();
+            job.fail ("Could not read file");
+            return;
+        }
+
+        if (file.getLastModificationTime() == modified && file.getSize() == size)
+            break;
+
+        if (attempt == maxSnapshotAttempts - 1)
+        {
+            job.snapshotFile.reset();
+            job.fail ("File kept changing while it was read");
+            return;
+        }
+    }
+
+    // Pages are shared with the file cache, and nobody else writes the copy
+    job.mappedFile = std::make_unique<juce::MemoryMappedFile> (job.snapshotFile->getFile(), juce::MemoryMappedFile::readOnly);
+
+    if (job.mappedFile->getData() == nullptr)
+        job.mappedFile.reset();
+}
+
+void ColDawUploadEngine::hashStage (Job& job)
+{
+    ColDawSha256 hash;
+
+    if (job.mappedFile != nullptr)
+    {
+        hash.update (job.mappedFile->getData(), job.mappedFile->getSize());
+        job.result.contentHash = hash.finish();
+    }
+    else if (job.snapshotFile != nullptr)
+    {
+        juce::FileInputStream input (job.snapshotFile->getFile());
+        if (input.openedOk() && hash.update (input))
+            job.result.contentHash = hash.finish();
+    }
+
+    // Live rewrites the file (and its mtime) even when nothing changed
+    if (job.result.contentHash.isNotEmpty() && job.result.contentHash == job.request.previousContentHash)
+        job.result.unchanged = true;
+}
+
+void ColDawUploadEngine::compressStage (Job& job)
+{
+    // .als files are normally gzipped already; the server only accepts gzip,
+    // so plain XML written by other tools is compressed to a temp file here
+    auto source = job.createPayloadStream();
+    juce::uint8 magic[2] = {};
+
+    if (source == nullptr || source->read (magic, 2) != 2 || (magic[0] == 0x1f && magic[1] == 0x8b))
+    {
+        createDelta (job);
+        return;
+    }
+
+    source->setPosition (0);
+
+    auto tempFile = std::make_unique<juce::TemporaryFile> (".als");
+    juce::FileOutputStream output (tempFile->getFile());
+
+    if (! output.openedOk())
+    {
+        job.fail ("Could not create temporary file");
+        return;
+    }
+
+    {
+        juce::GZIPCompressorOutputStream gzip (output, 6, juce::GZIPCompressorOutputStream::windowBitsGZIP);
+        gzip.writeFromInputStream (*source, -1);
+    }
+
+    output.flush();
+    job.compressedFile = std::move (tempFile);
+}
+
+void ColDawUploadEngine::createDelta (Job& job)
+{
+    // An edit script is usually far smaller than a block delta, which gzip
+    // defeats for anything but edits near the end of the file
+    if (createEditScript (job))
+        return;
+
+    // Deltas are taken over the mapped snapshot, whose hash the server checks
+    if (job.request.signatureUrl.isEmpty() || job.compressedFile != nullptr || job.mappedFile == nullptr)
+        return;
+
+    ColDawHttpClient::Request signatureRequest;
+    signatureRequest.url = job.request.signatureUrl;
+    signatureRequest.headers = "Authorization: Bearer " + job.request.authToken;
+    signatureRequest.connectionTimeoutMs = 10000;
+
+    auto signatureResponse = httpClient->perform (signatureRequest);
+    if (signatureResponse.statusCode != 200)
+        return;
+
+    const auto& signatureData = signatureResponse.body;
+
+    ColDawDeltaEncoder::Signature signature;
+    if (! signature.parse (signatureData))
+        return;
+
+    auto deltaFile = std::make_unique<juce::TemporaryFile> (".delta");
+    juce::FileOutputStream output (deltaFile->getFile());
+    if (! output.openedOk())
+        return;
+
+    const auto size = job.mappedFile->getSize();
+    ColDawDeltaEncoder::Stats stats;
+
+    if (! ColDawDeltaEncoder::encode (signature, job.mappedFile->getData(), size, job.result.contentHash, output, stats))
+        return;
+
+    // When most of the file changed, a plain upload is just as cheap and
+    // saves the server a reconstruction
+    if (stats.literalBytes > (juce::int64) size / 2)
+        return;
+
+    job.deltaFile = std::move (deltaFile);
+}
+
+bool ColDawUploadEngine::createEditScript (Job& job)
+{
+    const auto& request = job.request;
+
+    if (request.semanticEndpoint.isEmpty() || job.compressedFile != nullptr || job.mappedFile == nullptr)
+        return false;
+
+    if (! request.semanticBaseFile.existsAsFile() && ! downloadSemanticBase (request))
+        return false;
+
+    juce::FileInputStream baseInput (request.semanticBaseFile);
+    juce::MemoryInputStream targetInput (job.mappedFile->getData(), job.mappedFile->getSize(), false);
+
+    if (! baseInput.openedOk())
+        return false;
+
+    auto base = ColDawProjectModel::load (baseInput);
+    auto target = ColDawProjectModel::load (targetInput);
+
+    if (base == nullptr || target == nullptr)
+        return false;
+
+    auto script = ColDawSemanticDelta::createEditScript (*base, *target);
+    if (script.isVoid())
+        return false;
+
+    auto scriptFile = std::make_unique<juce::TemporaryFile> (".json.gz");
+
+    {
+        juce::FileOutputStream output (scriptFile->getFile());
+        if (! output.openedOk())
+            return false;
+
+        juce::GZIPCompressorOutputStream gzip (output, 9, juce::GZIPCompressorOutputStream::windowBitsGZIP);
+        gzip << juce::JSON::toString (script, true);
+    }
+
+    // Restructured projects can produce scripts bigger than the file itself
+    if (scriptFile->getFile().getSize() > (juce::int64) job.mappedFile->getSize() / 2)
+        return false;
+
+    job.editScriptFile = std::move (scriptFile);
+    return true;
+}
+
+bool ColDawUploadEngine::downloadSemanticBase (const Request& request)
+{
+    request.semanticBaseFile.getParentDirectory().createDirectory();
+    juce::TemporaryFile download (request.semanticBaseFile);
+    ColDawHttpClient::Response response;
+
+    {
+        juce::FileOutputStream output (download.getFile());
+        if (! output.openedOk())
+            return false;
+
+        ColDawHttpClient::Request baseRequest;
+        baseRequest.url = request.semanticBaseUrl;
+        baseRequest.headers = "Authorization: Bearer " + request.authToken;
+        baseRequest.response = &output;
+
+        response = httpClient->perform (baseRequest);
+    }
+
+    return response.statusCode == 200 && download.getFile().getSize() > 0
+        && download.overwriteTargetFileWithTemporary();
+}
+
+void ColDawUploadEngine::sendStage (Job& job, const juce::Thread& thread)
+{
+    const auto& request = job.request;
+    const auto fileName = request.file.getFileName();
+
+    if (job.editScriptFile != nullptr
+         && sendDelta (job, thread, *job.editScriptFile, request.semanticEndpoint, "alsEdit", fileName + ".edit.json.gz"))
+        return;
+
+    if (job.deltaFile != nullptr
+         && sendDelta (job, thread, *job.deltaFile, request.deltaEndpoint, "alsDelta", fileName + ".delta"))
+        return;
+
+    if (request.zstdTransport)
+        encodeForTransport (job, thread);
+
+    sendFull (job, thread);
+
+    // 415: the server can't decode it (no zstd, or a different dictionary)
+    if (job.transportFile != nullptr && ! job.failed && job.result.statusCode == 415)
+    {
+        job.transportFile.reset();
+        sendFull (job, thread);
+    }
+
+    job.result.sentWithZstd = job.transportFile != nullptr && ! job.failed;
+}
+
+void ColDawUploadEngine::sendFull (Job& job, const juce::Thread& thread)
+{
+    const auto& request = job.request;
+
+    if (sendChunked (job, thread))
+        return;
+
+    sendMultipart (job, thread, request.endpoint, request.fileFieldName, request.file.getFileName(),
+                   job.createPayloadStream(),
+                   job.transportFile != nullptr ? ColDawTransportCodec::getEncodingName() : juce::String());
+}
+
+void ColDawUploadEngine::encodeForTransport (Job& job, const juce::Thread& thread)
+{
+    // Only gzipped sets are re-encoded; plain XML has been gzipped into compressedFile
+    if (! ColDawTransportCodec::isAvailable() || job.transportFile != nullptr)
+        return;
+
+    auto payload = job.createPayloadStream();
+    auto transportFile = std::make_unique<juce::TemporaryFile> (".als.zst");
+
+    // The adaptive level moves between attempts; resuming needs the exact bytes again
+    const auto unfinished = unfinishedSessionLevels.find (job.result.contentHash);
+    job.transportLevel = unfinished != unfinishedSessionLevels.end() ? unfinished->second : 0;
+
+    {
+        juce::FileOutputStream output (transportFile->getFile());
+
+        if (payload == nullptr || ! output.openedOk() || ! transportCodec.encode (*payload, output, thread, job.transportLevel))
+            return;
+    }
+
+    // Sets that are mostly binary (embedded samples) can come out no smaller
+    if (transportFile->getFile().getSize() < payload->getTotalLength())
+        job.transportFile = std::move (transportFile);
+}
+
+juce::String ColDawUploadEngine::getPayloadHash (const Job& job) const
+{
+    if (job.transportFile == nullptr && job.compressedFile == nullptr)
+        return job.result.contentHash;
+
+    ColDawSha256 hash;
+    juce::FileInputStream input ((job.transportFile != nullptr ? job.transportFile : job.compressedFile)->getFile());
+
+    if (! input.openedOk() || ! hash.update (input))
+        return {};
+
+    return hash.finish();
+}
+
+bool ColDawUploadEngine::sendDelta (Job& job, const juce::Thread& thread, const juce::TemporaryFile& delta,
+                                    const juce::URL& endpoint, const juce::String& fieldName, const juce::String& fileName)
+{
+    if (! sendMultipart (job, thread, endpoint, fieldName, fileName,
+                         std::make_unique<juce::FileInputStream> (delta.getFile())))
+        return true;
+
+    // 404 (base version gone) and 422 (delta didn't apply) mean the server
+    // can't use it - move on to the next way of sending the file
+    if (job.result.statusCode == 404 || job.result.statusCode == 422)
+        return false;
+
+    job.result.sentAsDelta = true;
+    return true;
+}
+
+bool ColDawUploadEngine::sendChunked (Job& job, const juce::Thread& thread)
+{
+    const auto& request = job.request;
+    auto payload = job.createPayloadStream();
+
+    if (request.sessionEndpoint.isEmpty() || payload == nullptr || payload->getTotalLength() <= chunkSize)
+        return false;
+
+    const auto size = payload->getTotalLength();
+    payload.reset();
+
+    // The server checks the assembled file against this
+    const auto payloadHash = getPayloadHash (job);
+
+    if (payloadHash.isEmpty())
+        return false;
+
+    juce::String authHeader = "Authorization: Bearer " + request.authToken;
+    juce::String completeHeaders = authHeader + "\r\nContent-Type: application/json";
+
+    for (int i = 0; i < request.headers.size(); ++i)
+        completeHeaders += "\r\n" + request.headers.getAllKeys()[i] + ": " + request.headers.getAllValues()[i];
+
+    if (job.transportFile != nullptr)
+        completeHeaders += "\r\nX-ColDaw-Encoding: " + ColDawTransportCodec::getEncodingName();
+
+    auto postJson = [this, &thread] (const juce::URL& url, const juce::String& headers, const juce::var& body)
+    {
+        const auto json = juce::JSON::toString (body, true);
+
+        return ColDawHttpClient::performWithRetry (thread, [&]
+        {
+            juce::MemoryInputStream bodyStream (json.toRawUTF8(), json.getNumBytesAsUTF8(), false);
+
+            ColDawHttpClient::Request httpRequest;
+            httpRequest.url = url;
+            httpRequest.method = "POST";
+            httpRequest.headers = headers;
+            httpRequest.body = &bodyStream;
+            httpRequest.shouldAbort = [&thread] { return thread.threadShouldExit(); };
+            return httpClient->perform (httpRequest);
+        });
+    };
+
+    // Start the session, or pick up the one an earlier attempt left behind
+    auto* sessionRequest = new juce::DynamicObject();
+    sessionRequest->setProperty ("fileName", request.file.getFileName());
+    sessionRequest->setProperty ("size", size);
+    sessionRequest->setProperty ("sha256", payloadHash);
+    sessionRequest->setProperty ("chunkSize", chunkSize);
+
+    auto session = postJson (request.sessionEndpoint, authHeader + "\r\nContent-Type: application/json", juce::var (sessionRequest));
+
+    // A server without upload sessions gets the single request instead
+    if (! session.isSuccess())
+        return false;
+
+    const auto sessionInfo = session.getJson();
+    const auto sessionId = sessionInfo.getProperty ("sessionId", "").toString();
+    const auto numChunks = (int) ((size + chunkSize - 1) / chunkSize);
+
+    if (sessionId.isEmpty() || (int) sessionInfo.getProperty ("chunkSize", 0) != chunkSize)
+        return false;
+
+    const auto sessionUrl = request.sessionEndpoint.toString (false) + "/" + sessionId;
+    auto received = sessionInfo.getProperty ("received", {});
+
+    job.result.bytesSent = 0;
+
+    // A second round covers chunks the server lost track of by the time we completed
+    for (int round = 0; round < 2; ++round)
+    {
+        std::vector<int> missing;
+        std::set<int> alreadySent;
+
+        if (auto* indices = received.getArray())
+            for (auto& index : *indices)
+                alreadySent.insert ((int) index);
+
+        for (int i = 0; i < numChunks; ++i)
+            if (alreadySent.count (i) == 0)
+                missing.push_back (i);
+
+        // Up to maxChunksInFlight workers take the missing chunks in order
+        std::atomic<size_t> next { 0 };
+        std::atomic<int> failedChunks { 0 };
+        std::atomic<juce::int64> bytesSent { 0 };
+        std::atomic<int> workersLeft { juce::jmin (maxChunksInFlight, (int) missing.size()) };
+        juce::WaitableEvent allDone;
+        const auto started = juce::Time::getMillisecondCounterHiRes();
+
+        if (workersLeft == 0)
+            allDone.signal();
+
+        for (int worker = juce::jmin (maxChunksInFlight, (int) missing.size()); --worker >= 0;)
+        {
+            chunkThreads.addJob ([&]
+            {
+                for (auto i = next++; i < missing.size() && failedChunks == 0; i = next++)
+                {
+                    juce::int64 sent = 0;
+
+                    if (sendChunk (job, thread, sessionUrl, missing[i], sent))
+                        bytesSent += sent;
+                    else
+                        ++failedChunks;
+                }
+
+                if (--workersLeft == 0)
+                    allDone.signal();
+            });
+        }
+
+        allDone.wait();
+        job.result.bytesSent += bytesSent;
+        transportCodec.recordUpload (bytesSent, (juce::Time::getMillisecondCounterHiRes() - started) / 1000.0);
+
+        if (failedChunks > 0)
+        {
+            if (job.transportFile != nullptr)
+                unfinishedSessionLevels[job.result.contentHash] = job.transportLevel;
+
+            job.fail (thread.threadShouldExit() ? "Upload cancelled"
+                                                : "Upload interrupted; the next export resumes it");
+            return true;
+        }
+
+        // Same fields as the multipart form, so the server imports it like smart-import
+        auto* fields = new juce::DynamicObject();
+        for (int i = 0; i < request.formFields.size(); ++i)
+            fields->setProperty (request.formFields.getAllKeys()[i], request.formFields.getAllValues()[i]);
+
+        auto response = postJson (juce::URL (sessionUrl + "/complete"), completeHeaders, juce::var (fields));
+
+        job.result.connected = response.connected;
+        job.result.statusCode = response.statusCode;
+        job.responseText = response.getBodyAsString();
+
+        if (! response.connected)
+        {
+            if (job.transportFile != nullptr)
+                unfinishedSessionLevels[job.result.contentHash] = job.transportLevel;
+
+            job.fail ("Could not connect to server");
+            return true;
+        }
+
+        if (response.statusCode != 422)
+        {
+            unfinishedSessionLevels.erase (job.result.contentHash);
+            return true;
+        }
+
+        received = response.getJson().getProperty ("received", {});
+    }
+
+    return true;
+}
+
+bool ColDawUploadEngine::sendChunk (const Job& job, const juce::Thread& thread, const juce::String& sessionUrl,
+                                    int index, juce::int64& bytesSent)
+{
+    // Each chunk reads through its own stream, so chunks can be read in parallel
+    auto payload = job.createPayloadStream();
+    juce::MemoryBlock chunk;
+
+    if (payload == nullptr || ! payload->setPosition ((juce::int64) index * chunkSize))
+        return false;
+
+    payload->readIntoMemoryBlock (chunk, chunkSize);
+
+    ColDawSha256 chunkHash;
+    chunkHash.update (chunk.getData(), chunk.getSize());
+
+    const auto headers = "Authorization: Bearer " + job.request.authToken
+                       + "\r\nContent-Type: application/octet-stream"
+                       + "\r\nX-ColDaw-Chunk-SHA256: " + chunkHash.finish();
+
+    const auto response = ColDawHttpClient::performWithRetry (thread, [&]
+    {
+        juce::MemoryInputStream body (chunk, false);
+
+        ColDawHttpClient::Request httpRequest;
+        httpRequest.url = juce::URL (sessionUrl + "/chunks/" + juce::String (index));
+        httpRequest.method = "PUT";
+        httpRequest.headers = headers;
+        httpRequest.body = &body;
+        httpRequest.shouldAbort = [&thread] { return thread.threadShouldExit(); };
+        return httpClient->perform (httpRequest);
+    },
+    [] (const ColDawHttpClient::Response& r)
+    {
+        // 422 means the chunk arrived damaged
+        return ColDawHttpClient::isTransientFailure (r) || r.statusCode == 422;
+    });
+
+    if (! response.isSuccess())
+        return false;
+
+    bytesSent = (juce::int64) chunk.getSize();
+    return true;
+}
+
+bool ColDawUploadEngine::sendMultipart (Job& job, const juce::Thread& thread, const juce::URL& endpoint,
+                                        const juce::String& fieldName, const juce::String& fileName,
+                                        std::unique_ptr<juce::InputStream> content, const juce::String& contentEncoding)
+{
+    const auto& request = job.request;
+    ColDawMultipartFormStream body (request.formFields, fieldName, fileName, std::move (content));
+
+    job.result.connected = false;
+    job.result.statusCode = 0;
+    job.responseText = {};
+
+    if (! body.isValid())
+    {
+        job.fail ("Could not read file");
+        return false;
+    }
+
+    job.result.bytesSent = body.getTotalLength();
+
+    juce::String extraHeaders = "Content-Type: " + body.getContentType();
+    if (request.authToken.isNotEmpty())
+        extraHeaders += "\r\nAuthorization: Bearer " + request.authToken;
+
+    for (int i = 0; i < request.headers.size(); ++i)
+        extraHeaders += "\r\n" + request.headers.getAllKeys()[i] + ": " + request.headers.getAllValues()[i];
+
+    if (contentEncoding.isNotEmpty())
+        extraHeaders += "\r\nX-ColDaw-Encoding: " + contentEncoding;
+
+    ColDawHttpClient::Request httpRequest;
+    httpRequest.url = endpoint;
+    httpRequest.method = "POST";
+    httpRequest.headers = extraHeaders;
+    httpRequest.body = &body;
+    httpRequest.shouldAbort = [&thread] { return thread.threadShouldExit(); };
+
+    const auto started = juce::Time::getMillisecondCounterHiRes();
+    auto response = httpClient->perform (httpRequest);
+
+    if (! response.connected)
+    {
+        job.fail ("Could not connect to server");
+        return false;
+    }
+
+    transportCodec.recordUpload (job.result.bytesSent, (juce::Time::getMillisecondCounterHiRes() - started) / 1000.0);
+
+    job.result.connected = true;
+    job.result.statusCode = response.statusCode;
+    job.responseText = response.getBodyAsString();
+
+    return true;
+}
+
+void ColDawUploadEngine::responseStage (Job& job)
+{
+    if (job.responseText.isNotEmpty())
+        job.result.response = juce::JSON::parse (job.responseText);
+}
+
+//==============================================================================
+void ColDawUploadEngine::finishJob (JobPtr job)
+{
+    job->result.elapsedSeconds = (juce::Time::getMillisecondCounter() - job->startTime) / 1000.0;
+
+    {
+        const juce::ScopedLock sl (finishedLock);
+        finishedJobs.push_back (std::move (job));
+    }
+
+    triggerAsyncUpdate();
+}
+
+void ColDawUploadEngine::handleAsyncUpdate()
+{
+    for (;;)
+    {
+        JobPtr job;
+
+        {
+            const juce::ScopedLock sl (finishedLock);
+
+            if (finishedJobs.empty())
+                break;
+
+            job = std::move (finishedJobs.front());
+            finishedJobs.pop_front();
+        }
+
+        --jobsInFlight;
+        filesInFlight.removeFirstMatchingValue (job->result.file);
+        listener.uploadFinished (job->result);
+    }
+}
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_events/juce_events.h>
+#include <deque>
+#include <map>
+#include "HttpClient.h"
+#include "TransportCodec.h"
+
+//==============================================================================
+/**
+ * ColDaw Export Plugin - Background Upload Engine
+ *
+ * Runs project uploads off the message thread. Every upload is a job that
+ * moves through five stages (read, hash, compress, send, response), each on
+ * its own thread, so reading the next project can overlap with sending the
+ * previous one. Finished jobs are reported to the Listener on the message
+ * thread. Callers should keep uploads of one file apart (see isUploading()):
+ * each is sent against the version the previous one created.
+ *
+ * Full uploads bigger than one chunk are sent through a resumable upload
+ * session: the payload is cut into fixed-size chunks, each sent with its own
+ * SHA-256, several at a time, and retried with jittered exponential backoff.
+ * The server finds the session again by the payload's size and hash, so an
+ * upload that was cut off resumes with the chunks it is missing. A zstd
+ * payload is re-encoded at the level the unfinished session used, which
+ * gives the same bytes again.
+ */
+class ColDawUploadEngine : private juce::AsyncUpdater
+{
+public:
+    //==============================================================================
+    /** Everything the engine needs to upload one file. */
+    struct Request
+    {
+        juce::File file;
+        juce::URL endpoint;
+        juce::String authToken;
+        juce::StringPairArray formFields;  // Sent in insertion order before the file part
+        juce::String fileFieldName { "alsFile" };
+        juce::StringPairArray headers;     // Extra request headers, e.g. upload preconditions
+        juce::String previousContentHash;  // If the file still hashes to this, nothing is sent
+        juce::URL signatureUrl;            // If set, try a delta against the version signed here first
+        juce::URL deltaEndpoint;           // Where deltas go; falls back to endpoint if rejected
+        juce::URL semanticEndpoint;        // If set, try an XML edit script against the base version first
+        juce::URL semanticBaseUrl;         // Where to download the base version if it isn't cached
+        juce::File semanticBaseFile;       // Local cache of the base version's .als
+        juce::URL sessionEndpoint;         // If set, full uploads bigger than one chunk go in resumable chunks
+        bool zstdTransport = false;        // Send full uploads zstd-compressed with the shipped dictionary
+    };
+
+    /** Outcome of an upload, delivered on the message thread. */
+    struct Result
+    {
+        int jobId = 0;
+        juce::File file;
+        bool connected = false;     // False if the request never reached the server
+        int statusCode = 0;
+        juce::var response;         // Parsed JSON body (void if the body was not JSON)
+        juce::String contentHash;   // SHA-256 of the bytes that were read from disk
+        bool unchanged = false;     // True if the upload was skipped because the hash matched
+        bool sentAsDelta = false;   // True if the server accepted a delta or edit script instead of the file
+        bool sentWithZstd = false;  // True if the file went zstd-compressed instead of gzipped
+        juce::int64 bytesSent = 0;  // Size of the request body
+        juce::String errorMessage;  // Set when a stage failed before a response arrived
+        double elapsedSeconds = 0.0;
+    };
+
+    class Listener
+    {
+    public:
+        virtual ~Listener() = default;
+
+        /** Called on the message thread once a job has left the pipeline. */
+        virtual void uploadFinished (const Result& result) = 0;
+    };
+
+    //==============================================================================
+    explicit ColDawUploadEngine (Listener& listener);
+    ~ColDawUploadEngine() override;
+
+    /** Queues an upload and returns its job ID. Never blocks. Call on the message thread. */
+    int enqueue (Request request);
+
+    /** True while any job is still somewhere in the pipeline. */
+    bool isBusy() const noexcept { return jobsInFlight.load() > 0; }
+
+    /** True while a job for this file hasn't been reported yet. Call on the message thread. */
+    bool isUploading (const juce::File& file) const { return filesInFlight.contains (file); }
+
+private:
+    //==============================================================================
+    struct Job
+    {
+        int id = 0;
+        Request request;
+        std::unique_ptr<juce::TemporaryFile> snapshotFile;    // Copy of the file taken by the read stage
+        std::unique_ptr<juce::MemoryMappedFile> mappedFile;   // Mapping of snapshotFile, if it could be mapped
+        std::unique_ptr<juce::TemporaryFile> compressedFile;  // Only used when the source was not gzipped
+        std::unique_ptr<juce::TemporaryFile> deltaFile;       // Encoded delta, if one was worth sending
+        std::unique_ptr<juce::TemporaryFile> editScriptFile;  // Gzipped XML edit script, if one was worth sending
+        std::unique_ptr<juce::TemporaryFile> transportFile;   // zstd-encoded payload, replaces the gzipped one on the wire
+        int transportLevel = 0;                               // zstd level of transportFile
+        juce::String responseText;
+        Result result;
+        juce::uint32 startTime = 0;
+        bool failed = false;
+
+        void fail (const juce::String& message)
+        {
+            failed = true;
+            result.errorMessage = message;
+        }
+
+        /** False once the job has failed or turned out to need no upload. */
+        bool needsWork() const noexcept { return ! failed && ! result.unchanged; }
+
+        /** Opens a stream over the bytes that should go on the wire. */
+        std::unique_ptr<juce::InputStream> createPayloadStream() const;
+    };
+
+    using JobPtr = std::unique_ptr<Job>;
+
+    class Stage;
+
+    void readStage (Job&);
+    void hashStage (Job&);
+    void compressStage (Job&);
+    void sendStage (Job&, const juce::Thread&);
+    void sendFull (Job&, const juce::Thread&);
+    void encodeForTransport (Job&, const juce::Thread&);
+    juce::String getPayloadHash (const Job&) const;
+    void createDelta (Job&);
+    bool createEditScript (Job&);
+    bool downloadSemanticBase (const Request&);
+
+    /** Sends a delta; false if the server can't use it and the next option should be tried. */
+    bool sendDelta (Job&, const juce::Thread&, const juce::TemporaryFile& delta, const juce::URL& endpoint,
+                    const juce::String& fieldName, const juce::String& fileName);
+
+    /** Sends the payload through an upload session; false if the server has no sessions. */
+    bool sendChunked (Job&, const juce::Thread&);
+    bool sendChunk (const Job&, const juce::Thread&, const juce::String& sessionUrl, int index, juce::int64& bytesSent);
+
+    /** Posts one multipart request; fails the job and returns false if it never got a response. */
+    bool sendMultipart (Job&, const juce::Thread&, const juce::URL& endpoint, const juce::String& fieldName,
+                        const juce::String& fileName, std::unique_ptr<juce::InputStream> content,
+                        const juce::String& contentEncoding = {});
+    void responseStage (Job&);
+
+    void finishJob (JobPtr job);
+    void handleAsyncUpdate() override;
+
+    Listener& listener;
+    juce::SharedResourcePointer<ColDawHttpClient> httpClient;
+
+    std::unique_ptr<Stage> readThread, hashThread, compressThread, sendThread, responseThread;
+    juce::ThreadPool chunkThreads;
+    ColDawTransportCodec transportCodec;
+    std::map<juce::String, int> unfinishedSessionLevels;  // Content hash -> zstd level; the send stage's own
+
+    juce::CriticalSection finishedLock;
+    std::deque<JobPtr> finishedJobs;
+
+    std::atomic<int> nextJobId { 1 };
+    std::atomic<int> jobsInFlight { 0 };
+    juce::Array<juce::File> filesInFlight;  // Message thread only
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ColDawUploadEngine)
+};
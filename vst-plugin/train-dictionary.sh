@@ -0,0 +1,35 @@
+#!/bin/bash
+
+# ColDaw zstd dictionary trainer
+# Trains the dictionary used for zstd transport compression of .als uploads
+# from a set of Live sets. The same file must be shipped with the plugin
+# (Resources/AbletonXml.zdict) and the server (src/assets/AbletonXml.zdict);
+# bump DICT_ID whenever it is retrained so old plugins fall back to gzip.
+#
+# Usage: ./train-dictionary.sh set1.als [set2.als ...]
+
+set -e
+
+DICT_ID="${DICT_ID:-1}"
+DICT_SIZE="${DICT_SIZE:-65536}"
+
+SCRIPT_DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" && pwd )"
+OUTPUT="$SCRIPT_DIR/Resources/AbletonXml.zdict"
+SAMPLES="$(mktemp -d)"
+trap 'rm -rf "$SAMPLES"' EXIT
+
+if [ $# -eq 0 ]; then
+    echo "Usage: $0 set1.als [set2.als ...]"
+    exit 1
+fi
+
+# zstd trains on many small samples; cut each inflated set into 16 KB pieces
+for als in "$@"; do
+    name="$(basename "$als" .als)"
+    gunzip -c "$als" | split -b 16384 -a 5 - "$SAMPLES/$name."
+done
+
+zstd --train "$SAMPLES"/* -o "$OUTPUT" --maxdict="$DICT_SIZE" --dictID="$DICT_ID" -q
+cp "$OUTPUT" "$SCRIPT_DIR/../server/src/assets/AbletonXml.zdict"
+
+echo "Wrote $OUTPUT (dictionary ID $DICT_ID) and the server copy"